@@ -5,34 +5,166 @@
  */
 
 #include "ads1115.h"
+#include "hardware/timer.h"
+#include "hot_path.h"
+#include "i2c_bus.h"
 
-void ads1115_init(i2c_inst_t *i2c_port, uint8_t i2c_addr,
-                  ads1115_adc_t *adc) {
+static ads1115_stats_t stats;
+
+// After a failed transfer, neither the pointer nor the configuration the
+// device holds are known any more
+static int HOT_PATH(ads1115_check)(ads1115_adc_t *adc, int result, size_t len) {
+    if (result == (int)len) return ADS1115_OK;
+
+    ads1115_forget_state(adc);
+    stats.errors++;
+    return result == PICO_ERROR_TIMEOUT ? ADS1115_ERROR_TIMEOUT : ADS1115_ERROR_NACK;
+}
+
+// Every bus transfer goes through these two so the traffic can be counted
+// and no transfer can block for longer than the timeout. In Hs-mode the PIO
+// runs the bus instead of the I2C block.
+static int HOT_PATH(ads1115_i2c_write)(ads1115_adc_t *adc, const uint8_t *src, size_t len,
+                                       bool nostop) {
+    stats.transactions++;
+    stats.bytes += 1 + len;
+    uint32_t start = time_us_32();
+    int result = i2c_bus_high_speed()
+                     ? i2c_bus_hs_write_timeout_us(adc->i2c_addr, src, len, adc->timeout_us)
+                     : i2c_write_timeout_us(adc->i2c_port, adc->i2c_addr, src, len, nostop,
+                                            adc->timeout_us);
+    stats.bus_us += time_us_32() - start;
+    return ads1115_check(adc, result, len);
+}
+
+static int HOT_PATH(ads1115_i2c_read)(ads1115_adc_t *adc, uint8_t *dst, size_t len) {
+    stats.transactions++;
+    stats.bytes += 1 + len;
+    uint32_t start = time_us_32();
+    int result = i2c_bus_high_speed()
+                     ? i2c_bus_hs_read_timeout_us(adc->i2c_addr, dst, len, adc->timeout_us)
+                     : i2c_read_timeout_us(adc->i2c_port, adc->i2c_addr, dst, len, false,
+                                           adc->timeout_us);
+    stats.bus_us += time_us_32() - start;
+    return ads1115_check(adc, result, len);
+}
+
+// Point the device at a register, unless it already points there
+static int HOT_PATH(ads1115_set_pointer)(ads1115_adc_t *adc, const uint8_t *pointer) {
+    if (adc->pointer == *pointer) {
+        stats.pointer_writes_skipped++;
+        return ADS1115_OK;
+    }
+    int result = ads1115_i2c_write(adc, pointer, 1, true);
+    if (result == ADS1115_OK) {
+        adc->pointer = *pointer;
+    }
+    return result;
+}
+
+int ads1115_init(i2c_inst_t *i2c_port, uint8_t i2c_addr,
+                 ads1115_adc_t *adc) {
+    adc->i2c_port = i2c_port;
+    adc->i2c_addr = i2c_addr;
+    adc->timeout_us = ADS1115_TIMEOUT_US;
+    ads1115_forget_state(adc);
+    return ads1115_read_config(adc);
+}
+
+int ads1115_init_config(i2c_inst_t *i2c_port, uint8_t i2c_addr, uint16_t config,
+                        ads1115_adc_t *adc) {
     adc->i2c_port = i2c_port;
     adc->i2c_addr = i2c_addr;
-    ads1115_read_config(adc);
+    adc->timeout_us = ADS1115_TIMEOUT_US;
+    ads1115_forget_state(adc);
+    adc->config = config;
+    return ads1115_write_config(adc);
 }
 
-void ads1115_read_adc(uint16_t *adc_value, ads1115_adc_t *adc){
+int ads1115_read_register(uint8_t reg, uint16_t *value, ads1115_adc_t *adc) {
+    uint8_t dst[2];
+    int result = ads1115_set_pointer(adc, &reg);
+    if (result != ADS1115_OK) return result;
+    result = ads1115_i2c_read(adc, dst, 2);
+    if (result != ADS1115_OK) return result;
+    *value = (dst[0] << 8) | dst[1];
+    return ADS1115_OK;
+}
+
+int ads1115_write_register(uint8_t reg, uint16_t value, ads1115_adc_t *adc) {
+    uint8_t src[3];
+    src[0] = reg;
+    src[1] = (uint8_t)(value >> 8);
+    src[2] = (uint8_t)(value & 0xff);
+    int result = ads1115_i2c_write(adc, src, 3, false);
+    if (result != ADS1115_OK) return result;
+    adc->pointer = reg;
+    return ADS1115_OK;
+}
+
+int ads1115_check_bus(ads1115_adc_t *adc) {
+    static const uint16_t patterns[] = {0x5AA5, 0xA55A};
+    uint16_t original;
+    int result = ads1115_read_register(ADS1115_POINTER_LO_THRESH, &original, adc);
+    if (result != ADS1115_OK) return result;
+
+    for (int i = 0; i < 2; i++) {
+        uint16_t value;
+        result = ads1115_write_register(ADS1115_POINTER_LO_THRESH, patterns[i], adc);
+        if (result == ADS1115_OK) {
+            result = ads1115_read_register(ADS1115_POINTER_LO_THRESH, &value, adc);
+        }
+        if (result == ADS1115_OK && value != patterns[i]) {
+            ads1115_forget_state(adc);
+            result = ADS1115_ERROR_CORRUPT;
+        }
+        if (result != ADS1115_OK) return result;
+    }
+    return ads1115_write_register(ADS1115_POINTER_LO_THRESH, original, adc);
+}
+
+int ads1115_set_thresholds(int16_t lo, int16_t hi, ads1115_adc_t *adc) {
+    int result = ads1115_write_register(ADS1115_POINTER_LO_THRESH, (uint16_t)lo, adc);
+    if (result != ADS1115_OK) return result;
+    return ads1115_write_register(ADS1115_POINTER_HI_THRESH, (uint16_t)hi, adc);
+}
+
+void ads1115_forget_state(ads1115_adc_t *adc) {
+    adc->pointer = ADS1115_POINTER_UNKNOWN;
+    adc->config_known = false;
+}
+
+const ads1115_stats_t *ads1115_get_stats() {
+    return &stats;
+}
+
+int HOT_PATH(ads1115_read_adc)(uint16_t *adc_value, ads1115_adc_t *adc){
+    int result;
+
     // If mode is single-shot, set bit 15 to start the conversion.
     if ((adc->config & ADS1115_MODE_MASK) == ADS1115_MODE_SINGLE_SHOT) {
         adc->config |= 0x8000;//ADS1115_STATUS_START;
-        ads1115_write_config(adc);
+        result = ads1115_write_config(adc);
+        if (result != ADS1115_OK) return result;
 
         // Wait until the conversion finishes before reading the value
-        ads1115_read_config(adc);
-        while (adc->config & ADS1115_STATUS_MASK == ADS1115_STATUS_BUSY){
-            ads1115_read_config(adc);
-        }
+        int polls = 0;
+        do {
+            result = ads1115_read_config(adc);
+            if (result != ADS1115_OK) return result;
+            if (++polls > ADS1115_SINGLE_SHOT_POLLS) return ADS1115_ERROR_TIMEOUT;
+        } while ((adc->config & ADS1115_STATUS_MASK) == ADS1115_STATUS_BUSY);
     }
 
-    // Now read the value from last conversion
+    // Now read the value from last conversion. The pointer stays on the
+    // conversion register between reads, so it is only sent after a switch.
     uint8_t dst[2];
-    i2c_write_blocking(adc->i2c_port, adc->i2c_addr,
-                       &ADS1115_POINTER_CONVERSION, 1, true);
-    i2c_read_blocking(adc->i2c_port, adc->i2c_addr, dst, 2,
-                      false);
+    result = ads1115_set_pointer(adc, &ADS1115_POINTER_CONVERSION);
+    if (result != ADS1115_OK) return result;
+    result = ads1115_i2c_read(adc, dst, 2);
+    if (result != ADS1115_OK) return result;
     *adc_value = (dst[0] << 8) | dst[1];
+    return ADS1115_OK;
 }
 
 float ads1115_raw_to_volts(uint16_t adc_value, ads1115_adc_t *adc) {
@@ -72,24 +204,56 @@ float ads1115_raw_to_volts(uint16_t adc_value, ads1115_adc_t *adc) {
     return voltage;
 }
 
-void ads1115_read_config(ads1115_adc_t *adc){
+int ads1115_read_config(ads1115_adc_t *adc){
     // Default configuration after power up should be 34179.
     // Default config with bit 15 cleared is 1411
     uint8_t dst[2];
-    i2c_write_blocking(adc->i2c_port, adc->i2c_addr,
-                       &ADS1115_POINTER_CONFIGURATION, 1, true);
-    i2c_read_blocking(adc->i2c_port, adc->i2c_addr, dst, 2,
-                      false);
+    int result = ads1115_set_pointer(adc, &ADS1115_POINTER_CONFIGURATION);
+    if (result != ADS1115_OK) return result;
+    result = ads1115_i2c_read(adc, dst, 2);
+    if (result != ADS1115_OK) return result;
     adc->config = (dst[0] << 8) | dst[1];
+    // Bit 15 reads back as the conversion status, not as written
+    adc->device_config = adc->config & ~ADS1115_STATUS_MASK;
+    adc->config_known = true;
+    return ADS1115_OK;
 }
 
-void ads1115_write_config(ads1115_adc_t *adc) {
+int HOT_PATH(ads1115_write_config)(ads1115_adc_t *adc) {
+    bool single_shot = (adc->config & ADS1115_MODE_MASK) == ADS1115_MODE_SINGLE_SHOT;
+    if (!single_shot && adc->config_known && adc->config == adc->device_config) {
+        stats.config_writes_skipped++;
+        return ADS1115_OK;
+    }
+
     uint8_t src[3];
     src[0] = ADS1115_POINTER_CONFIGURATION;
     src[1] = (uint8_t)(adc->config >> 8);
     src[2] = (uint8_t)(adc->config & 0xff);
-    i2c_write_blocking(adc->i2c_port, adc->i2c_addr, src, 3,
-                       false);
+    int result = ads1115_i2c_write(adc, src, 3, false);
+    if (result != ADS1115_OK) return result;
+    adc->device_config = adc->config;
+    adc->config_known = true;
+    adc->pointer = ADS1115_POINTER_CONFIGURATION;
+    return ADS1115_OK;
+}
+
+int HOT_PATH(ads1115_select_channel)(enum ads1115_mux_t mux, enum ads1115_pga_t pga,
+                                     enum ads1115_rate_t rate, ads1115_adc_t *adc) {
+    bool was_known = adc->config_known;
+    uint16_t previous = adc->device_config;
+    ads1115_set_input_mux(mux, adc);
+    ads1115_set_pga(pga, adc);
+    ads1115_set_data_rate(rate, adc);
+    int result = ads1115_write_config(adc);
+    if (result != ADS1115_OK) return result;
+    return !was_known || adc->device_config != previous;
+}
+
+uint32_t HOT_PATH(ads1115_conversion_us)(enum ads1115_rate_t rate) {
+    static const uint16_t sps[] = {8, 16, 32, 64, 128, 250, 475, 860};
+    uint32_t samples = sps[(rate & ADS1115_RATE_MASK) >> 5];
+    return (1000000 + samples - 1) / samples;
 }
 
 void ads1115_set_input_mux(enum ads1115_mux_t mux, ads1115_adc_t *adc) {
@@ -112,4 +276,28 @@ void ads1115_set_data_rate(enum ads1115_rate_t rate,
                            ads1115_adc_t *adc) {
     adc->config &= ~ADS1115_RATE_MASK;
     adc->config |= rate;
+}
+
+void ads1115_set_comparator_mode(enum ads1115_comp_mode_t mode,
+                                 ads1115_adc_t *adc) {
+    adc->config &= ~ADS1115_COMP_MODE_MASK;
+    adc->config |= mode;
+}
+
+void ads1115_set_comparator_polarity(enum ads1115_comp_pol_t polarity,
+                                     ads1115_adc_t *adc) {
+    adc->config &= ~ADS1115_COMP_POL_MASK;
+    adc->config |= polarity;
+}
+
+void ads1115_set_comparator_latching(enum ads1115_comp_lat_t latching,
+                                     ads1115_adc_t *adc) {
+    adc->config &= ~ADS1115_COMP_LAT_MASK;
+    adc->config |= latching;
+}
+
+void ads1115_set_comparator_queue(enum ads1115_comp_que_t queue,
+                                  ads1115_adc_t *adc) {
+    adc->config &= ~ADS1115_COMP_QUE_MASK;
+    adc->config |= queue;
 }
\ No newline at end of file
@@ -16,27 +16,76 @@
  * the Raspberry Pi Pico
 */
 
+#define ADS1115_POINTER_UNKNOWN 0xFF
+#define ADS1115_TIMEOUT_US 1000         // Default bound for any single transfer
+#define ADS1115_SINGLE_SHOT_POLLS 2000  // Status polls, covers 8 SPS at 400 kHz
+
+/*! \brief Result of a driver call that talks to the device */
+typedef enum ads1115_result {
+    ADS1115_OK = 0,
+    ADS1115_ERROR_NACK = -1,    // No acknowledge: chip missing or busy
+    ADS1115_ERROR_TIMEOUT = -2, // Transfer didn't finish in time: bus stuck?
+    ADS1115_ERROR_CORRUPT = -3  // Data read back differs from what was written
+} ads1115_result_t;
+
 typedef struct ads1115_adc {
     i2c_inst_t *i2c_port;
     uint8_t i2c_addr;
     uint16_t config;
+    uint16_t device_config;     // Configuration register as last written or read
+    bool config_known;          // False until read or written, and after errors
+    uint8_t pointer;            // Register the pointer currently selects
+    uint32_t timeout_us;        // Bound for each transfer
 } ads1115_adc_t;
 
+/*! \brief I2C traffic counters, shared by all ADS1115 devices */
+typedef struct ads1115_stats {
+    uint32_t transactions;      // Each START ... STOP / repeated START
+    uint32_t bytes;             // Bytes on the bus, address bytes included
+    uint32_t config_writes_skipped;
+    uint32_t pointer_writes_skipped;
+    uint32_t errors;            // Failed transfers, NACK or timeout
+    uint32_t bus_us;            // Time spent in transfers
+} ads1115_stats_t;
+
 /*! \brief Initialise the ADS115 device
+ *
+ * Reads the configuration register, so this also probes for the device.
+ * All transfers are bounded by ADS1115_TIMEOUT_US.
+ *
+ * \param i2c_port The I2C instance, either i2c0 or i2c1
+ * \param i2c_addr The i2C address of the ADS1115 device
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
+ */
+int ads1115_init(i2c_inst_t *i2c_port, uint8_t i2c_addr,
+                 ads1115_adc_t *adc);
+
+/*! \brief Initialise the ADS115 device with a known configuration
+ *
+ * Writes the whole configuration register without reading it first. The
+ * write is acknowledged only by a chip that is there, so this probes too,
+ * in one transfer instead of two. Afterwards the driver knows the
+ * register, and a first ads1115_select_channel() for the same channel
+ * writes nothing.
  *
  * \param i2c_port The I2C instance, either i2c0 or i2c1
  * \param i2c_addr The i2C address of the ADS1115 device
+ * \param config Configuration register value, every field set
  * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
  */
-void ads1115_init(i2c_inst_t *i2c_port, uint8_t i2c_addr,
-                  ads1115_adc_t *adc);
+int ads1115_init_config(i2c_inst_t *i2c_port, uint8_t i2c_addr, uint16_t config,
+                        ads1115_adc_t *adc);
 
 /*! \brief Read the last converted value
  *
- * \param adc_value Pointer to a buffer to receive the data
+ * \param adc_value Pointer to a buffer to receive the data, left
+ * untouched on error
  * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
  */
-void ads1115_read_adc(uint16_t *adc_value, ads1115_adc_t *adc);
+int ads1115_read_adc(uint16_t *adc_value, ads1115_adc_t *adc);
 
 /*! \brief Read the 16-bit configuration register
  *
@@ -44,14 +93,102 @@ void ads1115_read_adc(uint16_t *adc_value, ads1115_adc_t *adc);
  * is 34179 (1411 after bit 15 has been cleared).
  * 
  * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
  */
-void ads1115_read_config(ads1115_adc_t *adc);
+int ads1115_read_config(ads1115_adc_t *adc);
 
 /*! \brief Write current configuration to the configuration register
+ *
+ * In continuous mode, nothing is sent if the device already holds this
+ * configuration. In single-shot mode, the write always goes out because it
+ * starts the conversion.
  *
  * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
  */
-void ads1115_write_config(ads1115_adc_t *adc);
+int ads1115_write_config(ads1115_adc_t *adc);
+
+/*! \brief Read a 16-bit register
+ *
+ * \param reg Register pointer, e.g. ADS1115_POINTER_LO_THRESH
+ * \param value Pointer to a buffer to receive the value
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
+ */
+int ads1115_read_register(uint8_t reg, uint16_t *value, ads1115_adc_t *adc);
+
+/*! \brief Write a 16-bit threshold register
+ *
+ * Use ads1115_write_config() for the configuration register.
+ *
+ * \param reg ADS1115_POINTER_LO_THRESH or ADS1115_POINTER_HI_THRESH
+ * \param value Value to write
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
+ */
+int ads1115_write_register(uint8_t reg, uint16_t value, ads1115_adc_t *adc);
+
+/*! \brief Check that register transfers arrive intact
+ *
+ * Writes two complementary bit patterns to the Lo_thresh register, reads
+ * each one back and then restores the register. Used to validate a bus
+ * speed before relying on it.
+ *
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK, ADS1115_ERROR_CORRUPT if a pattern read back wrong,
+ * or another ads1115_result_t error
+ */
+int ads1115_check_bus(ads1115_adc_t *adc);
+
+/*! \brief Set the comparator thresholds
+ *
+ * Writes Lo_thresh and then Hi_thresh. In traditional mode ALERT/RDY
+ * asserts when a conversion exceeds hi and releases below lo. In window
+ * mode it asserts when a conversion is above hi or below lo.
+ *
+ * \param lo Low threshold, in the same units as a conversion
+ * \param hi High threshold, above lo
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return ADS1115_OK or an ads1115_result_t error
+ */
+int ads1115_set_thresholds(int16_t lo, int16_t hi, ads1115_adc_t *adc);
+
+/*! \brief Forget what the device is known to hold
+ *
+ * Call after anything that may have reset the device or aborted a transfer
+ * behind the driver's back, e.g. a bus recovery. The next access rewrites
+ * the pointer and configuration.
+ *
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ */
+void ads1115_forget_state(ads1115_adc_t *adc);
+
+/*! \brief Select a channel profile: input, gain and data rate in one write
+ *
+ * Sets the multiplexer, PGA and data rate together and writes the
+ * configuration register once. The write is skipped if nothing changed.
+ *
+ * \param mux Multiplexer parameter
+ * \param pga PGA value to use
+ * \param rate Data rate
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ * \return 1 if the configuration changed, i.e. the conversion in progress
+ * still belongs to the previous channel, 0 if not, or an ads1115_result_t
+ * error
+ */
+int ads1115_select_channel(enum ads1115_mux_t mux, enum ads1115_pga_t pga,
+                           enum ads1115_rate_t rate, ads1115_adc_t *adc);
+
+/*! \brief Duration of one conversion at a data rate
+ *
+ * \param rate Data rate
+ * \return Conversion period in microseconds, rounded up
+ */
+uint32_t ads1115_conversion_us(enum ads1115_rate_t rate);
+
+/*! \brief I2C traffic since boot, for all ADS1115 devices together
+ */
+const ads1115_stats_t *ads1115_get_stats();
 
 /*! \brief Convert a (raw) ADC value to voltage
  *
@@ -109,9 +246,51 @@ void ads1115_set_data_rate(enum ads1115_rate_t rate,
  */
 void ads1115_set_input_mux(enum ads1115_mux_t mux, ads1115_adc_t *adc);
 
-// void set_comparator_mode();
-// void set_comparator_polarity();
-// void set_comparator_latching();
-// void set_comparator_queue();
+/*! \brief Set the comparator mode
+ *
+ * A traditional comparator has hysteresis: it asserts above Hi_thresh and
+ * releases below Lo_thresh. A window comparator asserts whenever the
+ * conversion is outside [Lo_thresh, Hi_thresh].
+ *
+ * \param mode Comparator mode
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ */
+void ads1115_set_comparator_mode(enum ads1115_comp_mode_t mode,
+                                 ads1115_adc_t *adc);
+
+/*! \brief Set the polarity of the ALERT/RDY pin
+ *
+ * Active low (default) or active high. The pin is open drain, so it needs
+ * a pull-up either way.
+ *
+ * \param polarity Comparator polarity
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ */
+void ads1115_set_comparator_polarity(enum ads1115_comp_pol_t polarity,
+                                     ads1115_adc_t *adc);
+
+/*! \brief Make the ALERT/RDY pin latch
+ *
+ * A latching comparator holds the pin asserted until the conversion
+ * register is read, so a short excursion isn't missed. A non-latching one
+ * (default) follows the conversions.
+ *
+ * \param latching Latching or non-latching
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ */
+void ads1115_set_comparator_latching(enum ads1115_comp_lat_t latching,
+                                     ads1115_adc_t *adc);
+
+/*! \brief Set the comparator queue, or disable the comparator
+ *
+ * The pin asserts after 1, 2 or 4 successive conversions past the
+ * thresholds. ADS1115_COMPARATOR_QUE_DISABLE (default) turns the comparator
+ * off and leaves the pin high impedance.
+ *
+ * \param queue Comparator queue
+ * \param adc Pointer to the structure that stores the ADS1115 info
+ */
+void ads1115_set_comparator_queue(enum ads1115_comp_que_t queue,
+                                  ads1115_adc_t *adc);
 
 #endif
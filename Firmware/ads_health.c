@@ -0,0 +1,62 @@
+#include "ads_health.h"
+#include "hot_path.h"
+
+void ads_health_init(ads_health_t *health) {
+    *health = (ads_health_t){0};
+    health->state = ADS_HEALTH_HEALTHY;
+    health->probe_interval_us = ADS_HEALTH_PROBE_US;
+}
+
+bool HOT_PATH(ads_health_success)(ads_health_t *health) {
+    health->consecutive_errors = 0;
+    if (health->successes < UINT16_MAX) health->successes++;
+
+    switch (health->state) {
+        case ADS_HEALTH_OFFLINE:
+            health->state = ADS_HEALTH_DEGRADED;
+            health->successes = 0;
+            health->probe_interval_us = ADS_HEALTH_PROBE_US;
+            health->reconnects++;
+            return true;
+        case ADS_HEALTH_DEGRADED:
+            if (health->successes >= ADS_HEALTH_RECOVER_SUCCESSES) {
+                health->state = ADS_HEALTH_HEALTHY;
+            }
+            break;
+    }
+    return false;
+}
+
+bool HOT_PATH(ads_health_failure)(ads_health_t *health, uint32_t now_us) {
+    health->errors++;
+    health->successes = 0;
+
+    if (health->state == ADS_HEALTH_OFFLINE) {
+        // Failed reprobe: back off, up to the maximum interval
+        health->probe_interval_us *= 2;
+        if (health->probe_interval_us > ADS_HEALTH_PROBE_MAX_US) {
+            health->probe_interval_us = ADS_HEALTH_PROBE_MAX_US;
+        }
+        health->next_probe_us = now_us + health->probe_interval_us;
+        return false;
+    }
+
+    health->state = ADS_HEALTH_DEGRADED;
+    if (++health->consecutive_errors < ADS_HEALTH_OFFLINE_ERRORS) {
+        return false;
+    }
+
+    ads_health_offline(health, now_us);
+    return true;
+}
+
+void ads_health_offline(ads_health_t *health, uint32_t now_us) {
+    health->state = ADS_HEALTH_OFFLINE;
+    health->offline_events++;
+    health->probe_interval_us = ADS_HEALTH_PROBE_US;
+    health->next_probe_us = now_us + health->probe_interval_us;
+}
+
+bool HOT_PATH(ads_health_probe_due)(const ads_health_t *health, uint32_t now_us) {
+    return health->state == ADS_HEALTH_OFFLINE && (int32_t)(now_us - health->next_probe_us) >= 0;
+}
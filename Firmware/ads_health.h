@@ -0,0 +1,87 @@
+#ifndef _ADS_HEALTH_H_
+#define _ADS_HEALTH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file ads_health.h
+ * \brief Per-chip health tracking for the ADS1115 converters
+ *
+ * Every transfer outcome is reported to the chip's tracker:
+ *
+ * - HEALTHY: no recent errors.
+ * - DEGRADED: an error happened lately. Readings are still used, and a run
+ *   of good transfers brings the chip back to HEALTHY.
+ * - OFFLINE: too many consecutive errors. The chip is no longer accessed
+ *   except for a reprobe every ADS_HEALTH_PROBE_US, backing off to
+ *   ADS_HEALTH_PROBE_MAX_US. A successful reprobe goes back to DEGRADED.
+ *
+ * The tracker only sees outcomes and timestamps, never the bus, so
+ * host/test_ads_health.c drives it through injected NACKs, timeouts and
+ * reprobes. offline_events and reconnects feed the stats counters.
+*/
+
+#define ADS_HEALTH_OFFLINE_ERRORS 3     // Consecutive errors to go offline
+#define ADS_HEALTH_RECOVER_SUCCESSES 64 // Good transfers to leave DEGRADED
+#define ADS_HEALTH_PROBE_US 100000
+#define ADS_HEALTH_PROBE_MAX_US 2000000
+
+typedef enum ads_health_state {
+    ADS_HEALTH_HEALTHY = 0,
+    ADS_HEALTH_DEGRADED,
+    ADS_HEALTH_OFFLINE
+} ads_health_state_t;
+
+typedef struct ads_health {
+    uint8_t state;              // ads_health_state_t
+    uint8_t consecutive_errors;
+    uint16_t successes;         // Good transfers since the last error
+    uint32_t probe_interval_us;
+    uint32_t next_probe_us;
+
+    // Counters for reporting
+    uint32_t errors;
+    uint32_t offline_events;
+    uint32_t reconnects;        // Successful reprobes
+} ads_health_t;
+
+/*! \brief Start out healthy
+ *
+ * \param health Tracker to initialise
+ */
+void ads_health_init(ads_health_t *health);
+
+/*! \brief Report a successful transfer (or reprobe)
+ *
+ * \param health Tracker
+ * \return true if the chip just came back from OFFLINE and has to be set
+ * up again
+ */
+bool ads_health_success(ads_health_t *health);
+
+/*! \brief Report a failed transfer (or reprobe)
+ *
+ * \param health Tracker
+ * \param now_us Current time in microseconds
+ * \return true if the chip just went OFFLINE
+ */
+bool ads_health_failure(ads_health_t *health, uint32_t now_us);
+
+/*! \brief Take a chip offline straight away
+ *
+ * For a chip that doesn't answer at all, e.g. when probed at boot.
+ *
+ * \param health Tracker
+ * \param now_us Current time in microseconds
+ */
+void ads_health_offline(ads_health_t *health, uint32_t now_us);
+
+/*! \brief Whether an offline chip is due for a reprobe
+ *
+ * \param health Tracker
+ * \param now_us Current time in microseconds
+ * \return true if the chip is OFFLINE and its probe time has come
+ */
+bool ads_health_probe_due(const ads_health_t *health, uint32_t now_us);
+
+#endif
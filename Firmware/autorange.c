@@ -0,0 +1,41 @@
+#include "autorange.h"
+#include "hot_path.h"
+
+void autorange_init(autorange_t *range, int16_t rest, int16_t peak) {
+    range->rest = (int32_t)rest << AUTORANGE_FRAC_BITS;
+    range->peak = (int32_t)peak << AUTORANGE_FRAC_BITS;
+}
+
+void HOT_PATH(autorange_update)(autorange_t *range, int16_t value, bool pressed,
+                                uint8_t shift, int16_t peak_floor) {
+    int32_t x = (int32_t)value << AUTORANGE_FRAC_BITS;
+
+    if (!pressed) {
+        range->rest += (x - range->rest) >> shift;
+        return;
+    }
+
+    // Harder presses read lower: follow them quickly, and lighter ones slowly
+    int32_t rate = x < range->peak ? AUTORANGE_ATTACK_SHIFT : shift;
+    range->peak += (x - range->peak) >> rate;
+
+    int32_t floor = (int32_t)peak_floor << AUTORANGE_FRAC_BITS;
+    if (range->peak < floor) {
+        range->peak = floor;
+    }
+}
+
+int16_t HOT_PATH(autorange_scale)(const autorange_t *range, int16_t value,
+                                  int16_t out_min, int16_t out_max) {
+    int32_t rest = range->rest >> AUTORANGE_FRAC_BITS;
+    int32_t peak = range->peak >> AUTORANGE_FRAC_BITS;
+
+    // Keep a usable span even if the estimates converge (e.g. a dead FSR)
+    if (rest - peak < AUTORANGE_MIN_SPAN) {
+        peak = rest - AUTORANGE_MIN_SPAN;
+    }
+
+    if (value >= rest) return out_min;
+    if (value <= peak) return out_max;
+    return out_min + ((rest - value) * (out_max - out_min)) / (rest - peak);
+}
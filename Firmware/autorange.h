@@ -0,0 +1,57 @@
+#ifndef _AUTORANGE_H_
+#define _AUTORANGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file autorange.h
+ * \brief Per-key adaptive FSR ranging
+ *
+ * Tracks the rest reading (key released) and the peak pressure reading
+ * (key pressed) of one FSR with slow fixed-point estimators, and rescales
+ * readings into the full expression range between them. The FSRs read
+ * lower under more pressure, so the peak is the low end of the range.
+ *
+ * A key that never reaches the static window's full-level reading (a weak
+ * FSR, or a light player) thus still spans the whole output range once its
+ * peak estimate has settled on how hard it is actually pressed.
+*/
+
+#define AUTORANGE_FRAC_BITS 8
+#define AUTORANGE_ATTACK_SHIFT 2    // Response to a new pressure peak
+#define AUTORANGE_MIN_SPAN 2000     // Narrowest range ever used for scaling
+
+typedef struct autorange {
+    int32_t rest;   // Rest reading, Q(AUTORANGE_FRAC_BITS)
+    int32_t peak;   // Peak pressure reading, Q(AUTORANGE_FRAC_BITS)
+} autorange_t;
+
+/*! \brief Seed the estimators, normally with the static calibration window
+ */
+void autorange_init(autorange_t *range, int16_t rest, int16_t peak);
+
+/*! \brief Feed one new reading
+ *
+ * While released the rest estimate follows the reading with time constant
+ * 2^shift samples. While pressed, the peak estimate follows harder presses
+ * quickly (time constant 2^AUTORANGE_ATTACK_SHIFT) and lighter ones with the
+ * slow time constant, so stale extremes are forgotten as the FSR ages or the
+ * playing gets lighter. It never goes below peak_floor.
+ *
+ * \param value Raw FSR reading
+ * \param pressed Whether the key is held
+ * \param shift Adaptation rate, larger is slower
+ * \param peak_floor Lowest peak estimate, normally the full-level reading of
+ * the static window
+ */
+void autorange_update(autorange_t *range, int16_t value, bool pressed,
+                      uint8_t shift, int16_t peak_floor);
+
+/*! \brief Rescale a reading into [out_min, out_max]
+ *
+ * The rest reading maps to out_min and the peak to out_max.
+ */
+int16_t autorange_scale(const autorange_t *range, int16_t value,
+                        int16_t out_min, int16_t out_max);
+
+#endif
@@ -0,0 +1,338 @@
+#include <stdio.h>
+#include "bench.h"
+#include "autorange.h"
+#include "bend_interp.h"
+#include "cc14.h"
+#include "config.h"
+#include "interp_map.h"
+#include "interp_map_check.h"
+#include "pitchmap.h"
+#include "quantizer.h"
+#include "softpot_filter.h"
+#include "synth.h"
+#include "ump.h"
+#include "vibrato.h"
+
+#define MODULATION_MAX 127
+#define SCAN_US 1000                    // Simulated time between readings
+
+typedef struct kernel {
+    const char *name;
+    void (*run)(void);
+} kernel_t;
+
+// Inputs, the same on every platform
+static int16_t softpot_trace[BENCH_INPUTS];
+static int16_t fsr_trace[BENCH_INPUTS];
+static int16_t pot_trace[BENCH_INPUTS];
+
+// Keeps the compiler from dropping the kernels' results
+static volatile int32_t sink;
+
+static quantizer_table_t fret_table;
+static quantizer_t fret_quantizer;
+static int16_t modulation_edges[MODULATION_MAX];
+static quantizer_table_t modulation_table;
+static quantizer_t modulation_quantizer;
+static autorange_t fsr_range;
+static interp_map_scale_t volume_window;
+static interp_map_scale_t fret_bend_scale;
+static interp_map_lut_t bow_lut;
+static int16_t bow_table[129];
+static softpot_filter_t softpot_filter;
+static vibrato_t vibrato;
+static bend_interp_t bend_interp;
+static cc14_t cc14;
+static synth_t synth;
+static int16_t synth_out[BENCH_INPUTS];
+static uint32_t now_us;
+
+static uint32_t random_state = 12345;
+
+static uint32_t next_random() {
+    random_state = random_state * 1664525 + 1013904223;
+    return random_state >> 16;
+}
+
+static int16_t clamp16(int32_t value) {
+    if (value < 0) return 0;
+    if (value > 32767) return 32767;
+    return value;
+}
+
+static void make_inputs() {
+    const stradex_config_t *cfg = &config_defaults;
+    int32_t span = cfg->fret_positions[CONFIG_NUM_FRET_POSITIONS - 1] - cfg->softpot_touch_threshold;
+    int32_t pot = 16384;
+
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        // A finger gliding up the string with noise, lifting one scan in 32
+        int32_t noise = (int32_t)(next_random() % 81) - 40;
+        if (i % 32 == 31) {
+            softpot_trace[i] = next_random() % 2000;
+        } else {
+            softpot_trace[i] = clamp16(cfg->softpot_touch_threshold + (i * span) / BENCH_INPUTS + noise);
+        }
+
+        // Presses anywhere between rest and full pressure
+        fsr_trace[i] = cfg->fsr_min_value + next_random() % (cfg->fsr_max_value - cfg->fsr_min_value);
+
+        // A pot being turned, with noise
+        pot += (int32_t)(next_random() % 401) - 200;
+        pot = clamp16(pot);
+        pot_trace[i] = pot;
+    }
+}
+
+static void setup() {
+    const stradex_config_t *cfg = &config_defaults;
+
+    make_inputs();
+    interp_map_init();
+    quantizer_build_table(&fret_table, cfg->fret_positions, CONFIG_NUM_FRET_POSITIONS);
+    quantizer_init(&fret_quantizer, cfg->fret_positions, CONFIG_NUM_FRET_POSITIONS,
+                   cfg->fret_hysteresis, &fret_table);
+    for (int k = 1; k <= MODULATION_MAX; k++) {
+        modulation_edges[k - 1] = (k * 32767 + MODULATION_MAX - 1) / MODULATION_MAX;
+    }
+    quantizer_build_table(&modulation_table, modulation_edges, MODULATION_MAX);
+    quantizer_init(&modulation_quantizer, modulation_edges, MODULATION_MAX,
+                   cfg->pot_hysteresis, &modulation_table);
+    autorange_init(&fsr_range, cfg->fsr_max_value, cfg->fsr_min_value);
+    interp_map_scale_init(&volume_window, cfg->fsr_min_value, cfg->fsr_max_value, cfg->fsr_min_value,
+                          cfg->volume_max, cfg->volume_min - cfg->volume_max,
+                          cfg->fsr_max_value - cfg->fsr_min_value);
+    interp_map_scale_init(&fret_bend_scale, -cfg->softpot_deviation_max, cfg->softpot_deviation_max, 0,
+                          PITCHMAP_BEND_CENTER, cfg->pitchbend_max_range, cfg->softpot_deviation_max);
+    for (int i = 0; i < 129; i++) {
+        bow_table[i] = next_random() - 32768;
+    }
+    interp_map_lut_init(&bow_lut, bow_table, 129, 8);
+    softpot_filter = (softpot_filter_t){0};
+    vibrato_reset(&vibrato, softpot_trace[0]);
+    bend_interp_reset(&bend_interp, PITCHMAP_BEND_CENTER, 0);
+    cc14_init(&cc14);
+    synth_init(&synth);
+    synth_set_voice(&synth, 0, 62 * SYNTH_PITCH_ONE, 90);
+    synth_set_voice(&synth, 2, 69 * SYNTH_PITCH_ONE, 60);
+    synth_set_modulation(&synth, 40);
+}
+
+// The loop over the inputs alone, for reference
+static void run_overhead() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += softpot_trace[i];
+    }
+    sink = sum;
+}
+
+// get_fret_from_softpot()
+static void run_fret_quantizer() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += quantizer_update(&fret_quantizer, softpot_trace[i]);
+    }
+    sink = sum;
+}
+
+// calculate_pitch_bend()
+static void run_fret_bend() {
+    const stradex_config_t *cfg = &config_defaults;
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        int32_t center = pitchmap_fret_center(cfg->fret_positions, CONFIG_NUM_FRET_POSITIONS, i & 15);
+        sum += interp_map_scale(&fret_bend_scale, softpot_trace[i] - center);
+    }
+    sink = sum;
+}
+
+// fsr_to_volume() with the fixed window
+static void run_fsr_scale_fixed() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += interp_map_scale(&volume_window, fsr_trace[i]);
+    }
+    sink = sum;
+}
+
+static void run_fsr_scale_fixed_soft() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += interp_map_scale_soft(&volume_window, fsr_trace[i]);
+    }
+    sink = sum;
+}
+
+// A 128-step table with 8 bits of interpolation, like the synth's bow table
+static void run_lut_lerp() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += interp_map_lerp(&bow_lut, pot_trace[i]);
+    }
+    sink = sum;
+}
+
+static void run_lut_lerp_soft() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += interp_map_lerp_soft(&bow_lut, pot_trace[i]);
+    }
+    sink = sum;
+}
+
+// fsr_to_volume() with adaptive ranging
+static void run_fsr_scale_adaptive() {
+    const stradex_config_t *cfg = &config_defaults;
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += autorange_scale(&fsr_range, fsr_trace[i], cfg->volume_min, cfg->volume_max);
+    }
+    sink = sum;
+}
+
+static void run_fsr_autorange() {
+    const stradex_config_t *cfg = &config_defaults;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        autorange_update(&fsr_range, fsr_trace[i], fsr_trace[i] < 15000, cfg->fsr_adapt_shift,
+                         cfg->fsr_min_value);
+    }
+    sink = fsr_range.peak;
+}
+
+// pot_to_tuning_offset()
+static void run_tuning_offset() {
+    const stradex_config_t *cfg = &config_defaults;
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += pitchmap_tuning_offset(pot_trace[i], cfg->tuning_min_value, cfg->tuning_max_value,
+                                      cfg->tuning_center_value, cfg->tuning_range);
+    }
+    sink = sum;
+}
+
+// The modulation, expression and FX pots
+static void run_pot_quantizer() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += quantizer_update(&modulation_quantizer, pot_trace[i]);
+    }
+    sink = sum;
+}
+
+static void run_softpot_filter() {
+    const stradex_config_t *cfg = &config_defaults;
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += softpot_filter_update(&softpot_filter, softpot_trace[i], cfg->softpot_touch_threshold,
+                                     cfg->softpot_max_slew);
+    }
+    sink = sum;
+}
+
+static void run_vibrato() {
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        now_us += SCAN_US;
+        vibrato_update(&vibrato, softpot_trace[i], now_us);
+    }
+    sink = vibrato.depth;
+}
+
+// A new bend every fourth output, as with a 4 kHz output rate
+static void run_bend_interp() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        now_us += SCAN_US / 4;
+        if ((i & 3) == 0) {
+            bend_interp_push(&bend_interp, BEND_INTERP_HERMITE, softpot_trace[i] >> 1, now_us);
+        }
+        sum += bend_interp_output(&bend_interp, BEND_INTERP_HERMITE, now_us);
+    }
+    sink = sum;
+}
+
+static void run_cc14() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        sum += cc14_update(&cc14, pot_trace[i] >> 1, true, config_defaults.cc14_noise_gain);
+    }
+    sink = sum;
+}
+
+// A control change built as a UMP and translated for a MIDI 1.0 host
+static void run_midi_pack() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        ump_t packet;
+        uint8_t bytes[UMP_MIDI1_MAX_BYTES];
+        ump_control_change(&packet, 0, 0, 7, ump_scale_up(pot_trace[i] >> 8, 7, 32));
+        sum += ump_to_midi1(&packet, bytes) + bytes[2];
+    }
+    sink = sum;
+}
+
+static void run_pitch_bend_pack() {
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        ump_t packet;
+        uint8_t bytes[UMP_MIDI1_MAX_BYTES];
+        ump_pitch_bend(&packet, 0, 0, ump_scale_up(pot_trace[i] >> 1, 14, 32));
+        sum += ump_to_midi1(&packet, bytes) + bytes[1];
+    }
+    sink = sum;
+}
+
+// One operation is one output sample
+static void run_synth() {
+    synth_render(&synth, synth_out, BENCH_INPUTS);
+    sink = synth_out[BENCH_INPUTS - 1];
+}
+
+static const kernel_t kernels[] = {
+    {"overhead", run_overhead},
+    {"fret_quantizer", run_fret_quantizer},
+    {"fret_bend", run_fret_bend},
+    {"fsr_scale_fixed", run_fsr_scale_fixed},
+    {"fsr_scale_fixed_soft", run_fsr_scale_fixed_soft},
+    {"fsr_scale_adaptive", run_fsr_scale_adaptive},
+    {"fsr_autorange", run_fsr_autorange},
+    {"tuning_offset", run_tuning_offset},
+    {"pot_quantizer", run_pot_quantizer},
+    {"softpot_filter", run_softpot_filter},
+    {"vibrato", run_vibrato},
+    {"bend_interp", run_bend_interp},
+    {"cc14", run_cc14},
+    {"midi_pack_cc", run_midi_pack},
+    {"midi_pack_bend", run_pitch_bend_pack},
+    {"synth_sample", run_synth},
+    {"lut_lerp", run_lut_lerp},
+    {"lut_lerp_soft", run_lut_lerp_soft},
+};
+
+#define NUM_KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+void bench_run(const char *platform, const char *unit, bench_clock_t clock,
+               uint32_t clock_hz, uint32_t rounds) {
+    setup();
+
+    printf("{\"platform\":\"%s\",\"unit\":\"%s\",\"clock_hz\":%lu,\"rounds\":%lu,\"inputs\":%d,\"kernels\":[\n",
+           platform, unit, (unsigned long)clock_hz, (unsigned long)rounds, BENCH_INPUTS);
+    for (uint32_t k = 0; k < NUM_KERNELS; k++) {
+        uint64_t total = 0;
+        uint32_t best = UINT32_MAX;
+
+        kernels[k].run();
+        for (uint32_t r = 0; r < rounds; r++) {
+            uint32_t start = clock();
+            kernels[k].run();
+            uint32_t elapsed = clock() - start;
+            total += elapsed;
+            if (elapsed < best) best = elapsed;
+        }
+
+        double per_op = rounds ? (double)total / ((double)rounds * BENCH_INPUTS) : 0;
+        printf("{\"name\":\"%s\",\"per_op\":%.2f,\"best\":%.2f}%s\n", kernels[k].name, per_op,
+               (double)best / BENCH_INPUTS, k + 1 < NUM_KERNELS ? "," : "");
+    }
+    printf("],\"interp_map_mismatches\":%lu}\n", (unsigned long)interp_map_check());
+}
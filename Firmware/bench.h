@@ -0,0 +1,42 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+
+/** \file bench.h
+ * \brief Microbenchmarks of the per-scan firmware kernels
+ *
+ * Each kernel runs over a fixed, pseudo-random but repeatable set of
+ * sensor readings, so every run and every platform does the same work. The
+ * same source builds into the host benchmark (host/bench_host.c, clock in
+ * nanoseconds) and the device benchmark (bench_pico.c, Cortex-M33 DWT
+ * cycle counter). Results are printed as JSON, one kernel per line, so two
+ * runs can be compared with bench_host --compare.
+ *
+ * Compare runs on the same platform only: the host numbers show whether a
+ * change helps or hurts, the device numbers what it costs in the scan.
+*/
+
+#define BENCH_INPUTS 256                // Operations per timed round
+
+/*! \brief A free-running counter; it may wrap, but not within one round */
+typedef uint32_t (*bench_clock_t)(void);
+
+/*! \brief Run every kernel and print the results as JSON
+ *
+ * Each kernel gets one untimed warm-up round, then rounds timed rounds.
+ * per_op is the mean over all rounds, best the fastest round, both in
+ * clock ticks per operation and including the loop over the inputs. The
+ * output ends with the number of results for which interp_map disagreed
+ * with its straight-line reference (interp_map_check.h), which must be 0.
+ *
+ * \param platform Name recorded in the output, e.g. "host" or "rp2350"
+ * \param unit Unit of the clock, e.g. "ns" or "cycles"
+ * \param clock Clock to time rounds with
+ * \param clock_hz Ticks per second, recorded so cycles can be converted
+ * \param rounds Timed rounds per kernel
+ */
+void bench_run(const char *platform, const char *unit, bench_clock_t clock,
+               uint32_t clock_hz, uint32_t rounds);
+
+#endif
@@ -0,0 +1,39 @@
+// Device build of the kernel microbenchmarks (bench.h), built as the bench
+// executable with STRADEX_BENCH. Times each kernel with the Cortex-M33 DWT
+// cycle counter and prints the JSON over USB serial once a terminal
+// connects; send any character to run it again.
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/m33.h"
+#include "bench.h"
+
+#define ROUNDS 200
+
+static uint32_t read_cycles() {
+    return m33_hw->dwt_cyccnt;
+}
+
+int main() {
+    stdio_init_all();
+
+    // Start the cycle counter
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+
+    while (true) {
+        while (!stdio_usb_connected()) {
+            sleep_ms(100);
+        }
+        sleep_ms(500); // Let the terminal settle
+
+        bench_run("rp2350", "cycles", read_cycles, clock_get_hz(clk_sys), ROUNDS);
+
+        // Wait for a keypress to run again
+        while (getchar_timeout_us(100000) == PICO_ERROR_TIMEOUT) {
+            if (!stdio_usb_connected()) break;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#include "bend_interp.h"
+#include "hot_path.h"
+
+void HOT_PATH(bend_interp_reset)(bend_interp_t *interp, int16_t value, uint32_t now_us) {
+    interp->p_prev = value;
+    interp->p0 = value;
+    interp->p1 = value;
+    interp->t_start = now_us;
+    interp->interval_us = BEND_INTERP_MAX_LAG_US;
+}
+
+void HOT_PATH(bend_interp_push)(bend_interp_t *interp, uint8_t mode, int16_t target, uint32_t now_us) {
+    uint32_t elapsed = now_us - interp->t_start;
+    if (elapsed > BEND_INTERP_MAX_LAG_US) elapsed = BEND_INTERP_MAX_LAG_US;
+    if (elapsed < BEND_INTERP_MIN_LAG_US) elapsed = BEND_INTERP_MIN_LAG_US;
+
+    // Continue from what is being played out so an early sample can't jump
+    int16_t current = bend_interp_output(interp, mode, now_us);
+
+    interp->interval_us += ((int32_t)elapsed - (int32_t)interp->interval_us) / 4;
+    interp->p_prev = interp->p0;
+    interp->p0 = current;
+    interp->p1 = target;
+    interp->t_start = now_us;
+}
+
+int16_t HOT_PATH(bend_interp_output)(const bend_interp_t *interp, uint8_t mode, uint32_t now_us) {
+    uint32_t elapsed = now_us - interp->t_start;
+    if (mode == BEND_INTERP_OFF || elapsed >= interp->interval_us) return interp->p1;
+
+    // Position within the segment, Q15
+    int32_t u = (int32_t)((elapsed << 15) / interp->interval_us);
+    int32_t p0 = interp->p0;
+    int32_t p1 = interp->p1;
+    int32_t value;
+
+    if (mode == BEND_INTERP_LINEAR) {
+        value = p0 + (((p1 - p0) * u) >> 15);
+    } else {
+        // Hermite basis with the incoming slope from the previous segment
+        // and the segment's own slope at the end
+        int32_t m0 = (p1 - interp->p_prev) / 2;
+        int32_t m1 = p1 - p0;
+        int32_t u2 = (u * u) >> 15;
+        int32_t u3 = (u2 * u) >> 15;
+        int32_t h00 = 2 * u3 - 3 * u2 + (1 << 15);
+        int32_t h10 = u3 - 2 * u2 + u;
+        int32_t h01 = -2 * u3 + 3 * u2;
+        int32_t h11 = u3 - u2;
+        value = (h00 * p0 + h10 * m0 + h01 * p1 + h11 * m1) >> 15;
+    }
+
+    if (value < 0) value = 0;
+    if (value > 16383) value = 16383;
+    return value;
+}
@@ -0,0 +1,53 @@
+#ifndef _BEND_INTERP_H_
+#define _BEND_INTERP_H_
+
+#include <stdint.h>
+
+/** \file bend_interp.h
+ * \brief Pitch bend upsampling between sparse softpot samples
+ *
+ * Each new bend target starts a segment from the value currently being
+ * played out to the target, stretched over the measured sample interval.
+ * The output therefore lags the real samples by at most one interval
+ * (bounded by BEND_INTERP_MAX_LAG_US), and a steady target produces a
+ * steady output.
+ *
+ * The caller decides the output rate and only sends values that changed, so
+ * a resting finger goes quiet once its segment has ended.
+ * host/test_bend_interp measures step size and message rate on replayed
+ * slides.
+*/
+
+#define BEND_INTERP_MIN_LAG_US 1000
+#define BEND_INTERP_MAX_LAG_US 20000
+
+enum bend_interp_mode {
+    BEND_INTERP_OFF = 0,
+    BEND_INTERP_LINEAR = 1,
+    BEND_INTERP_HERMITE = 2 // Cubic Hermite, slope carried across samples
+};
+
+typedef struct bend_interp {
+    int16_t p_prev;         // Start of the previous segment
+    int16_t p0;             // Start of the current segment
+    int16_t p1;             // Target of the current segment
+    uint32_t t_start;       // When the current segment started
+    uint32_t interval_us;   // Estimated time between samples
+} bend_interp_t;
+
+/*! \brief Jump straight to a value, e.g. on a new note
+ */
+void bend_interp_reset(bend_interp_t *interp, int16_t value, uint32_t now_us);
+
+/*! \brief Start a new segment towards a freshly sampled bend
+ */
+void bend_interp_push(bend_interp_t *interp, uint8_t mode, int16_t target, uint32_t now_us);
+
+/*! \brief Interpolated bend at a given time
+ *
+ * \param mode One of bend_interp_mode
+ * \return 14-bit bend value
+ */
+int16_t bend_interp_output(const bend_interp_t *interp, uint8_t mode, uint32_t now_us);
+
+#endif
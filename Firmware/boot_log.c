@@ -0,0 +1,44 @@
+#include "boot_log.h"
+#include <stddef.h>
+
+// Folds every word before the check word
+static uint32_t checksum(const boot_log_t *log) {
+    const uint32_t *words = (const uint32_t *)log;
+    uint32_t check = 0;
+    for (unsigned i = 0; i < offsetof(boot_log_t, check) / sizeof(uint32_t); i++) {
+        check = ((check << 5) | (check >> 27)) ^ words[i];
+    }
+    return check;
+}
+
+void boot_log_start(boot_log_t *log, uint32_t now_us) {
+    if (log->magic == BOOT_LOG_MAGIC && log->check == checksum(log)) {
+        for (int i = 0; i < BOOT_NUM_PHASES; i++) {
+            log->previous_us[i] = log->phase_us[i];
+            log->phase_us[i] = 0;
+        }
+        log->boots++;
+    } else {
+        *log = (boot_log_t){.magic = BOOT_LOG_MAGIC, .boots = 1};
+    }
+    boot_log_mark(log, BOOT_PHASE_MAIN, now_us);
+}
+
+void boot_log_mark(boot_log_t *log, boot_phase_t phase, uint32_t now_us) {
+    if (log->phase_us[phase] != 0) return;
+
+    log->phase_us[phase] = now_us ? now_us : 1; // Keep 0 for "not reached"
+    log->check = checksum(log);
+}
+
+bool boot_log_reached(const boot_log_t *log, boot_phase_t phase) {
+    return log->phase_us[phase] != 0;
+}
+
+uint32_t boot_log_phases(const boot_log_t *log) {
+    uint32_t phases = 0;
+    for (int i = 0; i < BOOT_NUM_PHASES; i++) {
+        if (log->phase_us[i] != 0) phases |= 1u << i;
+    }
+    return phases;
+}
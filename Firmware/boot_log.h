@@ -0,0 +1,72 @@
+#ifndef _BOOT_LOG_H_
+#define _BOOT_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file boot_log.h
+ * \brief Timestamps of the boot phases, kept across resets
+ *
+ * The log lives in RAM that the runtime doesn't clear, so after a watchdog
+ * or debugger reset the previous boot's timings are still there next to
+ * the current ones. A check word tells a surviving log from power-on
+ * garbage. Timestamps are time_us_32() values, so they count from the
+ * timer starting at reset; 0 means the phase hasn't been reached.
+ *
+ * The caller provides the storage, in the firmware with
+ * __uninitialized_ram(), and the log never touches the hardware itself.
+ * The stats report the time to the first full scan and to mounting.
+*/
+
+#define BOOT_LOG_MAGIC 0x53314254   // "S1BT"
+
+typedef enum boot_phase {
+    BOOT_PHASE_MAIN = 0,        // main() entered
+    BOOT_PHASE_USB_INIT,        // tud_init() done, the host can start enumerating
+    BOOT_PHASE_TABLES,          // Configuration loaded, maps and tables built
+    BOOT_PHASE_GPIO,            // Buttons and I2C pins set up
+    BOOT_PHASE_ADS_PROBED,      // Every chip probed and configured
+    BOOT_PHASE_I2C_CHECKED,     // Bus speed checked against the chips
+    BOOT_PHASE_FIRST_SCAN,      // First full pass over the sensors: ready to play
+    BOOT_PHASE_MOUNTED,         // The host has mounted the device
+    BOOT_PHASE_FIRST_MIDI,      // First MIDI message queued
+    BOOT_NUM_PHASES
+} boot_phase_t;
+
+typedef struct boot_log {
+    uint32_t magic;
+    uint32_t boots;                         // Since power-on, this one included
+    uint32_t phase_us[BOOT_NUM_PHASES];     // This boot
+    uint32_t previous_us[BOOT_NUM_PHASES];  // The boot before, 0s after power-on
+    uint32_t check;
+} boot_log_t;
+
+/*! \brief Start this boot's log
+ *
+ * Moves a surviving log's timings to previous_us and counts the boot, or
+ * starts from scratch, then records BOOT_PHASE_MAIN.
+ *
+ * \param log Log in uninitialised RAM
+ * \param now_us Current time in microseconds
+ */
+void boot_log_start(boot_log_t *log, uint32_t now_us);
+
+/*! \brief Record that a phase has been reached
+ *
+ * Only the first time counts, later calls for the same phase are ignored.
+ *
+ * \param log Log
+ * \param phase Phase reached
+ * \param now_us Current time in microseconds
+ */
+void boot_log_mark(boot_log_t *log, boot_phase_t phase, uint32_t now_us);
+
+/*! \brief Whether a phase has been reached in this boot
+ */
+bool boot_log_reached(const boot_log_t *log, boot_phase_t phase);
+
+/*! \brief Phases reached in this boot, one bit per boot_phase_t
+ */
+uint32_t boot_log_phases(const boot_log_t *log);
+
+#endif
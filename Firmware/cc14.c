@@ -0,0 +1,50 @@
+#include "cc14.h"
+#include "hot_path.h"
+
+void cc14_init(cc14_t *cc) {
+    *cc = (cc14_t){0};
+    cc->noise = CC14_NOISE_INITIAL << CC14_NOISE_FRAC_BITS;
+    cc->sent = -1;
+}
+
+static void HOT_PATH(track_noise)(cc14_t *cc, int16_t value) {
+    if (cc->num_history == 2) {
+        int32_t curvature = value - 2 * cc->history[0] + cc->history[1];
+        if (curvature < 0) curvature = -curvature;
+        int32_t sample = curvature << (CC14_NOISE_FRAC_BITS - 1);
+
+        int32_t clamp = CC14_NOISE_CLAMP * cc->noise;
+        if (clamp < (CC14_NOISE_CLAMP << CC14_NOISE_FRAC_BITS)) {
+            clamp = CC14_NOISE_CLAMP << CC14_NOISE_FRAC_BITS;
+        }
+        if (sample > clamp) sample = clamp;
+        cc->noise += (sample - cc->noise) >> CC14_NOISE_SHIFT;
+    } else {
+        cc->num_history++;
+    }
+    cc->history[1] = cc->history[0];
+    cc->history[0] = value;
+}
+
+int32_t HOT_PATH(cc14_deadband)(const cc14_t *cc, uint8_t gain) {
+    int32_t deadband = (gain * cc->noise) >> CC14_NOISE_FRAC_BITS;
+    return deadband < 1 ? 1 : deadband;
+}
+
+bool HOT_PATH(cc14_update)(cc14_t *cc, int16_t value, bool fresh, uint8_t gain) {
+    if (value < 0) value = 0;
+    if (value > CC14_MAX) value = CC14_MAX;
+    if (fresh) {
+        track_noise(cc, value);
+    }
+
+    if (cc->sent >= 0) {
+        int32_t change = value > cc->sent ? value - cc->sent : cc->sent - value;
+        bool at_end = value == 0 || value == CC14_MAX;
+        if (change == 0 || (change < cc14_deadband(cc, gain) && !at_end)) {
+            return false;
+        }
+    }
+    cc->sent = value;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef _CC14_H_
+#define _CC14_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file cc14.h
+ * \brief 14-bit controller output with a noise-aware deadband
+ *
+ * A 14-bit controller (MIDI 1.0 MSB/LSB pair, or a MIDI 2.0 controller)
+ * resolves far finer steps than 7 bits, but the low bits of a sensor
+ * reading are mostly noise. Each controller therefore estimates its own
+ * noise floor and only sends a new value once the input has moved by more
+ * than cc14_noise_gain times that floor.
+ *
+ * The floor is the mean absolute second difference of fresh readings,
+ * halved, which is close to the noise standard deviation. A second
+ * difference ignores steady ramps such as a slow swell, and each sample is
+ * clamped to a few times the current floor so that a sudden jump doesn't
+ * inflate it. Values at either end of the range always go out, so a swell
+ * can reach silence and full level exactly.
+ *
+ * The deadband is measured from the last value sent, itself a noisy
+ * reading, so at a gain of 3 a resting input still gets an occasional value
+ * through; a gain of 5 keeps it practically silent.
+*/
+
+#define CC14_MAX 16383
+#define CC14_NOISE_FRAC_BITS 8
+#define CC14_NOISE_SHIFT 6              // Noise floor time constant, samples
+#define CC14_NOISE_CLAMP 4              // Largest sample, in multiples of the floor
+#define CC14_NOISE_INITIAL 4            // Floor before any readings, 14-bit steps
+
+// Controllers that can be sent as 14-bit pairs, bit n of cc14_controllers
+enum cc14_controller {
+    CC14_VOLUME = 0,                    // CC7 / CC39
+    CC14_MODULATION,                    // CC1 / CC33
+    CC14_EXPRESSION,                    // CC11 / CC43
+    CC14_FX,                            // CC2 / CC34
+    CC14_NUM_CONTROLLERS
+};
+
+typedef struct cc14 {
+    int16_t history[2];                 // Last two fresh readings
+    uint8_t num_history;
+    int32_t noise;                      // Noise floor, Q(CC14_NOISE_FRAC_BITS)
+    int16_t sent;                       // Last value sent, -1 before the first
+} cc14_t;
+
+/*! \brief Reset a controller, nothing sent yet
+ */
+void cc14_init(cc14_t *cc);
+
+/*! \brief Feed the current value and decide whether it goes out
+ *
+ * \param cc Controller state
+ * \param value Current value, 0 to CC14_MAX
+ * \param fresh Whether value comes from a new reading; only fresh values
+ * update the noise floor
+ * \param gain Deadband in multiples of the noise floor
+ * \return true if value should be sent; it is then recorded as sent
+ */
+bool cc14_update(cc14_t *cc, int16_t value, bool fresh, uint8_t gain);
+
+/*! \brief Current deadband in 14-bit steps, at least 1
+ */
+int32_t cc14_deadband(const cc14_t *cc, uint8_t gain);
+
+#endif
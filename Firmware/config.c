@@ -0,0 +1,130 @@
+#include "config.h"
+
+const stradex_config_t config_defaults = {
+    .magic = CONFIG_MAGIC,
+    .version = CONFIG_VERSION,
+    .size = sizeof(stradex_config_t),
+    .sequence = 0,
+
+    .fsr_min_value = 1000,
+    .fsr_max_value = 22000,
+    .volume_min = 13,       // ~10%
+    .volume_max = 127,
+    .fsr_adapt_shift = 10,  // ~1000 scans, roughly 10 s
+
+    .tuning_center_value = 13500,
+    .tuning_min_value = 1000,
+    .tuning_max_value = 26000,
+    .tuning_range = 25,
+    .pot_hysteresis = 100,
+    .cc14_controllers = 0,
+    .cc14_noise_gain = 3,
+    .serial_cc_interval_ms = 10,
+    .i2c_speed = 1,
+    .idle_timeout_s = 0,
+    .idle_wake_margin = 1500,
+
+    .fret_hysteresis = 75,
+    .softpot_deviation_max = 500,
+    .pitchbend_max_range = 2048, // ±2 semitones
+    .softpot_touch_threshold = 12500,
+    .softpot_max_slew = 1500,
+    .play_mode = PLAY_MODE_FRETTED,
+    .glide_bend_range = 12,
+    .legato_mode = LEGATO_OFF,
+    .legato_velocity = 0,
+    .bend_interp_mode = 1,  // Linear
+    .bend_interp_us = 2000,
+
+    .vibrato_rate_cc = 0,   // GM2 vibrato rate is CC76
+    .vibrato_depth_cc = 0,  // GM2 vibrato depth is CC77
+    .vibrato_resynth = 0,
+
+    .base_notes = {55, 62, 69, 76}, // G3, D4, A4, E5
+    .fret_positions = {
+        13200, 14000, 14650, 15350, 16150, 16800, 17630, 18550,
+        19300, 20220, 21100, 21950, 22850, 24000, 24950, 26000
+    },
+
+    .crc = 0 // Not checked for the defaults
+};
+
+const stradex_config_t *config = &config_defaults;
+
+// RAM double buffer for live edits: one copy can be active while the other
+// is the shadow being edited
+static stradex_config_t live[2];
+static int shadow_index;
+static bool shadow_valid;
+static bool swap_pending;
+
+uint32_t config_crc(const stradex_config_t *cfg) {
+    const uint8_t *data = (const uint8_t *)cfg;
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < offsetof(stradex_config_t, crc); i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+bool config_is_valid(const stradex_config_t *cfg) {
+    return cfg->magic == CONFIG_MAGIC
+        && cfg->version == CONFIG_VERSION
+        && cfg->size == sizeof(stradex_config_t)
+        && cfg->crc == config_crc(cfg);
+}
+
+bool config_check(const stradex_config_t *cfg) {
+    if (cfg->fsr_min_value >= cfg->fsr_max_value) return false;
+    // pitchmap_tuning_offset() divides by half of tuning_max_value
+    if (cfg->tuning_max_value < 2 || cfg->tuning_min_value >= cfg->tuning_max_value) return false;
+    if (cfg->tuning_center_value < cfg->tuning_min_value
+        || cfg->tuning_center_value > cfg->tuning_max_value) return false;
+    for (int i = 1; i < CONFIG_NUM_FRET_POSITIONS; i++) {
+        if (cfg->fret_positions[i] <= cfg->fret_positions[i - 1]) return false;
+    }
+    return true;
+}
+
+void config_seal(stradex_config_t *cfg, uint32_t sequence) {
+    cfg->magic = CONFIG_MAGIC;
+    cfg->version = CONFIG_VERSION;
+    cfg->size = sizeof(stradex_config_t);
+    cfg->sequence = sequence;
+    cfg->crc = config_crc(cfg);
+}
+
+stradex_config_t *config_begin_edit(void) {
+    // Start from the active values the first time the shadow is touched
+    // after a swap
+    if (!shadow_valid) {
+        live[shadow_index] = *config;
+        shadow_valid = true;
+    }
+    return &live[shadow_index];
+}
+
+void config_publish(void) {
+    if (shadow_valid) {
+        live[shadow_index].crc = config_crc(&live[shadow_index]);
+        swap_pending = true;
+    }
+}
+
+const stradex_config_t *config_latest(void) {
+    return swap_pending ? &live[shadow_index] : config;
+}
+
+bool config_apply_pending(void) {
+    if (!swap_pending) return false;
+
+    config = &live[shadow_index];
+    shadow_index ^= 1;
+    shadow_valid = false;
+    swap_pending = false;
+    return true;
+}
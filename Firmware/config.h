@@ -0,0 +1,147 @@
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** \file config.h
+ * \brief Runtime configuration block (calibration and mapping)
+ *
+ * Everything the interpreter used to take from compile-time constants lives
+ * in one packed, cache-line aligned struct. At boot the active pointer is
+ * aimed straight at the newest valid copy in flash (read through XIP, see
+ * config_store.h), or at the compiled-in defaults.
+*/
+
+#define CONFIG_MAGIC 0x58444453 // "SDDX"
+#define CONFIG_VERSION 12
+#define CONFIG_NUM_STRINGS 4
+#define CONFIG_NUM_FRET_POSITIONS 16
+
+enum config_play_mode {
+    PLAY_MODE_FRETTED = 0,  // Semitone notes, bend around each fret centre
+    PLAY_MODE_GLIDE = 1     // Fretless: one note per slide, pitch as bend
+};
+
+enum config_legato_mode {
+    LEGATO_OFF = 0,         // Note off, then note on
+    LEGATO_OVERLAP = 1,     // New note on before the old note off
+    LEGATO_BEND = 2         // Fret changes within a slide are bend only
+};
+
+typedef struct __attribute__((packed, aligned(32))) stradex_config {
+    // Header
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                  // sizeof(stradex_config_t)
+    uint32_t sequence;              // Write counter, the highest valid copy wins
+
+    // FSR to volume mapping
+    int16_t fsr_min_value;          // FSR value for maximum volume
+    int16_t fsr_max_value;          // FSR value for minimum volume
+    int16_t volume_min;
+    int16_t volume_max;
+    int16_t fsr_adapt_shift;        // Per-key auto-ranging rate, 0 = fixed window
+
+    // Tuning potentiometer
+    int16_t tuning_center_value;
+    int16_t tuning_min_value;
+    int16_t tuning_max_value;
+    int16_t tuning_range;           // Semitones at either end of the pot
+    int16_t pot_hysteresis;         // Tuning and modulation pot step hysteresis
+
+    // High-resolution controllers
+    int16_t cc14_controllers;       // Bit per cc14_controller sent as a 14-bit pair
+    int16_t cc14_noise_gain;        // 14-bit deadband in multiples of the noise floor
+    int16_t serial_cc_interval_ms;  // Serial MIDI: shortest gap between two values of a CC, 0 = none
+
+    // Sensor bus
+    int16_t i2c_speed;              // i2c_bus_speed_t: 0 = 100 kHz, 1 = 400 kHz, 2 = 1 MHz, 3 = 3.4 MHz
+    int16_t idle_timeout_s;         // Seconds without playing before the scan stops, 0 = never
+    int16_t idle_wake_margin;       // Wake comparator window, +/- this around the resting reading
+
+    // Softpot
+    int16_t fret_hysteresis;
+    int16_t softpot_deviation_max;  // Deviation from fret centre for full bend
+    int16_t pitchbend_max_range;    // Bend at full deviation (2048 = 2 semitones)
+    int16_t softpot_touch_threshold; // Readings below this mean no finger
+    int16_t softpot_max_slew;       // Largest believable step per sample, 0 = unfiltered
+    int16_t play_mode;              // config_play_mode
+    int16_t glide_bend_range;       // Glide mode bend range in semitones (RPN 0)
+    int16_t legato_mode;            // config_legato_mode
+    int16_t legato_velocity;        // Legato note on velocity, 0 = reuse the held note's
+    int16_t bend_interp_mode;       // bend_interp_mode (see bend_interp.h)
+    int16_t bend_interp_us;         // Interpolated bend output period
+
+    // Vibrato detection
+    int16_t vibrato_rate_cc;        // CC for the detected rate, 0 = off
+    int16_t vibrato_depth_cc;       // CC for the detected depth, 0 = off
+    int16_t vibrato_resynth;        // Replace raw vibrato with a smooth sine
+
+    // Mapping
+    int16_t base_notes[CONFIG_NUM_STRINGS];
+    int16_t fret_positions[CONFIG_NUM_FRET_POSITIONS];
+
+    uint32_t crc;                   // CRC-32 of everything above
+} stradex_config_t;
+
+// Compiled-in defaults, used when flash holds no valid configuration
+extern const stradex_config_t config_defaults;
+
+// Configuration the interpreter reads from. Only ever re-pointed between
+// frames (see config_apply_pending()), so a frame never sees a half update.
+extern const stradex_config_t *config;
+
+/*! \brief CRC-32 (IEEE) of a configuration, up to but excluding the crc field
+ */
+uint32_t config_crc(const stradex_config_t *cfg);
+
+/*! \brief Check the header and CRC of a configuration block
+ */
+bool config_is_valid(const stradex_config_t *cfg);
+
+/*! \brief Check that the fields of a configuration work together
+ *
+ * Each field's own range is the SysEx parameter table's business; this
+ * rejects combinations the interpreter can't work with: an empty FSR or
+ * tuning window, a tuning centre outside it, a tuning pot too short to
+ * halve, or fret positions that don't increase.
+ */
+bool config_check(const stradex_config_t *cfg);
+
+/*! \brief Fill in the header and CRC of a configuration before it is stored
+ *
+ * \param sequence Write counter for the new copy
+ */
+void config_seal(stradex_config_t *cfg, uint32_t sequence);
+
+/*! \brief Get the shadow configuration for live edits
+ *
+ * The shadow starts as a copy of the active configuration and collects
+ * edits until config_publish(). It is never the block the interpreter
+ * is reading.
+ */
+stradex_config_t *config_begin_edit(void);
+
+/*! \brief Mark the shadow configuration ready to be swapped in
+ */
+void config_publish(void);
+
+/*! \brief Get the configuration as last edited
+ *
+ * The published shadow while its swap is pending, the active configuration
+ * otherwise. What a host reads back or stores right after a set has to
+ * come from here, not from config.
+ */
+const stradex_config_t *config_latest(void);
+
+/*! \brief Swap a published shadow configuration in
+ *
+ * Call at a frame boundary only. The swap is a single pointer store.
+ *
+ * \return true if the active configuration changed
+ */
+bool config_apply_pending(void);
+
+#endif
@@ -0,0 +1,45 @@
+#include "config_flash.h"
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+#define CONFIG_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - CONFIG_STORE_SIZE)
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;
+} flash_op_t;
+
+// These run with the other core and interrupts locked out, so they must not
+// touch flash themselves
+static void __not_in_flash_func(do_erase)(void *param) {
+    flash_op_t *op = param;
+    flash_range_erase(CONFIG_FLASH_OFFSET + op->offset, CONFIG_STORE_SECTOR_SIZE);
+}
+
+static void __not_in_flash_func(do_program)(void *param) {
+    flash_op_t *op = param;
+    flash_range_program(CONFIG_FLASH_OFFSET + op->offset, op->data, CONFIG_STORE_SLOT_SIZE);
+}
+
+// flash_safe_execute() fails if the other core can't be locked out, in
+// which case nothing was erased or programmed
+static bool erase_sector(uint32_t offset) {
+    flash_op_t op = {offset, NULL};
+    return flash_safe_execute(do_erase, &op, UINT32_MAX) == PICO_OK;
+}
+
+static bool program_page(uint32_t offset, const uint8_t *data) {
+    flash_op_t op = {offset, data};
+    return flash_safe_execute(do_program, &op, UINT32_MAX) == PICO_OK;
+}
+
+static const config_store_flash_t pico_flash = {
+    .base = (const uint8_t *)(XIP_BASE + CONFIG_FLASH_OFFSET),
+    .erase_sector = erase_sector,
+    .program_page = program_page
+};
+
+const config_store_flash_t *config_flash_pico(void) {
+    return &pico_flash;
+}
@@ -0,0 +1,16 @@
+#ifndef _CONFIG_FLASH_H_
+#define _CONFIG_FLASH_H_
+
+#include "config_store.h"
+
+/** \file config_flash.h
+ * \brief Pico flash backend for the configuration store
+ *
+ * The store occupies the last CONFIG_STORE_SIZE bytes of flash.
+*/
+
+/*! \brief Flash operations for config_store_init()
+ */
+const config_store_flash_t *config_flash_pico(void);
+
+#endif
@@ -0,0 +1,66 @@
+#include "config_store.h"
+#include <string.h>
+
+_Static_assert(sizeof(stradex_config_t) <= CONFIG_STORE_SLOT_SIZE,
+               "configuration must fit in one flash page");
+
+static const stradex_config_t *slot_at(const config_store_t *store, int slot) {
+    return (const stradex_config_t *)(store->flash->base + slot * CONFIG_STORE_SLOT_SIZE);
+}
+
+static bool slot_is_blank(const config_store_t *store, int slot) {
+    const uint8_t *data = (const uint8_t *)slot_at(store, slot);
+    for (int i = 0; i < CONFIG_STORE_SLOT_SIZE; i++) {
+        if (data[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+const stradex_config_t *config_store_init(config_store_t *store,
+                                          const config_store_flash_t *flash) {
+    store->flash = flash;
+    store->active_slot = -1;
+
+    // The magic check rejects blank slots cheaply; only candidates that would
+    // win get their CRC checked
+    for (int slot = 0; slot < CONFIG_STORE_NUM_SLOTS; slot++) {
+        const stradex_config_t *cfg = slot_at(store, slot);
+        if (cfg->magic != CONFIG_MAGIC) continue;
+        if (store->active_slot >= 0 && cfg->sequence <= slot_at(store, store->active_slot)->sequence) continue;
+        if (config_is_valid(cfg)) store->active_slot = slot;
+    }
+
+    return store->active_slot >= 0 ? slot_at(store, store->active_slot) : NULL;
+}
+
+const stradex_config_t *config_store_write(config_store_t *store,
+                                           const stradex_config_t *cfg) {
+    uint32_t sequence = 1;
+    int slot = 0;
+    if (store->active_slot >= 0) {
+        sequence = slot_at(store, store->active_slot)->sequence + 1;
+        slot = (store->active_slot + 1) % CONFIG_STORE_NUM_SLOTS;
+    }
+
+    // Skip slots left dirty by an interrupted write, but never wrap back into
+    // the sector holding the active copy
+    while (slot % CONFIG_STORE_SLOTS_PER_SECTOR != 0 && !slot_is_blank(store, slot)) {
+        slot = (slot + 1) % CONFIG_STORE_NUM_SLOTS;
+    }
+
+    // Entering a sector: erase it. The active copy lives in the other one.
+    if (slot % CONFIG_STORE_SLOTS_PER_SECTOR == 0
+        && !store->flash->erase_sector(slot * CONFIG_STORE_SLOT_SIZE)) {
+        return NULL;
+    }
+
+    uint8_t page[CONFIG_STORE_SLOT_SIZE] __attribute__((aligned(32)));
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, cfg, sizeof(stradex_config_t));
+    config_seal((stradex_config_t *)page, sequence);
+    if (!store->flash->program_page(slot * CONFIG_STORE_SLOT_SIZE, page)) return NULL;
+    if (!config_is_valid(slot_at(store, slot))) return NULL;
+
+    store->active_slot = slot;
+    return slot_at(store, slot);
+}
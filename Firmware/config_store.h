@@ -0,0 +1,57 @@
+#ifndef _CONFIG_STORE_H_
+#define _CONFIG_STORE_H_
+
+#include "config.h"
+
+/** \file config_store.h
+ * \brief Wear-levelled, power-loss safe configuration store in flash
+ *
+ * The store spans two flash sectors cut into page-sized slots. Each write
+ * goes to the next blank slot with a higher sequence number; a sector is
+ * only erased when the ring moves into it, so the newest complete copy in
+ * the other sector survives a power loss during the erase or the program.
+ *
+ * Reads never copy: the newest valid slot is used in place through XIP.
+ * The flash operations are passed in so the store also runs on the host.
+*/
+
+#define CONFIG_STORE_SECTOR_SIZE 4096
+#define CONFIG_STORE_NUM_SECTORS 2
+#define CONFIG_STORE_SIZE (CONFIG_STORE_SECTOR_SIZE * CONFIG_STORE_NUM_SECTORS)
+#define CONFIG_STORE_SLOT_SIZE 256 // One flash page
+#define CONFIG_STORE_NUM_SLOTS (CONFIG_STORE_SIZE / CONFIG_STORE_SLOT_SIZE)
+#define CONFIG_STORE_SLOTS_PER_SECTOR (CONFIG_STORE_SECTOR_SIZE / CONFIG_STORE_SLOT_SIZE)
+
+typedef struct config_store_flash {
+    const uint8_t *base; // Memory-mapped (XIP) address of the store region
+    // Erase one sector, offset relative to base; false if the flash
+    // couldn't be claimed
+    bool (*erase_sector)(uint32_t offset);
+    // Program one slot-sized page, offset relative to base; false as above
+    bool (*program_page)(uint32_t offset, const uint8_t *data);
+} config_store_flash_t;
+
+typedef struct config_store {
+    const config_store_flash_t *flash;
+    int active_slot; // -1 when the store holds no valid configuration
+} config_store_t;
+
+/*! \brief Find the newest valid configuration in flash
+ *
+ * \return Pointer into flash, or NULL if the store is empty
+ */
+const stradex_config_t *config_store_init(config_store_t *store,
+                                          const config_store_flash_t *flash);
+
+/*! \brief Store a new configuration
+ *
+ * The header and CRC are filled in here. On success the returned pointer
+ * is the new copy in flash, ready to be used in place.
+ *
+ * \return Pointer into flash, or NULL if a flash operation failed or the
+ *         written copy didn't verify
+ */
+const stradex_config_t *config_store_write(config_store_t *store,
+                                           const stradex_config_t *cfg);
+
+#endif
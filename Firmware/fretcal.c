@@ -0,0 +1,116 @@
+#include "fretcal.h"
+#include <math.h>
+
+// Fraction of the scale length between the nut and fret n
+static float fret_fraction(float fret) {
+    return 1.0f - exp2f(-fret / 12.0f);
+}
+
+void fretcal_reset(fretcal_session_t *session) {
+    session->num_samples = 0;
+}
+
+bool fretcal_add_sample(fretcal_session_t *session, float fret, int16_t value) {
+    if (session->num_samples >= FRETCAL_MAX_SAMPLES) return false;
+
+    session->samples[session->num_samples].fret = fret;
+    session->samples[session->num_samples].value = value;
+    session->num_samples++;
+    return true;
+}
+
+// Solve the n x n system m * x = v in place by Gaussian elimination with
+// partial pivoting
+static bool solve_linear(double m[3][3], double v[3], int n) {
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++) {
+            if (fabs(m[row][col]) > fabs(m[pivot][col])) pivot = row;
+        }
+        if (fabs(m[pivot][col]) < 1e-12) return false;
+
+        if (pivot != col) {
+            for (int k = 0; k < n; k++) {
+                double t = m[col][k]; m[col][k] = m[pivot][k]; m[pivot][k] = t;
+            }
+            double t = v[col]; v[col] = v[pivot]; v[pivot] = t;
+        }
+
+        for (int row = col + 1; row < n; row++) {
+            double f = m[row][col] / m[col][col];
+            for (int k = col; k < n; k++) m[row][k] -= f * m[col][k];
+            v[row] -= f * v[col];
+        }
+    }
+
+    for (int row = n - 1; row >= 0; row--) {
+        for (int k = row + 1; k < n; k++) v[row] -= m[row][k] * v[k];
+        v[row] /= m[row][row];
+    }
+    return true;
+}
+
+bool fretcal_solve(const fretcal_session_t *session, fretcal_fit_t *fit) {
+    // Count distinct reference frets; the quadratic term needs three
+    int distinct = 0;
+    for (int i = 0; i < session->num_samples; i++) {
+        bool seen = false;
+        for (int j = 0; j < i; j++) {
+            if (session->samples[j].fret == session->samples[i].fret) seen = true;
+        }
+        if (!seen) distinct++;
+    }
+    if (distinct < 2) return false;
+    int n = distinct >= 3 ? 3 : 2;
+
+    // Accumulate the normal equations
+    double m[3][3] = {{0}};
+    double v[3] = {0};
+    for (int i = 0; i < session->num_samples; i++) {
+        double x = fret_fraction(session->samples[i].fret);
+        double basis[3] = {1.0, x, x * x};
+        for (int r = 0; r < n; r++) {
+            for (int k = 0; k < n; k++) m[r][k] += basis[r] * basis[k];
+            v[r] += basis[r] * session->samples[i].value;
+        }
+    }
+    if (!solve_linear(m, v, n)) return false;
+
+    fit->a = v[0];
+    fit->b = v[1];
+    fit->c = n == 3 ? v[2] : 0.0f;
+
+    // The response has to rise over the whole fingerboard (x in [0, 1])
+    if (fit->b <= 0.0f || fit->b + 2.0f * fit->c <= 0.0f) return false;
+
+    double sum_sq = 0;
+    for (int i = 0; i < session->num_samples; i++) {
+        double e = fretcal_eval(fit, session->samples[i].fret) - session->samples[i].value;
+        sum_sq += e * e;
+    }
+    fit->rms_error = sqrt(sum_sq / session->num_samples);
+    return true;
+}
+
+float fretcal_eval(const fretcal_fit_t *fit, float fret) {
+    float x = fret_fraction(fret);
+    return fit->a + fit->b * x + fit->c * x * x;
+}
+
+bool fretcal_build_table(const fretcal_fit_t *fit, int16_t *positions) {
+    float previous = 0.0f;
+    int16_t table[FRETCAL_NUM_BOUNDARIES];
+
+    for (int i = 0; i < FRETCAL_NUM_BOUNDARIES; i++) {
+        float value = fretcal_eval(fit, i + 0.5f);
+        if (value <= previous || value > INT16_MAX) return false;
+        table[i] = (int16_t)lrintf(value);
+        previous = value;
+    }
+
+    // Only touch the live table once the whole fit is known to be usable
+    for (int i = 0; i < FRETCAL_NUM_BOUNDARIES; i++) {
+        positions[i] = table[i];
+    }
+    return true;
+}
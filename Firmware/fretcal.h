@@ -0,0 +1,76 @@
+#ifndef _FRETCAL_H_
+#define _FRETCAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file fretcal.h
+ * \brief Fret map calibration by least-squares fit of the softpot response
+ *
+ * Fret n sits at a fraction x(n) = 1 - 2^(-n/12) of the scale length from
+ * the nut (12-TET spacing law). The softpot reading is modelled as
+ *
+ *     adc(n) = a + b * x(n) + c * x(n)^2
+ *
+ * where c absorbs the per-unit nonlinearity of the resistive track. The
+ * coefficients are fitted by least squares from reference touches, and the
+ * fret boundary table is regenerated from the fitted curve.
+ *
+ * The fit solves the 3x3 normal equations in double precision, which is cheap
+ * enough to run on the instrument once after the last reference fret.
+ * host/fretcal_fit runs the same code on a recorded sweep.
+*/
+
+#define FRETCAL_MAX_SAMPLES 64
+#define FRETCAL_NUM_BOUNDARIES 16
+
+typedef struct fretcal_sample {
+    float fret;     // Reference fret the player touched
+    int16_t value;  // Softpot reading at that fret
+} fretcal_sample_t;
+
+typedef struct fretcal_fit {
+    float a, b, c;      // Model coefficients
+    float rms_error;    // Residual RMS over the samples, in ADC units
+} fretcal_fit_t;
+
+typedef struct fretcal_session {
+    fretcal_sample_t samples[FRETCAL_MAX_SAMPLES];
+    uint8_t num_samples;
+} fretcal_session_t;
+
+/*! \brief Discard all samples in a calibration session
+ */
+void fretcal_reset(fretcal_session_t *session);
+
+/*! \brief Add one reference touch to a calibration session
+ *
+ * \return false if the session is full
+ */
+bool fretcal_add_sample(fretcal_session_t *session, float fret, int16_t value);
+
+/*! \brief Fit the softpot model to the session samples
+ *
+ * Three or more distinct frets fit the full model; two frets fit a purely
+ * linear track (c = 0).
+ *
+ * \return false if there are too few samples or the fit isn't monotonic
+ * over the fingerboard
+ */
+bool fretcal_solve(const fretcal_session_t *session, fretcal_fit_t *fit);
+
+/*! \brief Evaluate the fitted model at a (fractional) fret
+ */
+float fretcal_eval(const fretcal_fit_t *fit, float fret);
+
+/*! \brief Regenerate the fret boundary table from a fit
+ *
+ * Boundary i separates fret i from fret i + 1 and sits halfway between
+ * them, so each fret is centred in its band.
+ *
+ * \param positions Output table of FRETCAL_NUM_BOUNDARIES values
+ * \return false if the table would not be strictly increasing in range
+ */
+bool fretcal_build_table(const fretcal_fit_t *fit, int16_t *positions);
+
+#endif
@@ -0,0 +1,119 @@
+// Runs the firmware kernel microbenchmarks (bench.c) on the host and prints
+// nanoseconds per operation as JSON, or compares two saved runs.
+//
+// Any two runs with the same kernels can be compared, including a device
+// run captured from the bench firmware's USB serial output; lines that
+// aren't kernel results are ignored. A kernel whose best time grew by more
+// than the threshold is reported as a regression and the exit status is 1,
+// as it is when the run found interp_map mismatches.
+//
+//   bench_host [-r rounds] > run.json
+//   bench_host --compare baseline.json run.json [-t percent]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+
+#define MAX_KERNELS 64
+
+typedef struct {
+    char name[64];
+    double per_op;
+    double best;
+} result_t;
+
+static uint32_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+static int read_results(const char *path, result_t *results, unsigned long *mismatches) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+
+    int count = 0;
+    char line[256];
+    *mismatches = 0;
+    while (fgets(line, sizeof(line), in) && count < MAX_KERNELS) {
+        result_t *r = &results[count];
+        const char *start = strstr(line, "{\"name\":");
+        const char *check = strstr(line, "\"interp_map_mismatches\":");
+        if (check) {
+            sscanf(check, "\"interp_map_mismatches\":%lu", mismatches);
+        }
+        if (start && sscanf(start, "{\"name\":\"%63[^\"]\",\"per_op\":%lf,\"best\":%lf",
+                            r->name, &r->per_op, &r->best) == 3) {
+            count++;
+        }
+    }
+    fclose(in);
+    return count;
+}
+
+static int compare(const char *baseline_path, const char *run_path, double threshold) {
+    static result_t baseline[MAX_KERNELS], run[MAX_KERNELS];
+    unsigned long baseline_mismatches, mismatches;
+    int num_baseline = read_results(baseline_path, baseline, &baseline_mismatches);
+    int num_run = read_results(run_path, run, &mismatches);
+    if (num_baseline < 0 || num_run < 0) return 2;
+
+    int regressions = 0;
+    printf("%-20s %10s %10s %8s\n", "kernel", "baseline", "run", "change");
+    for (int i = 0; i < num_run; i++) {
+        const result_t *before = NULL;
+        for (int j = 0; j < num_baseline; j++) {
+            if (strcmp(baseline[j].name, run[i].name) == 0) before = &baseline[j];
+        }
+        if (!before) {
+            printf("%-20s %10s %10.2f %8s\n", run[i].name, "-", run[i].best, "new");
+            continue;
+        }
+
+        double change = before->best > 0 ? 100.0 * (run[i].best - before->best) / before->best : 0;
+        bool regressed = change > threshold;
+        printf("%-20s %10.2f %10.2f %+7.1f%%%s\n", run[i].name, before->best, run[i].best, change,
+               regressed ? "  REGRESSION" : "");
+        if (regressed) regressions++;
+    }
+
+    if (mismatches) {
+        printf("%lu interp_map mismatches\n", mismatches);
+    }
+    if (regressions) {
+        printf("%d kernel(s) more than %.0f%% slower\n", regressions, threshold);
+    }
+    return regressions || mismatches ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t rounds = 2000;
+    double threshold = 10;
+    const char *compare_paths[2] = {NULL, NULL};
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            compare_paths[0] = argv[++i];
+            compare_paths[1] = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [-r rounds] | --compare baseline.json run.json [-t percent]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (compare_paths[0]) {
+        return compare(compare_paths[0], compare_paths[1], threshold);
+    }
+    bench_run("host", "ns", now_ns, 1000000000, rounds);
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Fits a recorded calibration sweep the same way the firmware's calibration
+// mode does and prints the regenerated fret_positions table.
+//
+// Input is CSV, one "fret,value" sample per line; several samples per fret
+// are fine. Lines starting with '#' are ignored.
+//
+//   fretcal_fit sweep.csv
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "fretcal.h"
+
+int main(int argc, char **argv) {
+    FILE *in = argc > 1 ? fopen(argv[1], "r") : stdin;
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fretcal_session_t session;
+    fretcal_reset(&session);
+
+    char line[128];
+    while (fgets(line, sizeof(line), in)) {
+        float fret;
+        int value;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%f,%d", &fret, &value) != 2) continue;
+        if (!fretcal_add_sample(&session, fret, value)) {
+            fprintf(stderr, "too many samples, keeping the first %d\n", FRETCAL_MAX_SAMPLES);
+            break;
+        }
+    }
+
+    fretcal_fit_t fit;
+    if (!fretcal_solve(&session, &fit)) {
+        fprintf(stderr, "fit failed (%d samples)\n", session.num_samples);
+        return 1;
+    }
+    printf("// a = %.1f, b = %.1f, c = %.1f, rms error = %.1f\n", fit.a, fit.b, fit.c, fit.rms_error);
+
+    int16_t positions[FRETCAL_NUM_BOUNDARIES];
+    if (!fretcal_build_table(&fit, positions)) {
+        fprintf(stderr, "fitted response is not usable as a fret map\n");
+        return 1;
+    }
+
+    printf("int16_t fret_positions[%d] = {\n", FRETCAL_NUM_BOUNDARIES);
+    for (int i = 0; i < FRETCAL_NUM_BOUNDARIES; i++) {
+        printf("    %d,\n", positions[i]);
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Runs MIDI 1.0 messages through the serial MIDI encoder (serial_midi.h)
+// and prints the exact byte stream it would put on the 31250 baud link.
+//
+// Input is text, one line per write: a time in microseconds, then the
+// message bytes in hex, e.g. "12000 B0 07 64". A line may hold several
+// messages, like the translation of one UMP. '#' starts a comment. Held
+// controllers are polled at every input time and once more after the last.
+//
+// Every line of output is a time and the bytes queued at that time, so a
+// run can be diffed byte for byte against a saved one. Counters go to
+// stderr.
+//
+//   serial_midi_dump [-i cc_interval_ms] [trace.txt]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial_midi.h"
+
+static serial_midi_t serial;
+
+// Print and release everything queued so far
+static void drain(uint32_t now_us) {
+    const uint8_t *data;
+    uint32_t count;
+    bool any = false;
+    while ((count = serial_midi_peek(&serial, &data)) > 0) {
+        if (!any) printf("%u", (unsigned)now_us);
+        any = true;
+        for (uint32_t i = 0; i < count; i++) {
+            printf(" %02X", data[i]);
+        }
+        serial_midi_consume(&serial, count);
+    }
+    if (any) printf("\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t interval_ms = 10;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:")) != -1) {
+        if (opt == 'i') {
+            interval_ms = atoi(optarg);
+        } else {
+            fprintf(stderr, "usage: serial_midi_dump [-i cc_interval_ms] [trace.txt]\n");
+            return 2;
+        }
+    }
+
+    FILE *in = stdin;
+    if (optind < argc) {
+        in = fopen(argv[optind], "r");
+        if (!in) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    serial_midi_init(&serial, interval_ms * 1000);
+    char line[1024];
+    uint32_t first_us = 0, last_us = 0;
+    bool started = false;
+    while (fgets(line, sizeof(line), in)) {
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char *p = line;
+        char *end;
+        unsigned long time = strtoul(p, &end, 10);
+        if (end == p) continue;
+        p = end;
+
+        uint8_t bytes[sizeof(line) / 2];
+        uint32_t len = 0;
+        unsigned long byte;
+        while ((byte = strtoul(p, &end, 16)), end != p) {
+            bytes[len++] = (uint8_t)byte;
+            p = end;
+        }
+
+        uint32_t now = (uint32_t)time;
+        if (!started) first_us = now;
+        started = true;
+        last_us = now;
+        serial_midi_write(&serial, bytes, len, now);
+        serial_midi_poll(&serial, now);
+        drain(now);
+    }
+    if (in != stdin) fclose(in);
+
+    last_us += interval_ms * 1000;
+    serial_midi_poll(&serial, last_us);
+    drain(last_us);
+
+    const serial_midi_stats_t *stats = &serial.stats;
+    double seconds = (last_us - first_us) / 1e6;
+    fprintf(stderr, "messages %u, bytes %u, status bytes saved %u\n",
+            (unsigned)stats->messages, (unsigned)stats->bytes, (unsigned)stats->status_saved);
+    fprintf(stderr, "controllers held %u, replaced %u, dropped bytes %u\n",
+            (unsigned)stats->cc_held, (unsigned)stats->cc_replaced, (unsigned)stats->dropped_bytes);
+    if (seconds > 0) {
+        fprintf(stderr, "link load %.1f%% of %d bytes/s\n",
+                100.0 * stats->bytes / seconds / (SERIAL_MIDI_BAUD / 10), SERIAL_MIDI_BAUD / 10);
+    }
+    return 0;
+}
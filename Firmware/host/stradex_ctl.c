@@ -0,0 +1,217 @@
+// Command line client for the Stradex1 SysEx live-parameter protocol.
+// Talks to the raw ALSA MIDI device of the instrument, e.g. /dev/snd/midiC1D0
+// (see `amidi -l`).
+//
+//   stradex_ctl <device> get <param>[.<index>]
+//   stradex_ctl <device> set <param>[.<index>] <value>
+//   stradex_ctl <device> dump | stats | store | defaults
+//   stradex_ctl <device> load <file>
+//
+// A load file has one "<param>[.<index>] <value>" per line, '#' starts a
+// comment. Every line is set in turn, stopping at the first failure.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sysex.h"
+
+#define REPLY_TIMEOUT_MS 500
+
+static const char *stats_names[] = {
+    "midi_messages", "midi_bytes", "midi_dropped_bytes", "midi_unmounted",
+    "loops", "loop_us_max", "scans_completed",
+    "softpot_held_samples", "softpot_releases",
+    "i2c_transactions", "i2c_bytes", "i2c_errors", "i2c_bus_recoveries",
+    "ads_health", "i2c_bus_us", "scan_us", "i2c_baudrate",
+    "synth_underruns", "synth_render_cycles_max", "midi_ump_bytes",
+    "xip_misses_max", "boot_ready_us", "boot_mounted_us", "idle_wake_us_max",
+    "midi_dropped_replies", "i2c_speed_stepdowns",
+    "cal_status", "cal_fret", "cal_rms_error", "sensor_channels",
+    "ads_offline_events", "ads_reconnects", "boot_phases_unreported",
+    "softpot_spurious_changes"
+};
+
+// Counter the next stats page starts at, or -1 once every page is in
+static int stats_next = -1;
+
+static int parse_param(const char *arg, uint8_t *id) {
+    char name[64];
+    int index = 0;
+
+    strncpy(name, arg, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    char *dot = strchr(name, '.');
+    if (dot) {
+        *dot = '\0';
+        index = atoi(dot + 1);
+    }
+
+    const sysex_param_t *param = sysex_find_param_by_name(name);
+    if (!param || index < 0 || index >= param->count) {
+        fprintf(stderr, "unknown parameter %s\n", arg);
+        return -1;
+    }
+    *id = param->id + index;
+    return 0;
+}
+
+static void print_param(uint8_t id, int16_t value) {
+    uint8_t index;
+    const sysex_param_t *param = sysex_find_param(id, &index);
+    if (!param) {
+        printf("0x%02x = %d\n", id, value);
+    } else if (param->count > 1) {
+        printf("%s.%d = %d\n", param->name, index, value);
+    } else {
+        printf("%s = %d\n", param->name, value);
+    }
+}
+
+// Print replies until none arrives for REPLY_TIMEOUT_MS. Returns the status
+// of the last ACK, or 0 if there was none.
+static int read_replies(int fd) {
+    sysex_parser_t parser = {0};
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int status = 0;
+    uint8_t byte;
+
+    while (poll(&pfd, 1, REPLY_TIMEOUT_MS) > 0) {
+        if (read(fd, &byte, 1) != 1) break;
+        if (!sysex_parse(&parser, byte)) continue;
+
+        const uint8_t *data = &parser.buffer[3];
+        switch (parser.buffer[2]) {
+            case SYSEX_REPLY_VALUE:
+                print_param(data[0], sysex_decode_value(&data[1]));
+                break;
+            case SYSEX_REPLY_ACK:
+                status = data[1];
+                if (status != SYSEX_STATUS_OK) {
+                    fprintf(stderr, "command 0x%02x failed, status %d\n", data[0], status);
+                }
+                break;
+            case SYSEX_REPLY_STATS: {
+                int start = data[0], count = data[1], total = data[2];
+                for (int i = start; i < start + count; i++) {
+                    uint32_t counter = 0;
+                    for (int k = 0; k < 5; k++) {
+                        counter = (counter << 7) | data[3 + (i - start) * 5 + k];
+                    }
+                    if (i < (int)(sizeof(stats_names) / sizeof(stats_names[0]))) {
+                        printf("%s = %u\n", stats_names[i], counter);
+                    } else {
+                        printf("counter%d = %u\n", i, counter);
+                    }
+                }
+                stats_next = count > 0 && start + count < total ? start + count : -1;
+                break;
+            }
+        }
+    }
+    return status;
+}
+
+// Send one command and print its replies. Returns the ACK status.
+static int send_command(int fd, uint8_t command, const uint8_t *payload, uint32_t payload_len) {
+    uint8_t msg[SYSEX_MAX_LENGTH];
+    uint32_t len = sysex_build(command, payload, payload_len, msg);
+    if (write(fd, msg, len) != (ssize_t)len) {
+        fprintf(stderr, "write failed\n");
+        return SYSEX_STATUS_FAILED;
+    }
+    return read_replies(fd);
+}
+
+// Fetch the counters a page at a time
+static int print_stats(int fd) {
+    uint8_t start = 0;
+    int status;
+    do {
+        stats_next = -1;
+        status = send_command(fd, SYSEX_CMD_STATS, &start, 1);
+        start = (uint8_t)stats_next;
+    } while (status == SYSEX_STATUS_OK && stats_next > 0);
+    return status;
+}
+
+static int load_params(int fd, const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return SYSEX_STATUS_FAILED;
+    }
+
+    char line[128], name[64];
+    int value;
+    int status = SYSEX_STATUS_OK;
+    while (status == SYSEX_STATUS_OK && fgets(line, sizeof(line), in)) {
+        if (line[0] == '#' || sscanf(line, "%63s %d", name, &value) != 2) continue;
+
+        uint8_t payload[4];
+        if (parse_param(name, &payload[0])) {
+            status = SYSEX_STATUS_UNKNOWN_PARAM;
+            break;
+        }
+        sysex_encode_value(value, &payload[1]);
+        status = send_command(fd, SYSEX_CMD_SET, payload, 4);
+    }
+    fclose(in);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <device> get|set|dump|stats|store|defaults|load [args]\n", argv[0]);
+        return 1;
+    }
+
+    uint8_t payload[4];
+    uint32_t payload_len = 0;
+    uint8_t command;
+    const char *verb = argv[2];
+
+    if (strcmp(verb, "get") == 0 && argc == 4) {
+        command = SYSEX_CMD_GET;
+        if (parse_param(argv[3], &payload[0])) return 1;
+        payload_len = 1;
+    } else if (strcmp(verb, "set") == 0 && argc == 5) {
+        command = SYSEX_CMD_SET;
+        if (parse_param(argv[3], &payload[0])) return 1;
+        sysex_encode_value(atoi(argv[4]), &payload[1]);
+        payload_len = 4;
+    } else if (strcmp(verb, "dump") == 0) {
+        command = SYSEX_CMD_DUMP;
+    } else if (strcmp(verb, "stats") == 0) {
+        command = SYSEX_CMD_STATS;
+    } else if (strcmp(verb, "store") == 0) {
+        command = SYSEX_CMD_STORE;
+    } else if (strcmp(verb, "defaults") == 0) {
+        command = SYSEX_CMD_DEFAULTS;
+    } else if (strcmp(verb, "load") == 0 && argc == 4) {
+        command = SYSEX_CMD_SET;
+    } else {
+        fprintf(stderr, "bad command %s\n", verb);
+        return 1;
+    }
+
+    int fd = open(argv[1], O_RDWR);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    int status;
+    if (strcmp(verb, "load") == 0) {
+        status = load_params(fd, argv[3]);
+    } else if (command == SYSEX_CMD_STATS) {
+        status = print_stats(fd);
+    } else {
+        status = send_command(fd, command, payload, payload_len);
+    }
+    close(fd);
+    return status == SYSEX_STATUS_OK ? 0 : 1;
+}
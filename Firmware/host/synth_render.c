@@ -0,0 +1,159 @@
+// Renders a test performance through the firmware's bowed-string synth to a
+// 48 kHz mono WAV file, and reports how long the rendering took per sample.
+//
+// The score is text, one event per line, applied at its time and held until
+// the next one. Lines starting with '#' are ignored.
+//
+//   <seconds> <string> <note> <pressure 0-127> <modulation 0-127>
+//
+// Notes may be fractional (bends). Without a score, a built-in phrase is
+// played: a scale on each string with swelling pressure and late vibrato.
+//
+//   synth_render out.wav [score.txt]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "synth.h"
+
+#define MAX_EVENTS 1024
+
+typedef struct {
+    double time;
+    int string;
+    double note;
+    int pressure;
+    int modulation;
+} event_t;
+
+static event_t events[MAX_EVENTS];
+static int num_events;
+
+static void add_event(double time, int string, double note, int pressure, int modulation) {
+    if (num_events == MAX_EVENTS) return;
+    events[num_events++] = (event_t){time, string, note, pressure, modulation};
+}
+
+static void builtin_score() {
+    static const int scale[] = {0, 2, 4, 5, 7, 9, 11, 12};
+    static const int strings[] = {55, 62, 69, 76};
+    double time = 0;
+
+    for (int s = 0; s < 4; s++) {
+        for (int i = 0; i < 8; i++) {
+            for (int k = 0; k < 8; k++) {
+                // Swell each note, with vibrato coming in on the second half
+                double t = time + k * 0.05;
+                add_event(t, s, strings[s] + scale[i], 30 + 12 * k, k < 4 ? 0 : 25 * (k - 3));
+            }
+            time += 0.4;
+        }
+        add_event(time, s, strings[s] + 12, 0, 0);
+        time += 0.3;
+    }
+    add_event(time + 1.0, 0, strings[0], 0, 0);
+}
+
+static int read_score(const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 0;
+    }
+
+    char line[128];
+    while (fgets(line, sizeof(line), in)) {
+        event_t e;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%lf %d %lf %d %d", &e.time, &e.string, &e.note, &e.pressure, &e.modulation) != 5) continue;
+        if (e.string < 0 || e.string >= SYNTH_NUM_VOICES) continue;
+        add_event(e.time, e.string, e.note, e.pressure, e.modulation);
+    }
+    fclose(in);
+    return 1;
+}
+
+static void put_u32(FILE *out, uint32_t value) {
+    uint8_t bytes[4] = {value, value >> 8, value >> 16, value >> 24};
+    fwrite(bytes, 1, 4, out);
+}
+
+static void put_u16(FILE *out, uint16_t value) {
+    uint8_t bytes[2] = {value, value >> 8};
+    fwrite(bytes, 1, 2, out);
+}
+
+static void write_wav_header(FILE *out, uint32_t samples) {
+    fwrite("RIFF", 1, 4, out);
+    put_u32(out, 36 + samples * 2);
+    fwrite("WAVEfmt ", 1, 8, out);
+    put_u32(out, 16);
+    put_u16(out, 1);                        // PCM
+    put_u16(out, 1);                        // Mono
+    put_u32(out, SYNTH_SAMPLE_RATE);
+    put_u32(out, SYNTH_SAMPLE_RATE * 2);
+    put_u16(out, 2);
+    put_u16(out, 16);
+    fwrite("data", 1, 4, out);
+    put_u32(out, samples * 2);
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s out.wav [score.txt]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2) {
+        if (!read_score(argv[2])) return 1;
+    } else {
+        builtin_score();
+    }
+    if (num_events == 0) {
+        fprintf(stderr, "empty score\n");
+        return 1;
+    }
+
+    double length = events[num_events - 1].time + 2.0;
+    uint32_t samples = (uint32_t)(length * SYNTH_SAMPLE_RATE) / SYNTH_BLOCK * SYNTH_BLOCK;
+    int16_t *audio = malloc(samples * sizeof(int16_t));
+
+    static synth_t synth;
+    synth_init(&synth);
+
+    // Apply events at block boundaries, as the firmware does
+    int next = 0;
+    double elapsed = 0;
+    for (uint32_t n = 0; n < samples; n += SYNTH_BLOCK) {
+        double time = (double)n / SYNTH_SAMPLE_RATE;
+        while (next < num_events && events[next].time <= time) {
+            event_t *e = &events[next++];
+            synth_set_voice(&synth, e->string, (int32_t)(e->note * SYNTH_PITCH_ONE + 0.5), e->pressure);
+            synth_set_modulation(&synth, e->modulation);
+        }
+        double start = now_ns();
+        synth_render(&synth, &audio[n], SYNTH_BLOCK);
+        elapsed += now_ns() - start;
+    }
+
+    FILE *out = fopen(argv[1], "wb");
+    if (!out) {
+        perror(argv[1]);
+        return 1;
+    }
+    write_wav_header(out, samples);
+    for (uint32_t n = 0; n < samples; n++) {
+        put_u16(out, (uint16_t)audio[n]);
+    }
+    fclose(out);
+
+    printf("%u samples, %.1f ns per sample (%d voices)\n", samples, elapsed / samples, SYNTH_NUM_VOICES);
+    free(audio);
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef _TEST_H_
+#define _TEST_H_
+
+// Checks for the host tests run by ctest. A failed check prints where it
+// failed and the test carries on, so one run shows every failure; main()
+// returns test_result() as the exit status.
+
+#include <stdio.h>
+
+static int test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+        long long actual_ = (long long)(actual), expected_ = (long long)(expected); \
+        if (actual_ != expected_) { \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+                    #actual, actual_, expected_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+static inline int test_result(void) {
+    if (test_failures) fprintf(stderr, "%d checks failed\n", test_failures);
+    return test_failures ? 1 : 0;
+}
+
+#endif
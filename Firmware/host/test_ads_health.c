@@ -0,0 +1,223 @@
+// ADS1115 health tracking (ads_health.h) under injected faults.
+//
+// A simulated chip is polled once a millisecond the way read_ads_channels()
+// does: transfers while it is online, reprobes when one is due while it is
+// offline. Scripted faults stand in for the bus: isolated NACKs, a burst of
+// NACKs, a hang that times out on every transfer for a while, and a chip
+// that is missing at boot. The checks follow the state machine through
+// each of them: when it goes offline, how the reprobes back off, when it
+// comes back and when it is healthy again, and what the counters say.
+
+#include "ads_health.h"
+#include "test.h"
+
+#define POLL_US 1000
+
+typedef struct chip {
+    ads_health_t health;
+    uint32_t now_us;
+    uint32_t transfers;         // Bus accesses, transfers and reprobes
+    uint32_t probe_times[16];   // When the last reprobes happened
+    int num_probes;
+    int went_offline;
+    int came_back;
+} chip_t;
+
+static void chip_init(chip_t *chip) {
+    *chip = (chip_t){0};
+    ads_health_init(&chip->health);
+}
+
+// One poll: returns whether the bus was accessed. fail is the outcome the
+// fault script has for any access at this time.
+static bool poll(chip_t *chip, bool fail) {
+    chip->now_us += POLL_US;
+    if (chip->health.state == ADS_HEALTH_OFFLINE) {
+        if (!ads_health_probe_due(&chip->health, chip->now_us)) return false;
+        if (chip->num_probes < 16) chip->probe_times[chip->num_probes] = chip->now_us;
+        chip->num_probes++;
+    }
+    chip->transfers++;
+    if (fail) {
+        if (ads_health_failure(&chip->health, chip->now_us)) chip->went_offline++;
+    } else if (ads_health_success(&chip->health)) {
+        chip->came_back++;
+    }
+    return true;
+}
+
+static void poll_for(chip_t *chip, uint32_t duration_us, bool fail) {
+    for (uint32_t t = 0; t < duration_us; t += POLL_US) poll(chip, fail);
+}
+
+static void test_isolated_nacks(void) {
+    chip_t chip;
+    chip_init(&chip);
+
+    // A NACK now and then, fewer than ADS_HEALTH_OFFLINE_ERRORS in a row
+    for (int n = 0; n < 100; n++) {
+        for (int i = 0; i < ADS_HEALTH_OFFLINE_ERRORS - 1; i++) poll(&chip, true);
+        CHECK_EQ(chip.health.state, ADS_HEALTH_DEGRADED);
+        poll(&chip, false);
+    }
+    CHECK_EQ(chip.went_offline, 0);
+    CHECK_EQ(chip.health.errors, 100 * (ADS_HEALTH_OFFLINE_ERRORS - 1));
+    CHECK_EQ(chip.health.offline_events, 0);
+
+    // A clean run brings it back to healthy, not one transfer earlier. The
+    // last round above already had one good transfer.
+    for (int i = 2; i < ADS_HEALTH_RECOVER_SUCCESSES; i++) poll(&chip, false);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_DEGRADED);
+    poll(&chip, false);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_HEALTHY);
+
+    // An error just short of recovery starts the count over
+    poll(&chip, true);
+    for (int i = 0; i < ADS_HEALTH_RECOVER_SUCCESSES - 1; i++) poll(&chip, false);
+    poll(&chip, true);
+    for (int i = 0; i < ADS_HEALTH_RECOVER_SUCCESSES - 1; i++) poll(&chip, false);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_DEGRADED);
+}
+
+// Check the reprobes so far were spaced ADS_HEALTH_PROBE_US apart, doubling
+// up to ADS_HEALTH_PROBE_MAX_US, starting from the time the chip went offline
+static void check_backoff(const chip_t *chip, uint32_t offline_us) {
+    uint32_t interval = ADS_HEALTH_PROBE_US;
+    uint32_t previous = offline_us;
+    for (int i = 0; i < chip->num_probes && i < 16; i++) {
+        // Polling rounds each probe up to the next poll
+        uint32_t gap = chip->probe_times[i] - previous;
+        CHECK(gap >= interval && gap < interval + POLL_US);
+        previous = chip->probe_times[i];
+        interval *= 2;
+        if (interval > ADS_HEALTH_PROBE_MAX_US) interval = ADS_HEALTH_PROBE_MAX_US;
+    }
+}
+
+static void test_hang(void) {
+    chip_t chip;
+    chip_init(&chip);
+    poll_for(&chip, 10000, false);
+
+    // The chip holds the bus: every transfer times out for 20 s
+    uint32_t hang_start = chip.now_us;
+    poll(&chip, true);
+    poll(&chip, true);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_DEGRADED);
+    poll(&chip, true);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_OFFLINE);
+    CHECK_EQ(chip.went_offline, 1);
+    uint32_t offline_us = chip.now_us;
+    CHECK_EQ(offline_us - hang_start, ADS_HEALTH_OFFLINE_ERRORS * POLL_US);
+
+    // Offline, the bus is only touched by the backed-off reprobes
+    uint32_t transfers = chip.transfers;
+    poll_for(&chip, 20000000 - (offline_us - hang_start), true);
+    CHECK(chip.num_probes >= 10 && chip.num_probes <= 16);
+    CHECK_EQ(chip.transfers - transfers, chip.num_probes);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_OFFLINE);
+    CHECK_EQ(chip.went_offline, 1);
+    CHECK_EQ(chip.health.offline_events, 1);
+    CHECK_EQ(chip.health.probe_interval_us, ADS_HEALTH_PROBE_MAX_US);
+    check_backoff(&chip, offline_us);
+
+    // The hang clears: the next reprobe, at most the maximum interval
+    // later, brings the chip back
+    int probes = chip.num_probes;
+    uint32_t clear_us = chip.now_us;
+    while (chip.num_probes == probes) poll(&chip, false);
+    CHECK(chip.now_us - clear_us <= ADS_HEALTH_PROBE_MAX_US);
+    CHECK_EQ(chip.came_back, 1);
+    CHECK_EQ(chip.health.reconnects, 1);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_DEGRADED);
+    poll_for(&chip, ADS_HEALTH_RECOVER_SUCCESSES * POLL_US, false);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_HEALTHY);
+
+    // A second hang backs off from the start again
+    chip.num_probes = 0;
+    poll_for(&chip, ADS_HEALTH_OFFLINE_ERRORS * POLL_US, true);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_OFFLINE);
+    offline_us = chip.now_us;
+    poll_for(&chip, 1000000, true);
+    CHECK(chip.num_probes >= 3);
+    check_backoff(&chip, offline_us);
+    CHECK_EQ(chip.health.offline_events, 2);
+}
+
+static void test_nack_burst(void) {
+    chip_t chip;
+    chip_init(&chip);
+
+    // A chip briefly pulled off its connector: NACKs for 50 ms. It goes
+    // offline and is back on the first reprobe after that.
+    poll_for(&chip, 50000, true);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_OFFLINE);
+    CHECK_EQ(chip.health.errors, ADS_HEALTH_OFFLINE_ERRORS);
+    uint32_t deadline = chip.now_us + ADS_HEALTH_PROBE_US;
+    while (!chip.came_back && chip.now_us < deadline) poll(&chip, false);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_DEGRADED);
+    CHECK_EQ(chip.num_probes, 1);
+    CHECK_EQ(chip.health.reconnects, 1);
+
+    // The reprobe itself doesn't count towards the run back to healthy
+    chip_t rerun = chip;
+    poll_for(&rerun, (ADS_HEALTH_RECOVER_SUCCESSES - 1) * POLL_US, false);
+    CHECK_EQ(rerun.health.state, ADS_HEALTH_DEGRADED);
+    poll(&rerun, false);
+    CHECK_EQ(rerun.health.state, ADS_HEALTH_HEALTHY);
+
+    // A failure while degraded after a reprobe counts towards going
+    // offline again from zero
+    poll(&chip, true);
+    poll(&chip, false);
+    poll(&chip, true);
+    poll(&chip, true);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_DEGRADED);
+    poll(&chip, true);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_OFFLINE);
+    CHECK_EQ(chip.health.offline_events, 2);
+}
+
+static void test_missing_at_boot(void) {
+    chip_t chip;
+    chip_init(&chip);
+
+    // Not found at boot: offline straight away, without three failures
+    chip.now_us = 123456;
+    ads_health_offline(&chip.health, chip.now_us);
+    CHECK_EQ(chip.health.offline_events, 1);
+    CHECK(!ads_health_probe_due(&chip.health, chip.now_us));
+    CHECK(!ads_health_probe_due(&chip.health, chip.now_us + ADS_HEALTH_PROBE_US - 1));
+    CHECK(ads_health_probe_due(&chip.health, chip.now_us + ADS_HEALTH_PROBE_US));
+
+    // Plugged in later
+    poll_for(&chip, 3000000, true);
+    poll_for(&chip, ADS_HEALTH_PROBE_MAX_US, false);
+    CHECK(chip.health.state != ADS_HEALTH_OFFLINE);
+    CHECK_EQ(chip.health.reconnects, 1);
+    CHECK_EQ(chip.health.offline_events, 1);
+}
+
+static void test_timer_wrap(void) {
+    chip_t chip;
+    chip_init(&chip);
+
+    // Going offline with the first reprobe due after the 32-bit
+    // microsecond timer wraps
+    chip.now_us = UINT32_MAX - ADS_HEALTH_PROBE_US / 2;
+    poll_for(&chip, ADS_HEALTH_OFFLINE_ERRORS * POLL_US, true);
+    CHECK_EQ(chip.health.state, ADS_HEALTH_OFFLINE);
+    uint32_t offline_us = chip.now_us;
+    poll_for(&chip, 500000, true);
+    CHECK(chip.num_probes >= 2);
+    check_backoff(&chip, offline_us);
+}
+
+int main(void) {
+    test_isolated_nacks();
+    test_hang();
+    test_nack_burst();
+    test_missing_at_boot();
+    test_timer_wrap();
+    return test_result();
+}
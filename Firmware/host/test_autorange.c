@@ -0,0 +1,97 @@
+// Adaptive FSR ranging (autorange.h) on a replayed weak-key trace.
+//
+// The trace is a key whose FSR rests around 21000 and only gets down to
+// about 12000 when pressed, far short of the static window's full-level
+// reading (config_defaults.fsr_min_value). Released for 100 scans, pressed
+// for 200, with a little noise, at the default adaptation rate. Once the
+// peak estimate has settled, every press must reach the top of the output
+// range.
+
+#include "autorange.h"
+#include "config.h"
+#include "test.h"
+
+#define OUT_MIN 0
+#define OUT_MAX 127
+#define REST 21000
+#define WEAK_PRESS 12000
+#define RELEASED_SCANS 100
+#define PRESSED_SCANS 200
+#define NUM_PRESSES 80
+
+static uint32_t noise_state = 1;
+
+// Deterministic noise in [-amplitude, amplitude]
+static int16_t noise(int16_t amplitude) {
+    noise_state = noise_state * 1103515245u + 12345u;
+    return (int16_t)((int32_t)((noise_state >> 16) % (2u * amplitude + 1)) - amplitude);
+}
+
+// Replay one release and one press, returns the highest output while pressed
+static int16_t replay_press(autorange_t *range, int16_t press, int16_t *lowest_released) {
+    uint8_t shift = config_defaults.fsr_adapt_shift;
+    int16_t floor = config_defaults.fsr_min_value;
+    int16_t highest = OUT_MIN;
+
+    *lowest_released = OUT_MAX;
+    for (int i = 0; i < RELEASED_SCANS; i++) {
+        int16_t value = REST + noise(100);
+        autorange_update(range, value, false, shift, floor);
+        int16_t out = autorange_scale(range, value, OUT_MIN, OUT_MAX);
+        if (out < *lowest_released) *lowest_released = out;
+    }
+    for (int i = 0; i < PRESSED_SCANS; i++) {
+        int16_t value = press + noise(150);
+        autorange_update(range, value, true, shift, floor);
+        int16_t out = autorange_scale(range, value, OUT_MIN, OUT_MAX);
+        if (out > highest) highest = out;
+    }
+    return highest;
+}
+
+static void test_weak_key(void) {
+    autorange_t range;
+    autorange_init(&range, config_defaults.fsr_max_value, config_defaults.fsr_min_value);
+
+    int16_t released;
+    int16_t first = replay_press(&range, WEAK_PRESS, &released);
+
+    // The static window puts this key at about half level
+    CHECK(first < OUT_MAX * 3 / 4);
+
+    int16_t highest = first;
+    for (int n = 1; n < NUM_PRESSES; n++) {
+        highest = replay_press(&range, WEAK_PRESS, &released);
+    }
+    CHECK_EQ(highest, OUT_MAX);
+    CHECK_EQ(released, OUT_MIN);
+
+    // The plateau of a press sits near the top, not only its noise peaks
+    int16_t plateau = autorange_scale(&range, WEAK_PRESS, OUT_MIN, OUT_MAX);
+    CHECK(plateau >= OUT_MAX - 8);
+}
+
+static void test_hard_press(void) {
+    autorange_t range;
+    autorange_init(&range, config_defaults.fsr_max_value, config_defaults.fsr_min_value);
+    int16_t released;
+    for (int n = 0; n < NUM_PRESSES; n++) replay_press(&range, WEAK_PRESS, &released);
+
+    // A harder press is followed within a few scans
+    uint8_t shift = config_defaults.fsr_adapt_shift;
+    int16_t floor = config_defaults.fsr_min_value;
+    for (int i = 0; i < 16; i++) autorange_update(&range, 6000, true, shift, floor);
+    CHECK(range.peak >> AUTORANGE_FRAC_BITS < 6100);
+    CHECK_EQ(autorange_scale(&range, 6000, OUT_MIN, OUT_MAX), OUT_MAX);
+    CHECK(autorange_scale(&range, WEAK_PRESS, OUT_MIN, OUT_MAX) < OUT_MAX * 3 / 4);
+
+    // ...but never past the floor
+    for (int i = 0; i < 64; i++) autorange_update(&range, 200, true, shift, floor);
+    CHECK_EQ(range.peak >> AUTORANGE_FRAC_BITS, floor);
+}
+
+int main(void) {
+    test_weak_key();
+    test_hard_press();
+    return test_result();
+}
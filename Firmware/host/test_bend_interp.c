@@ -0,0 +1,133 @@
+// Pitch bend interpolation (bend_interp.h) on recorded slides.
+//
+// A slide is a bend sampled every ~10 ms with some jitter, as the softpot
+// is refreshed once per ADS2 scan, followed by the finger resting. It is
+// replayed the way the main loop does: one output every bend_interp_us,
+// sent only if it changed. For each mode the test measures the largest step
+// between two sent values and the message rate, and checks that a resting
+// finger stops the messages and that the output reaches the last sample
+// within the lag bound.
+
+#include <stdlib.h>
+#include "bend_interp.h"
+#include "config.h"
+#include "test.h"
+
+#define LOOP_US 250             // Main loop pass
+#define SAMPLE_US 10400         // Softpot refresh
+#define SAMPLE_JITTER_US 1500
+#define REST_US 100000          // Finger resting after the slide
+
+typedef struct slide {
+    int16_t from, to;
+    int num_samples;
+} slide_t;
+
+typedef struct result {
+    int32_t max_step;           // Largest change between two sent values
+    int32_t max_sample_step;    // Largest change between two samples
+    int messages;
+    int messages_resting;       // After the output has settled
+    uint32_t duration_us;
+    uint32_t settle_us;         // Last sample to the output reaching it
+    int16_t lowest, highest;    // Range of the sent values
+} result_t;
+
+static uint32_t jitter_state = 7;
+
+static int32_t jitter(void) {
+    jitter_state = jitter_state * 1103515245u + 12345u;
+    return (int32_t)((jitter_state >> 16) % (2 * SAMPLE_JITTER_US + 1)) - SAMPLE_JITTER_US;
+}
+
+static result_t replay(uint8_t mode, const slide_t *slide) {
+    result_t r = {.lowest = 16383, .highest = 0};
+    bend_interp_t interp;
+    uint32_t period = config_defaults.bend_interp_us;
+    uint32_t now = 1000;
+    uint32_t next_sample = now;
+    uint32_t last_output = now;
+    uint32_t last_sample_us = 0;
+    int16_t target = slide->from;
+    int16_t sent = slide->from;
+    int sample = 0;
+    bool settled = false;
+
+    bend_interp_reset(&interp, target, now);
+    uint32_t end = now + slide->num_samples * SAMPLE_US + REST_US;
+    for (; now < end; now += LOOP_US) {
+        if (sample < slide->num_samples && now >= next_sample) {
+            sample++;
+            int16_t value = slide->from + (int32_t)(slide->to - slide->from) * sample / slide->num_samples;
+            if (abs(value - target) > r.max_sample_step) r.max_sample_step = abs(value - target);
+            target = value;
+            bend_interp_push(&interp, mode, target, now);
+            next_sample = now + SAMPLE_US + jitter();
+            last_sample_us = now;
+        }
+
+        if (now - last_output < period) continue;
+        last_output = now;
+        int16_t out = bend_interp_output(&interp, mode, now);
+        if (out == sent) continue;
+
+        if (abs(out - sent) > r.max_step) r.max_step = abs(out - sent);
+        if (out < r.lowest) r.lowest = out;
+        if (out > r.highest) r.highest = out;
+        sent = out;
+        r.messages++;
+        if (settled) r.messages_resting++;
+        if (!settled && sample == slide->num_samples && out == slide->to) {
+            settled = true;
+            r.settle_us = now - last_sample_us;
+        }
+    }
+    r.duration_us = slide->num_samples * SAMPLE_US;
+    CHECK(settled);
+    return r;
+}
+
+static void check_slide(const slide_t *slide) {
+    result_t off = replay(BEND_INTERP_OFF, slide);
+    result_t linear = replay(BEND_INTERP_LINEAR, slide);
+    result_t hermite = replay(BEND_INTERP_HERMITE, slide);
+    int16_t lowest = slide->from < slide->to ? slide->from : slide->to;
+    int16_t highest = slide->from < slide->to ? slide->to : slide->from;
+
+    printf("slide %5d -> %5d: max step off %4d linear %4d hermite %4d, "
+           "messages off %3d linear %3d hermite %3d\n",
+           slide->from, slide->to, (int)off.max_step, (int)linear.max_step, (int)hermite.max_step,
+           off.messages, linear.messages, hermite.messages);
+
+    // Without interpolation every sample is one step
+    CHECK_EQ(off.max_step, off.max_sample_step);
+
+    // Interpolated steps are a fraction of a sample step: at least four
+    // outputs per sample interval
+    CHECK(linear.max_step * 4 <= off.max_step + 4);
+    CHECK(hermite.max_step * 3 <= off.max_step + 4);
+
+    // Never more than one message per output period, and none once resting
+    uint32_t max_messages = (off.duration_us + REST_US) / config_defaults.bend_interp_us + 1;
+    CHECK(linear.messages <= (int)max_messages);
+    CHECK(hermite.messages <= (int)max_messages);
+    CHECK_EQ(linear.messages_resting, 0);
+    CHECK_EQ(hermite.messages_resting, 0);
+
+    // Bounded lag, and no overshoot past the slide's ends
+    uint32_t max_settle_us = BEND_INTERP_MAX_LAG_US + config_defaults.bend_interp_us;
+    CHECK(linear.settle_us <= max_settle_us);
+    CHECK(hermite.settle_us <= max_settle_us);
+    CHECK(linear.lowest >= lowest && linear.highest <= highest);
+    CHECK(hermite.lowest >= lowest - 64 && hermite.highest <= highest + 64);
+}
+
+int main(void) {
+    const slide_t slides[] = {
+        {8192, 14000, 20},      // Fast slide up, ~300 per sample
+        {12000, 2000, 12},      // Faster slide down
+        {8192, 8700, 40},       // Slow drift, ~13 per sample
+    };
+    for (unsigned i = 0; i < sizeof(slides) / sizeof(slides[0]); i++) check_slide(&slides[i]);
+    return test_result();
+}
@@ -0,0 +1,151 @@
+// 14-bit controller deadband (cc14.h) on replayed pot traces.
+//
+// A resting pot with Gaussian noise must mostly stay quiet once the noise
+// floor has settled: at the default gain the deadband is about three
+// standard deviations, and only about one reading in twenty gets through.
+// The floor must come out close to the noise standard deviation. A slow swell through the whole range must follow the
+// input within the deadband and still reach both ends exactly. A sudden
+// jump must go out at once without inflating the floor, and values that
+// aren't fresh readings must leave the floor alone.
+
+#include "cc14.h"
+#include "config.h"
+#include "test.h"
+
+#define SIGMA 8
+#define SETTLE 1000
+
+static uint32_t noise_state = 3;
+
+// Sum of twelve uniforms on [0, 1) less 6 is close to a unit Gaussian;
+// scaled to a standard deviation of SIGMA
+static int16_t noise(void) {
+    int32_t sum = 0;
+    for (int i = 0; i < 12; i++) {
+        noise_state = noise_state * 1103515245u + 12345u;
+        sum += (noise_state >> 8) & 0xFFFF;
+    }
+    return (int16_t)(((sum - 6 * 0x10000) * SIGMA) >> 16);
+}
+
+static int32_t abs32(int32_t x) {
+    return x < 0 ? -x : x;
+}
+
+static int rest(uint8_t gain, int readings) {
+    cc14_t cc;
+    cc14_init(&cc);
+    for (int i = 0; i < SETTLE; i++) cc14_update(&cc, 8000 + noise(), true, gain);
+    int sent = 0;
+    for (int i = 0; i < readings; i++) {
+        if (cc14_update(&cc, 8000 + noise(), true, gain)) sent++;
+    }
+    return sent;
+}
+
+static void test_resting(void) {
+    uint8_t gain = config_defaults.cc14_noise_gain;
+    cc14_t cc;
+    cc14_init(&cc);
+    for (int i = 0; i < SETTLE; i++) cc14_update(&cc, 8000 + noise(), true, gain);
+
+    // The floor estimates the standard deviation
+    int32_t floor = cc.noise >> CC14_NOISE_FRAC_BITS;
+    CHECK(floor >= SIGMA / 2 && floor <= SIGMA * 2);
+
+    int sent = 0;
+    for (int i = 0; i < 10000; i++) {
+        if (cc14_update(&cc, 8000 + noise(), true, gain)) sent++;
+    }
+    CHECK(sent < 10000 / 10);
+    CHECK(abs32(cc.sent - 8000) <= cc14_deadband(&cc, gain));
+
+    // A wider deadband quietens it further, a narrower one lets noise through
+    CHECK(rest(5, 10000) < 10000 / 100);
+    CHECK(rest(1, 10000) > 10000 / 4);
+}
+
+static void test_swell(void) {
+    uint8_t gain = config_defaults.cc14_noise_gain;
+    cc14_t cc;
+    cc14_init(&cc);
+
+    // From silence to full level and back, one 14-bit step every few
+    // readings, clipped at the ends the way a pedal's reading is
+    int32_t max_error = 0;
+    int sent = 0;
+    bool reached_top = false;
+    bool reached_bottom = false;
+    const int32_t half = 2 * (CC14_MAX + 400);
+    for (int32_t i = 0; i < 2 * half; i++) {
+        int32_t ramp = (i < half ? i : 2 * half - i) / 2 - 200;
+        int32_t value = ramp + noise();
+        if (cc14_update(&cc, (int16_t)value, true, gain)) {
+            sent++;
+            if (cc.sent == CC14_MAX) reached_top = true;
+            if (cc.sent == 0 && reached_top) reached_bottom = true;
+        }
+        int32_t clean = ramp < 0 ? 0 : ramp > CC14_MAX ? CC14_MAX : ramp;
+        if (i > SETTLE && abs32(cc.sent - clean) > max_error) max_error = abs32(cc.sent - clean);
+    }
+    CHECK(reached_top);
+    CHECK(reached_bottom);
+    CHECK(max_error <= cc14_deadband(&cc, gain) + 4 * SIGMA);
+
+    // Much finer than 128 steps, much coarser than every reading
+    CHECK(sent > 2 * 128);
+    CHECK(sent < CC14_MAX);
+
+    // A ramp doesn't read as noise
+    CHECK(cc.noise >> CC14_NOISE_FRAC_BITS <= SIGMA * 2);
+}
+
+static void test_jump(void) {
+    uint8_t gain = config_defaults.cc14_noise_gain;
+    cc14_t cc;
+    cc14_init(&cc);
+    for (int i = 0; i < SETTLE; i++) cc14_update(&cc, 4000 + noise(), true, gain);
+    int32_t floor = cc.noise;
+
+    // A jump goes out on the very reading
+    CHECK(cc14_update(&cc, 12000 + noise(), true, gain));
+    CHECK(abs32(cc.sent - 12000) <= 4 * SIGMA);
+    for (int i = 0; i < 10; i++) cc14_update(&cc, 12000 + noise(), true, gain);
+    CHECK(cc.noise < 2 * floor);
+
+    // Stale values repeated every loop pass don't move the floor
+    int32_t noise_before = cc.noise;
+    for (int i = 0; i < 1000; i++) cc14_update(&cc, (int16_t)((i & 1) ? 13000 : 11000), false, gain);
+    CHECK_EQ(cc.noise, noise_before);
+}
+
+static void test_ends(void) {
+    cc14_t cc;
+    cc14_init(&cc);
+
+    // The first value always goes out, the same one again never does
+    CHECK(cc14_update(&cc, 5, true, 16));
+    CHECK(!cc14_update(&cc, 5, true, 16));
+
+    // The ends go out even from inside the deadband, and out-of-range
+    // values are clamped to them
+    CHECK(cc14_update(&cc, 0, true, 16));
+    CHECK_EQ(cc.sent, 0);
+    CHECK(!cc14_update(&cc, -40, true, 16));
+    CHECK(cc14_update(&cc, CC14_MAX - 3, true, 16));
+    CHECK(cc14_update(&cc, 20000, true, 16));
+    CHECK_EQ(cc.sent, CC14_MAX);
+
+    // The deadband never drops below one step
+    cc14_init(&cc);
+    cc.noise = 0;
+    CHECK_EQ(cc14_deadband(&cc, 1), 1);
+}
+
+int main(void) {
+    test_resting();
+    test_swell();
+    test_jump();
+    test_ends();
+    return test_result();
+}
@@ -0,0 +1,151 @@
+// Power-loss test for the configuration store (config_store.h).
+//
+// The store runs on a simulated NOR flash in RAM: erasing sets bytes to
+// 0xFF, programming can only clear bits. The power can be cut after any
+// number of changed bytes, so an erase or a program stops part way and
+// config_store_write() gives up there. Every write of a run long enough to
+// wrap the ring twice is cut at every 16 bytes of its erase and program.
+// After each cut a fresh scan must find the last complete copy (or the new
+// one, if everything that mattered was already written), and a retried
+// write must then succeed.
+
+#include <string.h>
+#include "config_store.h"
+#include "test.h"
+
+#define NUM_WRITES (2 * CONFIG_STORE_NUM_SLOTS + 4)
+#define CUT_STEP 16
+
+static uint8_t flash[CONFIG_STORE_SIZE];
+static long budget = -1;    // Bytes the flash can still change, -1 = no limit
+static bool failing;        // Flash can't be claimed, nothing happens
+
+static bool use_byte(void) {
+    if (budget == 0) return false;
+    if (budget > 0) budget--;
+    return true;
+}
+
+static bool sim_erase(uint32_t offset) {
+    if (failing) return false;
+    for (uint32_t i = 0; i < CONFIG_STORE_SECTOR_SIZE; i++) {
+        if (!use_byte()) return false;
+        flash[offset + i] = 0xFF;
+    }
+    return true;
+}
+
+static bool sim_program(uint32_t offset, const uint8_t *data) {
+    if (failing) return false;
+    for (uint32_t i = 0; i < CONFIG_STORE_SLOT_SIZE; i++) {
+        if (!use_byte()) return false;
+        flash[offset + i] &= data[i];
+    }
+    return true;
+}
+
+static const config_store_flash_t sim_flash = {
+    .base = flash,
+    .erase_sector = sim_erase,
+    .program_page = sim_program
+};
+
+// Configuration of write number n, told apart by its first fret position
+static stradex_config_t payload(int n) {
+    stradex_config_t cfg = config_defaults;
+    cfg.fret_positions[0] = 1000 + n;
+    return cfg;
+}
+
+static int payload_number(const stradex_config_t *cfg) {
+    return cfg ? cfg->fret_positions[0] - 1000 : -1;
+}
+
+// Scan the flash like a boot would
+static int boot_scan(config_store_t *store) {
+    return payload_number(config_store_init(store, &sim_flash));
+}
+
+// Bytes write n changes when it runs to completion from the current image
+static long write_cost(int n) {
+    uint8_t saved[CONFIG_STORE_SIZE];
+    memcpy(saved, flash, sizeof(flash));
+
+    config_store_t store;
+    config_store_init(&store, &sim_flash);
+    budget = 1L << 30;
+    stradex_config_t cfg = payload(n);
+    config_store_write(&store, &cfg);
+    long cost = (1L << 30) - budget;
+    budget = -1;
+
+    memcpy(flash, saved, sizeof(flash));
+    return cost;
+}
+
+static void test_power_loss(void) {
+    uint8_t base[CONFIG_STORE_SIZE];
+    config_store_t store;
+    memset(flash, 0xFF, sizeof(flash));
+
+    for (int n = 0; n < NUM_WRITES; n++) {
+        memcpy(base, flash, sizeof(flash));
+        long cost = write_cost(n);
+
+        for (long cut = 0; cut < cost; cut += CUT_STEP) {
+            memcpy(flash, base, sizeof(flash));
+            config_store_init(&store, &sim_flash);
+            budget = cut;
+            stradex_config_t cfg = payload(n);
+            config_store_write(&store, &cfg);
+            budget = -1;
+
+            // Power back on: the previous copy, or the new one if only
+            // padding was left to program
+            int found = boot_scan(&store);
+            if (found != n - 1 && found != n) {
+                fprintf(stderr, "write %d cut after %ld of %ld bytes: found %d\n", n, cut, cost, found);
+            }
+            CHECK(found == n - 1 || found == n);
+
+            // The retry must land, whatever the cut left behind
+            const stradex_config_t *stored = config_store_write(&store, &cfg);
+            CHECK_EQ(payload_number(stored), n);
+            CHECK_EQ(boot_scan(&store), n);
+        }
+
+        // Carry on from an uninterrupted write
+        memcpy(flash, base, sizeof(flash));
+        config_store_init(&store, &sim_flash);
+        stradex_config_t cfg = payload(n);
+        CHECK_EQ(payload_number(config_store_write(&store, &cfg)), n);
+        CHECK_EQ(boot_scan(&store), n);
+    }
+}
+
+static void test_flash_failure(void) {
+    config_store_t store;
+    memset(flash, 0xFF, sizeof(flash));
+    config_store_init(&store, &sim_flash);
+
+    // Fill the first sector so the next write has to erase
+    for (int n = 0; n < CONFIG_STORE_SLOTS_PER_SECTOR; n++) {
+        stradex_config_t cfg = payload(n);
+        CHECK(config_store_write(&store, &cfg) != NULL);
+    }
+
+    failing = true;
+    stradex_config_t cfg = payload(100);
+    CHECK(config_store_write(&store, &cfg) == NULL);
+    failing = false;
+
+    CHECK_EQ(boot_scan(&store), CONFIG_STORE_SLOTS_PER_SECTOR - 1);
+    CHECK_EQ(payload_number(config_store_write(&store, &cfg)), 100);
+    CHECK_EQ(boot_scan(&store), 100);
+}
+
+int main(void) {
+    test_power_loss();
+    test_flash_failure();
+    return test_result();
+}
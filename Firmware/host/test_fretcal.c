@@ -0,0 +1,192 @@
+// Fret map calibration (fretcal.h) on synthetic and recorded sweeps.
+//
+// Synthetic sweeps come from a known response a + b x + c x^2: without
+// noise the fit has to give the coefficients back, with noise it has to
+// stay close and report an RMS error of the noise's size. The sweeps given
+// on the command line (host/sweeps) come from the instrument:
+// default_map.csv is read off its measured fret map (config.c). Their fit
+// has to reproduce the measured boundaries and play every touch on its own
+// fret.
+//
+// Every regenerated table must be strictly increasing with each boundary
+// between the frets either side of it. The fret quantiser's lookup table
+// is then rebuilt from it the way rebuild_fret_map() does, and has to agree
+// with a plain search, where the table built for the old map does not.
+//
+//   test_fretcal sweep.csv...
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fretcal.h"
+#include "quantizer.h"
+#include "config.h"
+#include "test.h"
+
+static uint32_t noise_state = 27;
+
+// Uniform noise in [-amplitude, amplitude]
+static int32_t noise(int32_t amplitude) {
+    noise_state = noise_state * 1103515245u + 12345u;
+    return (int32_t)((noise_state >> 8) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+static int load_sweep(fretcal_session_t *session, const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 0;
+    }
+
+    char line[128];
+    fretcal_reset(session);
+    while (fgets(line, sizeof(line), in)) {
+        float fret;
+        int value;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%f,%d", &fret, &value) != 2) continue;
+        if (!fretcal_add_sample(session, fret, value)) break;
+    }
+    fclose(in);
+    return session->num_samples > 0;
+}
+
+// Sweep frets first..last, samples_per_fret touches each, off the model
+static void synthetic_sweep(fretcal_session_t *session, const fretcal_fit_t *model, int first, int last,
+                            int samples_per_fret, int32_t amplitude) {
+    fretcal_reset(session);
+    for (int fret = first; fret <= last; fret++) {
+        for (int k = 0; k < samples_per_fret; k++) {
+            float value = fretcal_eval(model, fret) + noise(amplitude);
+            CHECK(fretcal_add_sample(session, fret, (int16_t)lrintf(value)));
+        }
+    }
+}
+
+// Regenerate the table from a fit, check it and the quantiser rebuilt
+// from it
+static void check_table(const fretcal_fit_t *fit, int16_t *positions) {
+    CHECK(fretcal_build_table(fit, positions));
+    for (int i = 0; i < FRETCAL_NUM_BOUNDARIES; i++) {
+        // Halfway between the frets, in fret units
+        CHECK_EQ(positions[i], lrintf(fretcal_eval(fit, i + 0.5f)));
+        if (i > 0) CHECK(positions[i] > positions[i - 1]);
+        CHECK(positions[i] > fretcal_eval(fit, i));
+        CHECK(positions[i] < fretcal_eval(fit, i + 1));
+    }
+
+    static quantizer_table_t table, stale;
+    quantizer_build_table(&table, positions, FRETCAL_NUM_BOUNDARIES);
+    quantizer_build_table(&stale, config_defaults.fret_positions, CONFIG_NUM_FRET_POSITIONS);
+
+    quantizer_t plain, fast, old;
+    quantizer_init(&plain, positions, FRETCAL_NUM_BOUNDARIES, 0, NULL);
+    quantizer_init(&fast, positions, FRETCAL_NUM_BOUNDARIES, 0, &table);
+    quantizer_init(&old, positions, FRETCAL_NUM_BOUNDARIES, 0, &stale);
+    int stale_differs = 0;
+    for (int32_t value = -32768; value <= 32767; value++) {
+        CHECK_EQ(quantizer_band(&fast, value), quantizer_band(&plain, value));
+        if (quantizer_band(&old, value) != quantizer_band(&plain, value)) stale_differs++;
+    }
+    bool same_map = memcmp(positions, config_defaults.fret_positions, sizeof(config_defaults.fret_positions)) == 0;
+    CHECK(same_map || stale_differs > 0);
+
+    // Every fret's fitted centre quantises to that fret
+    for (int fret = 0; fret <= FRETCAL_NUM_BOUNDARIES; fret++) {
+        CHECK_EQ(quantizer_band(&fast, (int16_t)lrintf(fretcal_eval(fit, fret))), fret);
+    }
+}
+
+static void check_synthetic(void) {
+    // A track that flattens towards the bridge: c negative, still rising
+    const fretcal_fit_t model = {.a = 12000, .b = 22000, .c = -8000};
+    fretcal_session_t session;
+    fretcal_fit_t fit;
+    int16_t positions[FRETCAL_NUM_BOUNDARIES];
+
+    synthetic_sweep(&session, &model, 0, 16, 1, 0);
+    CHECK(fretcal_solve(&session, &fit));
+    CHECK(fabsf(fit.a - model.a) < 2);
+    CHECK(fabsf(fit.b - model.b) < 5);
+    CHECK(fabsf(fit.c - model.c) < 5);
+    CHECK(fit.rms_error < 1);
+    check_table(&fit, positions);
+
+    // Three touches per fret with +-100 of noise (an RMS of 58)
+    synthetic_sweep(&session, &model, 1, 16, 3, 100);
+    CHECK(fretcal_solve(&session, &fit));
+    CHECK(fabsf(fit.a - model.a) < 100);
+    CHECK(fabsf(fit.b - model.b) < 500);
+    CHECK(fabsf(fit.c - model.c) < 500);
+    CHECK(fit.rms_error > 40 && fit.rms_error < 70);
+    check_table(&fit, positions);
+    for (int i = 0; i < FRETCAL_NUM_BOUNDARIES; i++) {
+        CHECK(fabsf(positions[i] - fretcal_eval(&model, i + 0.5f)) < 60);
+    }
+
+    // Two reference frets fit a straight track
+    fretcal_reset(&session);
+    fretcal_add_sample(&session, 3, (int16_t)lrintf(fretcal_eval(&model, 3)));
+    fretcal_add_sample(&session, 12, (int16_t)lrintf(fretcal_eval(&model, 12)));
+    CHECK(fretcal_solve(&session, &fit));
+    CHECK_EQ(fit.c, 0);
+    CHECK(fabsf(fretcal_eval(&fit, 3) - fretcal_eval(&model, 3)) < 1);
+    CHECK(fabsf(fretcal_eval(&fit, 12) - fretcal_eval(&model, 12)) < 1);
+
+    // One fret can't be fitted, and a falling response isn't a fret map
+    fretcal_reset(&session);
+    fretcal_add_sample(&session, 5, 16000);
+    fretcal_add_sample(&session, 5, 16100);
+    CHECK(!fretcal_solve(&session, &fit));
+    const fretcal_fit_t falling = {.a = 26000, .b = -14000, .c = 0};
+    synthetic_sweep(&session, &falling, 1, 12, 1, 0);
+    CHECK(!fretcal_solve(&session, &fit));
+
+    // A fit past full scale, or one that turns over before the last fret,
+    // leaves the old table alone
+    const fretcal_fit_t clipped = {.a = 20000, .b = 30000, .c = 0};
+    const fretcal_fit_t peaked = {.a = 12000, .b = 30000, .c = -40000};
+    memcpy(positions, config_defaults.fret_positions, sizeof(positions));
+    CHECK(!fretcal_build_table(&clipped, positions));
+    CHECK(!fretcal_build_table(&peaked, positions));
+    CHECK(memcmp(positions, config_defaults.fret_positions, sizeof(positions)) == 0);
+}
+
+static void check_recorded(const char *path) {
+    fretcal_session_t session;
+    fretcal_fit_t fit;
+    int16_t positions[FRETCAL_NUM_BOUNDARIES];
+
+    if (!load_sweep(&session, path)) {
+        test_failures++;
+        return;
+    }
+    CHECK(fretcal_solve(&session, &fit));
+    check_table(&fit, positions);
+
+    // The measured map is close to the model, and bends the way its frets
+    // spread out more evenly than 12-TET towards the bridge. The end
+    // boundaries are extrapolated past the first and last fret swept.
+    CHECK(fit.rms_error < 150);
+    CHECK(fit.c > 0);
+    for (int i = 0; i < FRETCAL_NUM_BOUNDARIES; i++) {
+        int tolerance = i == 0 || i == FRETCAL_NUM_BOUNDARIES - 1 ? 400 : 200;
+        CHECK(abs(positions[i] - config_defaults.fret_positions[i]) < tolerance);
+    }
+
+    // Every touch in the sweep plays its own fret on the new map
+    quantizer_t q;
+    quantizer_init(&q, positions, FRETCAL_NUM_BOUNDARIES, 0, NULL);
+    for (int i = 0; i < session.num_samples; i++) {
+        CHECK_EQ(quantizer_band(&q, session.samples[i].value), lrintf(session.samples[i].fret));
+    }
+}
+
+int main(int argc, char **argv) {
+    check_synthetic();
+    CHECK(argc > 1);
+    for (int arg = 1; arg < argc; arg++) {
+        check_recorded(argv[arg]);
+    }
+    return test_result();
+}
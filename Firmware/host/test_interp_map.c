@@ -0,0 +1,60 @@
+// Table lookup and clamped scaling (interp_map.h) against the straight-line
+// references in interp_map_check.h.
+//
+// The references are first pinned down on hand-worked values, including
+// rounding of negative steps and truncation of negative scales, so a
+// mistake shared by both sides can't hide. Then the full comparison the
+// bench firmware runs on the device must find no differences.
+
+#include "interp_map.h"
+#include "interp_map_check.h"
+#include "test.h"
+
+static void test_reference_lerp(void) {
+    const int16_t table[] = {0, 256, -256, -257};
+
+    // Entries, halfway points, and the last entry past the end
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 0), 0);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 128), 128);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 256), 256);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 384), 0);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 768), -257);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 100000), -257);
+
+    // A falling step of one rounds down as soon as alpha is non-zero
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 512), -256);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 8, 513), -257);
+
+    // Alpha is the top eight bits of the fraction
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 12, 4096 + 2047), 256 - 2 * 127);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 12, 4096 + 15), 256);
+    CHECK_EQ(interp_map_lerp_ref(table, 4, 12, 4096 + 16), 254);
+}
+
+static void test_reference_scale(void) {
+    // 0-100 onto 127-0, clamped
+    CHECK_EQ(interp_map_scale_ref(0, 100, 0, 127, -127, 100, -5), 127);
+    CHECK_EQ(interp_map_scale_ref(0, 100, 0, 127, -127, 100, 50), 127 - 63);
+    CHECK_EQ(interp_map_scale_ref(0, 100, 0, 127, -127, 100, 1), 126);
+    CHECK_EQ(interp_map_scale_ref(0, 100, 0, 127, -127, 100, 200), 0);
+
+    // Truncation towards zero on both sides of the origin
+    CHECK_EQ(interp_map_scale_ref(-10, 10, 0, 0, 1, 3, -5), -1);
+    CHECK_EQ(interp_map_scale_ref(-10, 10, 0, 0, 1, 3, 5), 1);
+    CHECK_EQ(interp_map_scale_ref(-10, 10, 0, 0, -1, 3, 5), -1);
+
+    // The largest product the scale allows
+    CHECK_EQ(interp_map_scale_ref(-32767, 32767, -32767, 0, 32767, 1, 32767), 65534 * 32767);
+}
+
+static void test_against_reference(void) {
+    interp_map_init();
+    CHECK_EQ(interp_map_check(), 0);
+}
+
+int main(void) {
+    test_reference_lerp();
+    test_reference_scale();
+    test_against_reference();
+    return test_result();
+}
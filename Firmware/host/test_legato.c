@@ -0,0 +1,155 @@
+// Legato note transitions (legato.h) on a recorded fast passage.
+//
+// The trace runs up and down the G string a sample per fret, jumps further
+// than the bend range, crosses to the D string mid-slide and lets go. Each
+// legato mode replays it the way the main loop does, and the messages are
+// checked for order (a legato note on always precedes the note off it
+// replaces, never more than two notes sound), for count, and in the bend
+// mode for the pitch they add up to.
+
+#include "legato.h"
+#include "config.h"
+#include "pitchmap.h"
+#include "test.h"
+
+#define MAX_EVENTS 128
+#define VELOCITY 100
+#define SEMITONE (PITCHMAP_BEND_CENTER / PITCHMAP_DEFAULT_BEND_RANGE)
+
+typedef struct sample {
+    int16_t string;     // -1 = every key released
+    int16_t fret;
+    int16_t bend;       // Fretted-mode bend, ±2 semitones
+} sample_t;
+
+static const sample_t passage[] = {
+    {0, 2, 8192}, {0, 3, 8192}, {0, 5, 8192 + 1024}, {0, 7, 8192}, {0, 8, 8192 - 512},
+    {0, 7, 8192}, {0, 5, 8192}, {0, 3, 8192}, {0, 2, 8192},
+    {0, 15, 8192},                                      // 13 semitones: out of range
+    {0, 12, 8192}, {0, 10, 8192},
+    {1, 10, 8192}, {1, 12, 8192 + 4096}, {1, 10, 8192},  // Other string, mid-slide
+    {-1, 0, 8192}
+};
+#define PASSAGE_LENGTH (int)(sizeof(passage) / sizeof(passage[0]))
+
+static legato_event_t events[MAX_EVENTS];
+static int num_events;
+static int32_t pitches[PASSAGE_LENGTH]; // Sounding pitch per sample, 1/PITCHMAP_ONE semitones
+
+static void replay(int16_t mode) {
+    legato_bend_t state;
+    int16_t previous_note = -1;
+    int16_t velocity = 0;
+    int16_t range = config_defaults.glide_bend_range;
+
+    legato_bend_reset(&state);
+    num_events = 0;
+    for (int i = 0; i < PASSAGE_LENGTH; i++) {
+        const sample_t *s = &passage[i];
+        int16_t note = -1;
+        int16_t bend = s->bend;
+        int32_t bend_range = PITCHMAP_DEFAULT_BEND_RANGE;
+        if (s->string == -1) {
+            legato_bend_reset(&state);
+        } else if (mode == LEGATO_BEND) {
+            note = config_defaults.base_notes[s->string]
+                   + legato_bend_update(&state, s->string, s->fret, &bend, range);
+            bend_range = range;
+        } else {
+            note = config_defaults.base_notes[s->string] + s->fret;
+        }
+        pitches[i] = note * PITCHMAP_ONE
+                     + (int32_t)(bend - PITCHMAP_BEND_CENTER) * bend_range * PITCHMAP_ONE / PITCHMAP_BEND_CENTER;
+
+        legato_event_t out[LEGATO_MAX_EVENTS];
+        uint8_t count = legato_note_change(mode, 0, VELOCITY, previous_note, note, &velocity, out);
+        for (int k = 0; k < count && num_events < MAX_EVENTS; k++) events[num_events++] = out[k];
+        previous_note = note;
+    }
+}
+
+// Every note on is matched, at most two sound at once, and only for the
+// length of a legato pair
+static void check_order(bool overlap) {
+    int16_t sounding[2];
+    int num_sounding = 0;
+    for (int i = 0; i < num_events; i++) {
+        const legato_event_t *e = &events[i];
+        if (e->type == LEGATO_NOTE_ON) {
+            CHECK(num_sounding < 2);
+            if (num_sounding < 2) sounding[num_sounding++] = e->note;
+            CHECK_EQ(e->velocity, VELOCITY);
+            // An overlapping note on is followed by the old note's note off
+            if (num_sounding == 2) {
+                CHECK(overlap);
+                CHECK(i + 1 < num_events && events[i + 1].type == LEGATO_NOTE_OFF
+                      && events[i + 1].note == sounding[0]);
+            }
+        } else {
+            bool found = false;
+            for (int k = 0; k < num_sounding; k++) {
+                if (sounding[k] == e->note) {
+                    sounding[k] = sounding[--num_sounding];
+                    found = true;
+                    break;
+                }
+            }
+            CHECK(found);
+        }
+    }
+    CHECK_EQ(num_sounding, 0);
+}
+
+static int count_type(uint8_t type) {
+    int count = 0;
+    for (int i = 0; i < num_events; i++) count += events[i].type == type;
+    return count;
+}
+
+static void test_off_and_overlap(void) {
+    // Every sample changes note: one note on and one note off each
+    replay(LEGATO_OFF);
+    check_order(false);
+    CHECK_EQ(count_type(LEGATO_NOTE_ON), PASSAGE_LENGTH - 1);
+    CHECK_EQ(count_type(LEGATO_NOTE_OFF), PASSAGE_LENGTH - 1);
+    CHECK_EQ(events[1].type, LEGATO_NOTE_OFF);
+    CHECK_EQ(events[2].type, LEGATO_NOTE_ON);
+
+    replay(LEGATO_OVERLAP);
+    check_order(true);
+    CHECK_EQ(count_type(LEGATO_NOTE_ON), PASSAGE_LENGTH - 1);
+    CHECK_EQ(count_type(LEGATO_NOTE_OFF), PASSAGE_LENGTH - 1);
+    CHECK_EQ(events[1].type, LEGATO_NOTE_ON);
+    CHECK_EQ(events[2].type, LEGATO_NOTE_OFF);
+}
+
+static void test_bend(void) {
+    replay(LEGATO_BEND);
+    check_order(true);
+
+    // New notes only for the first fret, the jump out of range and the
+    // other string
+    CHECK_EQ(count_type(LEGATO_NOTE_ON), 3);
+    CHECK_EQ(count_type(LEGATO_NOTE_OFF), 3);
+    CHECK_EQ(events[0].note, config_defaults.base_notes[0] + 2);
+    CHECK_EQ(events[1].note, config_defaults.base_notes[0] + 15);
+    CHECK_EQ(events[3].note, config_defaults.base_notes[1] + 10);
+
+    // Note plus bend is the pitch fretted mode plays, to within rounding
+    for (int i = 0; i < PASSAGE_LENGTH - 1; i++) {
+        const sample_t *s = &passage[i];
+        int32_t expected = (config_defaults.base_notes[s->string] + s->fret) * PITCHMAP_ONE
+                           + (int32_t)(s->bend - PITCHMAP_BEND_CENTER) * PITCHMAP_ONE / SEMITONE;
+        int32_t error = pitches[i] - expected;
+        if (error < -8 || error > 8) {
+            fprintf(stderr, "sample %d: pitch %d, expected %d\n", i, (int)pitches[i], (int)expected);
+        }
+        CHECK(error >= -8 && error <= 8);
+    }
+}
+
+int main(void) {
+    test_off_and_overlap();
+    test_bend();
+    return test_result();
+}
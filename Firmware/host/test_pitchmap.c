@@ -0,0 +1,59 @@
+// Fractional pitch through the fret map (pitchmap.h): sweeps every softpot
+// reading over the default map and a few others, and checks the pitch is
+// monotonic and continuous (never steps further than the steepest band
+// allows), that fret centres land on whole semitones and boundaries half
+// way between them.
+
+#include "pitchmap.h"
+#include "config.h"
+#include "test.h"
+
+static void check_map(const int16_t *positions, int num_positions) {
+    // Steepest band: the ramp from the open string's centre, or a fret
+    int32_t narrowest = positions[0] - positions[0] / 2;
+    for (int i = 1; i < num_positions; i++) {
+        int32_t width = positions[i] - positions[i - 1];
+        if (width < narrowest) narrowest = width;
+    }
+    int32_t max_step = PITCHMAP_ONE / narrowest + 1;
+
+    int32_t previous = pitchmap_fractional_fret(positions, num_positions, 0);
+    CHECK_EQ(previous, 0);
+    int32_t end = positions[num_positions - 1] + 1000;
+    for (int32_t value = 1; value <= end; value++) {
+        int32_t pitch = pitchmap_fractional_fret(positions, num_positions, (int16_t)value);
+        if (pitch < previous || pitch - previous > max_step) {
+            fprintf(stderr, "reading %d: pitch %d after %d\n", (int)value, (int)pitch, (int)previous);
+        }
+        CHECK(pitch >= previous);
+        CHECK(pitch - previous <= max_step);
+        previous = pitch;
+    }
+    CHECK_EQ(previous, (num_positions - 1) * PITCHMAP_ONE + PITCHMAP_ONE / 2);
+
+    for (int i = 0; i < num_positions; i++) {
+        CHECK_EQ(pitchmap_fractional_fret(positions, num_positions, positions[i]),
+                 i * PITCHMAP_ONE + PITCHMAP_ONE / 2);
+    }
+    // Centres are rounded down to a whole reading
+    for (int fret = 0; fret < num_positions; fret++) {
+        int32_t center = pitchmap_fret_center(positions, num_positions, fret);
+        int32_t pitch = pitchmap_fractional_fret(positions, num_positions, (int16_t)center);
+        CHECK(pitch >= fret * PITCHMAP_ONE - max_step);
+        CHECK(pitch <= fret * PITCHMAP_ONE);
+    }
+}
+
+int main(void) {
+    check_map(config_defaults.fret_positions, CONFIG_NUM_FRET_POSITIONS);
+
+    // A first fret far from the nut, a narrow one, and the smallest map
+    const int16_t wide_open[] = {12000, 13000, 14000, 15000};
+    check_map(wide_open, 4);
+    const int16_t narrow_open[] = {40, 3000, 6000};
+    check_map(narrow_open, 3);
+    const int16_t two[] = {1, 2};
+    check_map(two, 2);
+
+    return test_result();
+}
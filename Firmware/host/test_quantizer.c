@@ -0,0 +1,133 @@
+// Quantiser with hysteresis (quantizer.h) under noise at every boundary.
+//
+// Two edge sets are used: the default fret map with the fret hysteresis,
+// and the 127 modulation CC steps with the pot hysteresis, each with and
+// without the lookup table. At every edge the input settles on either
+// side, then noise narrower than the hysteresis is injected around the
+// edge: the band must not change at all. Wider noise may switch bands, but
+// only between the two bands either side of the edge. A ramp over the whole
+// input range must reach the top and bottom bands.
+
+#include "quantizer.h"
+#include "config.h"
+#include "test.h"
+
+#define NOISE_SAMPLES 2000
+
+static uint32_t noise_state = 3;
+
+// Uniform noise in [-amplitude, amplitude]
+static int32_t noise(int32_t amplitude) {
+    noise_state = noise_state * 1103515245u + 12345u;
+    return (int32_t)((noise_state >> 8) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+static int16_t clamp16(int32_t value) {
+    return value < -32768 ? -32768 : value > 32767 ? 32767 : value;
+}
+
+// Bands seen while injecting noise around edge e after settling at start
+static int inject(quantizer_t *q, int e, int32_t start, int32_t amplitude, int16_t *low, int16_t *high) {
+    int changes = 0;
+    int16_t band = quantizer_update(q, clamp16(start));
+    *low = *high = band;
+    for (int i = 0; i < NOISE_SAMPLES; i++) {
+        int16_t next = quantizer_update(q, clamp16(q->edges[e] + noise(amplitude)));
+        if (next != band) changes++;
+        band = next;
+        if (band < *low) *low = band;
+        if (band > *high) *high = band;
+    }
+    return changes;
+}
+
+static void check_edges(const int16_t *edges, uint8_t num_edges, int16_t hysteresis,
+                        const quantizer_table_t *table) {
+    quantizer_t q;
+    int16_t low, high;
+
+    for (int e = 0; e < num_edges; e++) {
+        // Room to settle on either side without reaching the next edges
+        int32_t below = e > 0 ? (edges[e - 1] + edges[e]) / 2 : edges[e] - 2 * hysteresis;
+        int32_t above = e + 1 < num_edges ? (edges[e] + edges[e + 1]) / 2 : edges[e] + 2 * hysteresis;
+
+        // (Except where the widened band would run past full scale)
+        if (edges[e] + hysteresis <= 32767) {
+            quantizer_init(&q, edges, num_edges, hysteresis, table);
+            CHECK_EQ(inject(&q, e, below, hysteresis - 1, &low, &high), 0);
+            CHECK_EQ(low, e);
+        }
+        if (edges[e] - hysteresis > -32768) {
+            quantizer_init(&q, edges, num_edges, hysteresis, table);
+            CHECK_EQ(inject(&q, e, above, hysteresis - 1, &low, &high), 0);
+            CHECK_EQ(low, e + 1);
+        }
+
+        // Noise reaching past the hysteresis moves between the two bands
+        // only, and only where the bands are wider than the noise
+        int32_t gap_below = e > 0 ? edges[e] - edges[e - 1] : INT32_MAX;
+        int32_t gap_above = e + 1 < num_edges ? edges[e + 1] - edges[e] : INT32_MAX;
+        int32_t wide = 2 * hysteresis;
+        if (gap_below > wide && gap_above > wide) {
+            quantizer_init(&q, edges, num_edges, hysteresis, table);
+            CHECK(inject(&q, e, below, wide, &low, &high) > 0);
+            CHECK_EQ(low, e);
+            CHECK_EQ(high, e + 1);
+        }
+    }
+
+    // A slow ramp switches once per edge, past the hysteresis each way, and
+    // reaches both end bands even with an edge at full scale
+    quantizer_init(&q, edges, num_edges, hysteresis, table);
+    int16_t band = quantizer_update(&q, -32768);
+    for (int32_t value = -32768; value <= 32767; value++) {
+        int16_t next = quantizer_update(&q, value);
+        if (next != band) {
+            int32_t up = edges[band] + hysteresis;
+            CHECK_EQ(next, band + 1);
+            CHECK_EQ(value, up < 32767 ? up : 32767);
+        }
+        band = next;
+    }
+    CHECK_EQ(band, num_edges);
+    for (int32_t value = 32767; value >= -32768; value--) {
+        int16_t next = quantizer_update(&q, value);
+        if (next != band) {
+            int32_t down = edges[band - 1] - hysteresis;
+            CHECK_EQ(next, band - 1);
+            CHECK_EQ(value, (down > -32767 ? down : -32767) - 1);
+        }
+        band = next;
+    }
+    CHECK_EQ(band, 0);
+}
+
+// The table lookup gives the same band as the search for every value
+static void check_table(const int16_t *edges, uint8_t num_edges, const quantizer_table_t *table) {
+    quantizer_t plain, fast;
+    quantizer_init(&plain, edges, num_edges, 0, NULL);
+    quantizer_init(&fast, edges, num_edges, 0, table);
+    for (int32_t value = -32768; value <= 32767; value++) {
+        CHECK_EQ(quantizer_band(&fast, value), quantizer_band(&plain, value));
+    }
+}
+
+int main(void) {
+    static quantizer_table_t fret_table, modulation_table;
+    const int16_t *frets = config_defaults.fret_positions;
+    quantizer_build_table(&fret_table, frets, CONFIG_NUM_FRET_POSITIONS);
+
+    // Modulation CC steps as in main.c
+    int16_t modulation_edges[127];
+    for (int k = 1; k <= 127; k++) modulation_edges[k - 1] = (k * 32767 + 126) / 127;
+    quantizer_build_table(&modulation_table, modulation_edges, 127);
+
+    check_table(frets, CONFIG_NUM_FRET_POSITIONS, &fret_table);
+    check_table(modulation_edges, 127, &modulation_table);
+
+    check_edges(frets, CONFIG_NUM_FRET_POSITIONS, config_defaults.fret_hysteresis, NULL);
+    check_edges(frets, CONFIG_NUM_FRET_POSITIONS, config_defaults.fret_hysteresis, &fret_table);
+    check_edges(modulation_edges, 127, config_defaults.pot_hysteresis, NULL);
+    check_edges(modulation_edges, 127, config_defaults.pot_hysteresis, &modulation_table);
+    return test_result();
+}
@@ -0,0 +1,158 @@
+// Sensor map validation and scan schedule (sensor_map.h).
+//
+// Several layouts, from one chip to four chips with sixteen entries, are
+// scanned with the chips converting at different, jittery rates the way
+// they run concurrently on the bus. Each chip must go through its own
+// entries in map order, and every full pass the schedule reports must come
+// after each active chip has finished a round of all its entries since the
+// previous one. Broken maps must be refused and leave an empty schedule.
+
+#include "sensor_map.h"
+#include "registers.h"
+#include "test.h"
+
+#define MUX(n) (ADS1115_MUX_SINGLE_0 + ((n) << 12))
+#define PGA ADS1115_PGA_4_096
+#define RATE ADS1115_RATE_860_SPS
+#define NUM_READINGS 20000
+
+#define ENTRY(address, mux, role, index) {address, mux, PGA, RATE, role, index, SENSOR_FILTER_NONE}
+
+static uint32_t random_state = 5;
+
+static uint32_t random_below(uint32_t n) {
+    random_state = random_state * 1103515245u + 12345u;
+    return (random_state >> 16) % n;
+}
+
+// Scan a layout and check every reported pass covered the whole map
+static void check_coverage(const sensor_channel_t *map, uint8_t num_channels, uint8_t inactive_device) {
+    sensor_schedule_t schedule;
+    CHECK(sensor_schedule_init(&schedule, map, num_channels));
+    if (inactive_device < schedule.num_devices) {
+        sensor_schedule_set_active(&schedule, inactive_device, false);
+    }
+
+    bool wrapped[SENSOR_MAP_MAX_DEVICES] = {false};
+    uint8_t expected_next[SENSOR_MAP_MAX_DEVICES] = {0};
+    int passes = 0;
+    for (int n = 0; n < NUM_READINGS; n++) {
+        // Chips finish conversions in no fixed order; the inactive one never does
+        uint8_t device = random_below(schedule.num_devices);
+        CHECK_EQ(sensor_schedule_channel_active(&schedule, schedule.device_channels[device][0]),
+                 device != inactive_device);
+        if (device == inactive_device) continue;
+
+        uint8_t channel = sensor_schedule_current(&schedule, device);
+        CHECK_EQ(schedule.channel_device[channel], device);
+        CHECK_EQ(map[channel].address, schedule.addresses[device]);
+        CHECK_EQ(channel, schedule.device_channels[device][expected_next[device]]);
+        expected_next[device] = (expected_next[device] + 1) % schedule.device_num_channels[device];
+        if (expected_next[device] == 0) wrapped[device] = true;
+
+        if (sensor_schedule_advance(&schedule, device)) {
+            passes++;
+            for (int d = 0; d < schedule.num_devices; d++) {
+                CHECK(d == inactive_device || wrapped[d]);
+                wrapped[d] = false;
+            }
+        }
+    }
+    CHECK(passes > NUM_READINGS / (4 * num_channels));
+
+    // Every entry is scheduled exactly once, and every role instance found
+    int scheduled = 0;
+    for (int d = 0; d < schedule.num_devices; d++) scheduled += schedule.device_num_channels[d];
+    CHECK_EQ(scheduled, num_channels);
+    for (int c = 0; c < num_channels; c++) {
+        if (map[c].role != SENSOR_ROLE_NONE) {
+            CHECK_EQ(sensor_schedule_find(&schedule, map[c].role, map[c].index), c);
+        }
+    }
+}
+
+static void test_layouts(void) {
+    // The instrument's map
+    const sensor_channel_t stradex[] = {
+        ENTRY(0x48, MUX(0), SENSOR_ROLE_FSR, 0), ENTRY(0x48, MUX(1), SENSOR_ROLE_FSR, 1),
+        ENTRY(0x48, MUX(2), SENSOR_ROLE_FSR, 2), ENTRY(0x48, MUX(3), SENSOR_ROLE_FSR, 3),
+        ENTRY(0x49, MUX(0), SENSOR_ROLE_SOFTPOT, 0), ENTRY(0x49, MUX(1), SENSOR_ROLE_MODULATION, 0),
+        ENTRY(0x49, MUX(2), SENSOR_ROLE_NONE, 0), ENTRY(0x49, MUX(3), SENSOR_ROLE_TUNING, 0)
+    };
+    check_coverage(stradex, 8, 0xFF);
+    check_coverage(stradex, 8, 1);
+
+    // One chip, one entry
+    const sensor_channel_t single[] = {ENTRY(0x4B, MUX(2), SENSOR_ROLE_SOFTPOT, 0)};
+    check_coverage(single, 1, 0xFF);
+
+    // Uneven chips, entries interleaved in the map, a second softpot and a pedal
+    const sensor_channel_t uneven[] = {
+        ENTRY(0x4A, MUX(0), SENSOR_ROLE_SOFTPOT, 0), ENTRY(0x48, MUX(0), SENSOR_ROLE_FSR, 0),
+        ENTRY(0x4A, MUX(1), SENSOR_ROLE_SOFTPOT, 1), ENTRY(0x4A, MUX(2), SENSOR_ROLE_EXPRESSION, 0),
+        ENTRY(0x4A, ADS1115_MUX_DIFF_0_1, SENSOR_ROLE_NONE, 0), ENTRY(0x4A, MUX(3), SENSOR_ROLE_FX, 0)
+    };
+    check_coverage(uneven, 6, 0xFF);
+    check_coverage(uneven, 6, 0);
+
+    // Four full chips
+    sensor_channel_t full[SENSOR_MAP_MAX_CHANNELS];
+    for (int c = 0; c < SENSOR_MAP_MAX_CHANNELS; c++) {
+        full[c] = (sensor_channel_t)ENTRY(0x48 + c % 4, MUX(c / 4), SENSOR_ROLE_NONE, 0);
+    }
+    check_coverage(full, SENSOR_MAP_MAX_CHANNELS, 0xFF);
+    check_coverage(full, SENSOR_MAP_MAX_CHANNELS, 3);
+}
+
+static void check_refused(const sensor_channel_t *map, uint8_t num_channels) {
+    sensor_schedule_t schedule;
+    CHECK(!sensor_schedule_init(&schedule, map, num_channels));
+    CHECK_EQ(schedule.num_channels, 0);
+    CHECK_EQ(schedule.num_devices, 0);
+    CHECK_EQ(sensor_schedule_find(&schedule, SENSOR_ROLE_FSR, 0), -1);
+}
+
+static void test_validation(void) {
+    const sensor_channel_t bad_address[] = {
+        ENTRY(0x48, MUX(0), SENSOR_ROLE_FSR, 0), ENTRY(0x4C, MUX(0), SENSOR_ROLE_FSR, 1)
+    };
+    check_refused(bad_address, 2);
+
+    const sensor_channel_t duplicate_input[] = {
+        ENTRY(0x48, MUX(0), SENSOR_ROLE_FSR, 0), ENTRY(0x48, MUX(0), SENSOR_ROLE_FSR, 1)
+    };
+    check_refused(duplicate_input, 2);
+
+    const sensor_channel_t duplicate_role[] = {
+        ENTRY(0x48, MUX(0), SENSOR_ROLE_SOFTPOT, 0), ENTRY(0x49, MUX(0), SENSOR_ROLE_SOFTPOT, 0)
+    };
+    check_refused(duplicate_role, 2);
+
+    const sensor_channel_t bad_index[] = {ENTRY(0x48, MUX(0), SENSOR_ROLE_FSR, SENSOR_MAP_MAX_ROLE_INDEX)};
+    check_refused(bad_index, 1);
+
+    const sensor_channel_t bad_role[] = {ENTRY(0x48, MUX(0), SENSOR_ROLE_COUNT, 0)};
+    check_refused(bad_role, 1);
+
+    check_refused(bad_role, 0);
+
+    // Nine entries on one chip: eight distinct inputs plus one repeat can't
+    // fit, and neither can more than SENSOR_MAP_MAX_CHANNELS entries
+    sensor_channel_t crowded[SENSOR_MAP_MAX_DEVICE_CHANNELS + 1];
+    for (int c = 0; c <= SENSOR_MAP_MAX_DEVICE_CHANNELS; c++) {
+        crowded[c] = (sensor_channel_t)ENTRY(0x48, c << 12, SENSOR_ROLE_NONE, 0);
+    }
+    check_refused(crowded, SENSOR_MAP_MAX_DEVICE_CHANNELS + 1);
+
+    sensor_channel_t too_many[SENSOR_MAP_MAX_CHANNELS + 1];
+    for (int c = 0; c <= SENSOR_MAP_MAX_CHANNELS; c++) {
+        too_many[c] = (sensor_channel_t)ENTRY(0x48 + c % 4, (c / 4) << 12, SENSOR_ROLE_NONE, 0);
+    }
+    check_refused(too_many, SENSOR_MAP_MAX_CHANNELS + 1);
+}
+
+int main(void) {
+    test_layouts();
+    test_validation();
+    return test_result();
+}
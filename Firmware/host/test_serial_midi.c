@@ -0,0 +1,204 @@
+// Serial MIDI encoder (serial_midi.h): the exact bytes put on the link.
+//
+// Scripted writes, each followed by the byte stream it must produce:
+// running status across channel messages, real-time messages that keep it,
+// system common and SysEx messages that cancel it, and the status refresh.
+// Then the controller rate limit: held values that are replaced and go out
+// when their interval is over, MSBs that always precede their LSBs, values
+// held for another channel, and the controllers that are never held. Last,
+// a full queue and reading the queue across its wrap.
+
+#include <string.h>
+#include "serial_midi.h"
+#include "test.h"
+
+#define INTERVAL_US 10000
+
+static serial_midi_t serial;
+
+// Take everything queued so far and compare it with the expected bytes
+static void check_stream(int line, const uint8_t *expected, uint32_t expected_len) {
+    uint8_t actual[SERIAL_MIDI_QUEUE_SIZE];
+    uint32_t len = 0;
+    const uint8_t *data;
+    uint32_t count;
+    while ((count = serial_midi_peek(&serial, &data)) > 0) {
+        memcpy(&actual[len], data, count);
+        len += count;
+        serial_midi_consume(&serial, count);
+    }
+
+    if (len == expected_len && memcmp(actual, expected, len) == 0) return;
+    fprintf(stderr, "%s:%d: stream", __FILE__, line);
+    for (uint32_t i = 0; i < len; i++) fprintf(stderr, " %02X", actual[i]);
+    fprintf(stderr, ", expected");
+    for (uint32_t i = 0; i < expected_len; i++) fprintf(stderr, " %02X", expected[i]);
+    fprintf(stderr, "\n");
+    test_failures++;
+}
+
+#define EXPECT(...) do { \
+        static const uint8_t expected_[] = {__VA_ARGS__}; \
+        check_stream(__LINE__, expected_, sizeof(expected_)); \
+    } while (0)
+#define EXPECT_NOTHING() check_stream(__LINE__, NULL, 0)
+
+#define WRITE(now_us, ...) do { \
+        static const uint8_t bytes_[] = {__VA_ARGS__}; \
+        serial_midi_write(&serial, bytes_, sizeof(bytes_), now_us); \
+    } while (0)
+
+static void test_running_status(void) {
+    serial_midi_init(&serial, INTERVAL_US);
+
+    WRITE(0, 0x90, 0x3C, 0x64);
+    WRITE(10, 0x90, 0x3E, 0x64, 0x90, 0x3C, 0x00);
+    EXPECT(0x90, 0x3C, 0x64, 0x3E, 0x64, 0x3C, 0x00);
+
+    // Another channel or message type sends its status, real-time doesn't
+    // interrupt running status
+    WRITE(20, 0x91, 0x40, 0x50);
+    WRITE(30, 0xF8);
+    WRITE(40, 0x91, 0x40, 0x00);
+    WRITE(50, 0xE1, 0x00, 0x40);
+    WRITE(60, 0xC1, 0x05, 0xC1, 0x06);
+    EXPECT(0x91, 0x40, 0x50, 0xF8, 0x40, 0x00, 0xE1, 0x00, 0x40, 0xC1, 0x05, 0x06);
+
+    // System common and SysEx cancel it
+    WRITE(70, 0xF2, 0x10, 0x20);
+    WRITE(80, 0xC1, 0x07);
+    WRITE(90, 0xF0, 0x7D, 0x01, 0x02, 0xF7, 0xC1, 0x08);
+    EXPECT(0xF2, 0x10, 0x20, 0xC1, 0x07, 0xF0, 0x7D, 0x01, 0x02, 0xF7, 0xC1, 0x08);
+
+    // The status byte is repeated once a second for late listeners, counted
+    // from when it last went out
+    WRITE(SERIAL_MIDI_STATUS_REFRESH_US + 89, 0xC1, 0x09);
+    WRITE(SERIAL_MIDI_STATUS_REFRESH_US + 90, 0xC1, 0x0A);
+    WRITE(2 * SERIAL_MIDI_STATUS_REFRESH_US + 89, 0xC1, 0x0B);
+    WRITE(2 * SERIAL_MIDI_STATUS_REFRESH_US + 90, 0xC1, 0x0C);
+    EXPECT(0x09, 0xC1, 0x0A, 0x0B, 0xC1, 0x0C);
+
+    CHECK_EQ(serial.stats.messages, 17);
+    CHECK_EQ(serial.stats.status_saved, 6);
+    CHECK_EQ(serial.stats.bytes, 7 + 12 + 12 + 6);
+
+    // A truncated message is left out, along with anything after it
+    WRITE(3 * SERIAL_MIDI_STATUS_REFRESH_US, 0x92, 0x40, 0x50, 0x92, 0x41);
+    EXPECT(0x92, 0x40, 0x50);
+}
+
+static void test_rate_limit(void) {
+    serial_midi_init(&serial, INTERVAL_US);
+
+    // The first value goes out at once, then one per interval, always
+    // ending on the newest value
+    WRITE(1000, 0xB0, 0x07, 0x10);
+    WRITE(2000, 0xB0, 0x07, 0x11);
+    WRITE(3000, 0xB0, 0x07, 0x12);
+    serial_midi_poll(&serial, 1000 + INTERVAL_US - 1);
+    EXPECT(0xB0, 0x07, 0x10);
+    serial_midi_poll(&serial, 1000 + INTERVAL_US);
+    EXPECT(0x07, 0x12);
+    serial_midi_poll(&serial, 1000 + 3 * INTERVAL_US);
+    EXPECT_NOTHING();
+    CHECK_EQ(serial.stats.cc_held, 1);
+    CHECK_EQ(serial.stats.cc_replaced, 1);
+
+    // After a quiet interval the next value goes straight out
+    WRITE(1000 + 3 * INTERVAL_US, 0xB0, 0x07, 0x13);
+    EXPECT(0x07, 0x13);
+
+    // Controllers are limited independently
+    WRITE(100000, 0xB0, 0x0B, 0x40, 0xB0, 0x01, 0x20);
+    EXPECT(0x0B, 0x40, 0x01, 0x20);
+
+    // Data entry, RPN select and channel mode controllers are never held
+    WRITE(100001, 0xB0, 0x65, 0x00, 0xB0, 0x64, 0x00, 0xB0, 0x06, 0x02, 0xB0, 0x06, 0x03,
+          0xB0, 0x65, 0x00, 0xB0, 0x64, 0x01, 0xB0, 0x7B, 0x00, 0xB0, 0x7B, 0x00);
+    EXPECT(0x65, 0x00, 0x64, 0x00, 0x06, 0x02, 0x06, 0x03, 0x65, 0x00, 0x64, 0x01, 0x7B, 0x00, 0x7B, 0x00);
+
+    // Without an interval nothing is held
+    serial_midi_set_cc_interval(&serial, 0);
+    WRITE(100002, 0xB0, 0x0B, 0x41, 0xB0, 0x0B, 0x42);
+    EXPECT(0x0B, 0x41, 0x0B, 0x42);
+}
+
+static void test_msb_lsb(void) {
+    serial_midi_init(&serial, INTERVAL_US);
+    WRITE(0, 0xB0, 0x01, 0x10, 0xB0, 0x21, 0x05);
+    EXPECT(0xB0, 0x01, 0x10, 0x21, 0x05);
+
+    // The MSB is held, so its LSB is too, even though the LSB's own
+    // interval is over by the time the next pair comes
+    WRITE(5000, 0xB0, 0x01, 0x11);
+    WRITE(INTERVAL_US + 1, 0xB0, 0x21, 0x06);
+    EXPECT_NOTHING();
+    serial_midi_poll(&serial, INTERVAL_US + 2);
+    EXPECT(0x01, 0x11, 0x21, 0x06);
+
+    // A pair held together goes out MSB first
+    WRITE(INTERVAL_US + 3, 0xB0, 0x21, 0x07);
+    WRITE(INTERVAL_US + 4, 0xB0, 0x01, 0x12);
+    serial_midi_poll(&serial, 2 * INTERVAL_US + 2);
+    EXPECT(0x01, 0x12, 0x21, 0x07);
+
+    // An LSB whose interval is over still waits for its held MSB
+    serial_midi_init(&serial, INTERVAL_US);
+    WRITE(0, 0xB0, 0x21, 0x01);
+    WRITE(5000, 0xB0, 0x01, 0x02);
+    WRITE(6000, 0xB0, 0x01, 0x03);
+    WRITE(7000, 0xB0, 0x21, 0x04);
+    EXPECT(0xB0, 0x21, 0x01, 0x01, 0x02);
+    serial_midi_poll(&serial, INTERVAL_US);
+    EXPECT_NOTHING();
+    serial_midi_poll(&serial, 5000 + INTERVAL_US);
+    EXPECT(0x01, 0x03, 0x21, 0x04);
+}
+
+static void test_held_channel(void) {
+    serial_midi_init(&serial, INTERVAL_US);
+    WRITE(0, 0xB0, 0x07, 0x10);
+    WRITE(1000, 0xB0, 0x07, 0x11);
+
+    // The same controller on another channel flushes the held value first
+    WRITE(2000, 0xB1, 0x07, 0x20);
+    EXPECT(0xB0, 0x07, 0x10, 0x07, 0x11);
+    serial_midi_poll(&serial, 2000 + INTERVAL_US);
+    EXPECT(0xB1, 0x07, 0x20);
+}
+
+static void test_queue(void) {
+    serial_midi_init(&serial, 0);
+
+    // A message that doesn't fit is dropped whole; tune requests are one
+    // byte each and never use running status
+    for (int i = 0; i < SERIAL_MIDI_QUEUE_SIZE - 1; i++) {
+        WRITE(0, 0xF6);
+    }
+    WRITE(0, 0x90, 0x3C, 0x64);
+    CHECK_EQ(serial.stats.dropped_bytes, 3);
+    CHECK_EQ(serial.head - serial.tail, SERIAL_MIDI_QUEUE_SIZE - 1);
+    WRITE(0, 0xF6);
+    CHECK_EQ(serial.head - serial.tail, SERIAL_MIDI_QUEUE_SIZE);
+
+    // Peek stops at the end of the buffer, and the rest follows
+    const uint8_t *data;
+    CHECK_EQ(serial_midi_peek(&serial, &data), SERIAL_MIDI_QUEUE_SIZE);
+    serial_midi_consume(&serial, SERIAL_MIDI_QUEUE_SIZE - 2);
+    WRITE(0, 0x90, 0x3C, 0x64);
+    CHECK_EQ(serial_midi_peek(&serial, &data), 2);
+    CHECK_EQ(data[1], 0xF6);
+    serial_midi_consume(&serial, 2);
+    CHECK_EQ(serial_midi_peek(&serial, &data), 3);
+    CHECK(data == serial.queue);
+    EXPECT(0x90, 0x3C, 0x64);
+}
+
+int main(void) {
+    test_running_status();
+    test_rate_limit();
+    test_msb_lsb();
+    test_held_channel();
+    test_queue();
+    return test_result();
+}
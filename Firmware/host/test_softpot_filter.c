@@ -0,0 +1,172 @@
+// Softpot release filter (softpot_filter.h) on lift-off traces.
+//
+// Each trace in host/traces is replayed through the filter and the fret
+// quantiser with the default configuration, as in main.c. Traces use the
+// tune_params format with the intended pitch as the third column, -1 once
+// the finger is off. For every lift-off:
+//
+//   - the fret the finger was on is held until the release is reported,
+//   - the release comes within SOFTPOT_RELEASE_CONFIRM samples of the
+//     reading settling under the touch threshold, once, and goes straight
+//     to the open string,
+//   - no fret is played that the player wasn't on. A trace can allow a few
+//     with a "# spurious_max <n>" line, for floats the filter can't tell
+//     from a real move.
+//
+// The same traces replayed without the filter must leak more spurious frets,
+// and softpot_filter_fret() must count them, so the traces still exercise
+// the float and the device counter sees what the filter prevents.
+//
+//   test_softpot_filter trace...
+
+#include <math.h>
+#include <stdlib.h>
+#include "softpot_filter.h"
+#include "quantizer.h"
+#include "config.h"
+#include "test.h"
+
+#define MAX_SAMPLES 1024
+
+typedef struct {
+    const char *path;
+    int length;
+    int16_t softpot[MAX_SAMPLES];
+    int16_t fret[MAX_SAMPLES];      // Intended fret, -1 once the finger is off
+    int spurious_max;
+} trace_t;
+
+static quantizer_table_t fret_table;
+
+static int load_trace(trace_t *trace, const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 0;
+    }
+
+    char line[128];
+    trace->path = path;
+    trace->length = 0;
+    trace->spurious_max = 0;
+    while (fgets(line, sizeof(line), in) && trace->length < MAX_SAMPLES) {
+        unsigned time_us;
+        int softpot;
+        double pitch;
+        if (line[0] == '#') {
+            sscanf(line, "# spurious_max %d", &trace->spurious_max);
+            continue;
+        }
+        if (sscanf(line, "%u %d %lf", &time_us, &softpot, &pitch) != 3) continue;
+        trace->softpot[trace->length] = softpot;
+        trace->fret[trace->length] = pitch < 0 ? -1 : (int16_t)lround(pitch);
+        trace->length++;
+    }
+    fclose(in);
+    return trace->length > 0;
+}
+
+typedef struct {
+    int lift_offs;
+    int spurious;           // Frets played that the player wasn't on
+    uint32_t counted;       // Short frets counted by softpot_filter_fret()
+} replay_t;
+
+// Replay one trace, with the filter or on raw readings, checking the
+// lift-offs when filtered
+static replay_t replay(const trace_t *trace, int filtered) {
+    const int16_t threshold = config_defaults.softpot_touch_threshold;
+    softpot_filter_t filter = {0};
+    quantizer_t quantizer;
+    quantizer_init(&quantizer, config_defaults.fret_positions, CONFIG_NUM_FRET_POSITIONS,
+                   config_defaults.fret_hysteresis, &fret_table);
+
+    replay_t result = {0};
+    int16_t played = 0;
+    int16_t held = -1;          // Fret the finger was on when it lifted
+    int lift_start = -1;        // First sample of the float
+    int settled = -1;           // First sample of the final run under the threshold
+    int releases = 0;
+    bool touched = false;
+
+    for (int i = 0; i < trace->length; i++) {
+        int16_t raw = trace->softpot[i];
+        int16_t value = filtered ? softpot_filter_update(&filter, raw, threshold, config_defaults.softpot_max_slew)
+                                 : raw;
+        int16_t fret = quantizer_update(&quantizer, value);
+        softpot_filter_fret(&filter, fret);
+
+        int16_t intended = trace->fret[i] < 0 ? 0 : trace->fret[i];
+        if (fret != played && fret != intended) result.spurious++;
+
+        if (trace->fret[i] >= 0) {
+            // Finger down: a float later on starts from here
+            held = trace->fret[i];
+            lift_start = settled = -1;
+        } else if (held >= 0) {
+            if (lift_start < 0) {
+                lift_start = i;
+                releases = 0;
+                result.lift_offs++;
+            }
+            if (raw >= threshold) settled = -1;
+            else if (settled < 0) settled = i;
+
+            if (filtered) {
+                // Until the release, the last valid fret is still played
+                // (unless the trace allows leaks); after it, the open
+                // string for good
+                if (releases == 0 && value >= threshold && trace->spurious_max == 0) CHECK_EQ(fret, held);
+                if (releases > 0) CHECK(value < threshold);
+                if (touched && value < threshold) {
+                    releases++;
+                    CHECK_EQ(fret, 0);
+                    CHECK(settled >= 0 && i - settled < SOFTPOT_RELEASE_CONFIRM);
+                }
+            }
+        }
+        if (filtered && lift_start >= 0 && i == trace->length - 1) CHECK_EQ(releases, 1);
+
+        touched = value >= threshold;
+        played = fret;
+    }
+
+    result.counted = filter.spurious_changes;
+    if (filtered) CHECK_EQ(filter.releases, result.lift_offs);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    static trace_t trace;
+    int raw_spurious = 0;
+    uint32_t raw_counted = 0;
+    quantizer_build_table(&fret_table, config_defaults.fret_positions, CONFIG_NUM_FRET_POSITIONS);
+    CHECK(argc > 1);
+
+    for (int arg = 1; arg < argc; arg++) {
+        int failures = test_failures;
+        if (!load_trace(&trace, argv[arg])) {
+            test_failures++;
+            continue;
+        }
+
+        replay_t with = replay(&trace, 1);
+        CHECK(with.lift_offs > 0);
+        CHECK(with.spurious <= trace.spurious_max);
+        CHECK(with.counted <= (uint32_t)trace.spurious_max);
+
+        replay_t without = replay(&trace, 0);
+        CHECK(with.spurious == 0 || with.spurious < without.spurious);
+        raw_spurious += without.spurious;
+        raw_counted += without.counted;
+
+        if (test_failures != failures) fprintf(stderr, "%s: spurious %d filtered, %d raw (%u counted)\n",
+                                   trace.path, with.spurious, without.spurious, (unsigned)without.counted);
+    }
+
+    // Lifting off from fret 1 goes straight to the open string, but across
+    // the corpus the raw floats must leak, and be counted
+    CHECK(raw_spurious > 0);
+    CHECK(raw_counted > 0);
+    return test_result();
+}
@@ -0,0 +1,331 @@
+// SysEx live-parameter protocol (sysex.h) and the configuration double
+// buffer it writes into (config.h): message parsing, get/set/dump replies,
+// the swap at a frame boundary, consistency checks and the reply queue.
+
+#include <string.h>
+#include "sysex.h"
+#include "test.h"
+
+#define MAX_REPLIES 128
+
+static uint8_t replies[MAX_REPLIES][SYSEX_MAX_LENGTH + 8];
+static uint32_t reply_lengths[MAX_REPLIES];
+static int num_replies;
+
+static void capture_reply(const uint8_t *msg, uint32_t len) {
+    if (num_replies < MAX_REPLIES) {
+        memcpy(replies[num_replies], msg, len);
+        reply_lengths[num_replies] = len;
+    }
+    num_replies++;
+}
+
+static uint8_t fill_stats(uint32_t *counters, uint8_t max_counters) {
+    for (int i = 0; i < max_counters; i++) counters[i] = 0x12345678u + i;
+    return max_counters;
+}
+
+static sysex_hooks_t hooks = {
+    .reply = capture_reply,
+    .store = NULL,
+    .stats = fill_stats
+};
+
+// What the store hook was last asked to persist
+static stradex_config_t stored;
+
+static bool capture_store(const stradex_config_t *cfg) {
+    stored = *cfg;
+    return true;
+}
+
+// Run a whole message through the parser and handle it
+static bool feed(sysex_parser_t *parser, const uint8_t *msg, uint32_t len) {
+    bool complete = false;
+    for (uint32_t i = 0; i < len; i++) {
+        if (sysex_parse(parser, msg[i])) {
+            sysex_handle(parser, &hooks);
+            complete = true;
+        }
+    }
+    return complete;
+}
+
+static bool command(uint8_t cmd, const uint8_t *payload, uint32_t payload_len) {
+    sysex_parser_t parser = {0};
+    uint8_t msg[SYSEX_MAX_LENGTH];
+    num_replies = 0;
+    return feed(&parser, msg, sysex_build(cmd, payload, payload_len, msg));
+}
+
+// Set a parameter and return the ACK status
+static int set(const char *name, uint8_t index, int16_t value) {
+    const sysex_param_t *param = sysex_find_param_by_name(name);
+    uint8_t payload[4] = {param->id + index};
+    sysex_encode_value(value, &payload[1]);
+    command(SYSEX_CMD_SET, payload, sizeof(payload));
+    if (num_replies != 1 || replies[0][3] != SYSEX_REPLY_ACK) return -1;
+    return replies[0][5];
+}
+
+static void test_parser(void) {
+    sysex_parser_t parser = {0};
+    const uint8_t get[] = {0xF0, 0x7D, 0x53, SYSEX_CMD_GET, 0x00, 0xF7};
+
+    num_replies = 0;
+    CHECK(feed(&parser, get, sizeof(get)));
+    CHECK_EQ(num_replies, 1);
+
+    // Realtime bytes anywhere in the message are ignored
+    const uint8_t clocked[] = {0xF0, 0xF8, 0x7D, 0x53, 0xFE, SYSEX_CMD_GET, 0x00, 0xF8, 0xF7};
+    CHECK(feed(&parser, clocked, sizeof(clocked)));
+
+    // Another status byte aborts, and the F7 after it completes nothing
+    const uint8_t aborted[] = {0xF0, 0x7D, 0x53, 0x90, 0x01, 0x00, 0xF7};
+    CHECK(!feed(&parser, aborted, sizeof(aborted)));
+
+    // Other manufacturers and devices, and messages too short to hold a command
+    const uint8_t other[] = {0xF0, 0x7E, 0x53, SYSEX_CMD_GET, 0x00, 0xF7};
+    CHECK(!feed(&parser, other, sizeof(other)));
+    const uint8_t short_msg[] = {0xF0, 0x7D, 0x53, 0xF7};
+    CHECK(!feed(&parser, short_msg, sizeof(short_msg)));
+
+    // Overflow drops the message, and the next one parses again
+    CHECK(!sysex_parse(&parser, 0xF0));
+    for (int i = 0; i < SYSEX_MAX_LENGTH + 10; i++) CHECK(!sysex_parse(&parser, i == 0 ? 0x7D : 0x53));
+    CHECK(!sysex_parse(&parser, 0xF7));
+    CHECK(feed(&parser, get, sizeof(get)));
+
+    // Bytes outside a message are ignored
+    CHECK(!sysex_parse(&parser, 0x40));
+
+    // Values survive the three 7-bit bytes
+    for (int32_t v = -32768; v <= 32767; v++) {
+        uint8_t bytes[3];
+        sysex_encode_value((int16_t)v, bytes);
+        CHECK(!((bytes[0] | bytes[1] | bytes[2]) & 0x80));
+        if (sysex_decode_value(bytes) != v) {
+            CHECK_EQ(sysex_decode_value(bytes), v);
+            break;
+        }
+    }
+}
+
+static void test_get_set_swap(void) {
+    const stradex_config_t *before = config;
+    int16_t hysteresis = config->fret_hysteresis;
+
+    // A set lands in the shadow; the active block doesn't change until the
+    // swap, and the block it was is never written
+    CHECK_EQ(set("fret_hysteresis", 0, hysteresis + 10), SYSEX_STATUS_OK);
+    CHECK(config == before);
+    CHECK_EQ(config->fret_hysteresis, hysteresis);
+    CHECK(config_apply_pending());
+    CHECK(config != before);
+    CHECK_EQ(config->fret_hysteresis, hysteresis + 10);
+    CHECK_EQ(before->fret_hysteresis, hysteresis);
+    CHECK(!config_apply_pending());
+
+    // The next edit goes to the other buffer and starts from the active values
+    const stradex_config_t *first = config;
+    CHECK_EQ(set("fret_positions", 15, config->fret_positions[15] + 1), SYSEX_STATUS_OK);
+    CHECK_EQ(set("pot_hysteresis", 0, 42), SYSEX_STATUS_OK);
+    CHECK_EQ(first->pot_hysteresis, config_defaults.pot_hysteresis);
+    CHECK(config_apply_pending());
+    CHECK(config != first);
+    CHECK_EQ(config->fret_hysteresis, hysteresis + 10);
+    CHECK_EQ(config->pot_hysteresis, 42);
+    CHECK_EQ(config->fret_positions[15], config_defaults.fret_positions[15] + 1);
+
+    // Get replies with the active value
+    const sysex_param_t *param = sysex_find_param_by_name("pot_hysteresis");
+    uint8_t id = param->id;
+    command(SYSEX_CMD_GET, &id, 1);
+    CHECK_EQ(num_replies, 1);
+    CHECK_EQ(replies[0][3], SYSEX_REPLY_VALUE);
+    CHECK_EQ(replies[0][4], id);
+    CHECK_EQ(sysex_decode_value(&replies[0][5]), 42);
+
+    // Unknown and out of range parameters
+    id = 0x7F;
+    command(SYSEX_CMD_GET, &id, 1);
+    CHECK_EQ(replies[0][5], SYSEX_STATUS_UNKNOWN_PARAM);
+    CHECK_EQ(set("legato_mode", 0, 3), SYSEX_STATUS_OUT_OF_RANGE);
+    CHECK(!config_apply_pending());
+
+    // Get and store see a set before the swap, so a store right after a set
+    // persists it
+    CHECK_EQ(set("pot_hysteresis", 0, 43), SYSEX_STATUS_OK);
+    CHECK_EQ(config->pot_hysteresis, 42);
+    id = param->id;
+    command(SYSEX_CMD_GET, &id, 1);
+    CHECK_EQ(sysex_decode_value(&replies[0][5]), 43);
+    hooks.store = capture_store;
+    command(SYSEX_CMD_STORE, NULL, 0);
+    hooks.store = NULL;
+    CHECK_EQ(replies[0][5], SYSEX_STATUS_OK);
+    CHECK_EQ(stored.pot_hysteresis, 43);
+    CHECK_EQ(stored.fret_hysteresis, hysteresis + 10);
+    CHECK(config_apply_pending());
+    CHECK_EQ(config->pot_hysteresis, 43);
+
+    // Defaults come back through the same swap
+    command(SYSEX_CMD_DEFAULTS, NULL, 0);
+    CHECK(config_apply_pending());
+    CHECK(memcmp(&config->fsr_min_value, &config_defaults.fsr_min_value,
+                 offsetof(stradex_config_t, crc) - offsetof(stradex_config_t, fsr_min_value)) == 0);
+}
+
+static void test_conflicts(void) {
+    // Each of these is in its own range but breaks the configuration
+    CHECK_EQ(set("fsr_min_value", 0, config->fsr_max_value), SYSEX_STATUS_CONFLICT);
+    CHECK_EQ(set("fsr_max_value", 0, config->fsr_min_value - 1), SYSEX_STATUS_CONFLICT);
+    CHECK_EQ(set("tuning_max_value", 0, 1), SYSEX_STATUS_CONFLICT);
+    CHECK_EQ(set("tuning_center_value", 0, config->tuning_max_value + 1), SYSEX_STATUS_CONFLICT);
+    CHECK_EQ(set("fret_positions", 3, config->fret_positions[2]), SYSEX_STATUS_CONFLICT);
+    CHECK_EQ(set("fret_positions", 0, config->fret_positions[1] + 5), SYSEX_STATUS_CONFLICT);
+
+    // None of them was published, nor left behind in the shadow
+    CHECK(!config_apply_pending());
+    CHECK_EQ(set("fret_hysteresis", 0, 80), SYSEX_STATUS_OK);
+    CHECK(config_apply_pending());
+    CHECK(config_check(config));
+    CHECK_EQ(config->fsr_min_value, config_defaults.fsr_min_value);
+    CHECK_EQ(config->tuning_max_value, config_defaults.tuning_max_value);
+    CHECK_EQ(config->fret_positions[3], config_defaults.fret_positions[3]);
+
+    // Moving a window past its other end works in the right order
+    CHECK_EQ(set("fsr_max_value", 0, 30000), SYSEX_STATUS_OK);
+    CHECK_EQ(set("fsr_min_value", 0, 25000), SYSEX_STATUS_OK);
+    CHECK(config_apply_pending());
+    CHECK_EQ(config->fsr_min_value, 25000);
+    CHECK(config_check(&config_defaults));
+}
+
+static void test_dump_and_stats(void) {
+    int expected = 0;
+    for (int i = 0; i < sysex_num_params; i++) expected += sysex_params[i].count;
+
+    command(SYSEX_CMD_DUMP, NULL, 0);
+    CHECK_EQ(num_replies, expected);
+    for (int i = 0; i < num_replies && i < MAX_REPLIES; i++) {
+        CHECK_EQ(reply_lengths[i], 9);
+        CHECK_EQ(replies[i][3], SYSEX_REPLY_VALUE);
+    }
+
+    // Without a start, the first page
+    command(SYSEX_CMD_STATS, NULL, 0);
+    CHECK_EQ(num_replies, 1);
+    CHECK_EQ(replies[0][3], SYSEX_REPLY_STATS);
+    CHECK_EQ(replies[0][4], 0);
+    CHECK_EQ(replies[0][5], SYSEX_STATS_PER_REPLY);
+    CHECK_EQ(replies[0][6], SYSEX_MAX_STATS);
+    CHECK_EQ(replies[0][reply_lengths[0] - 1], SYSEX_END);
+
+    // Every page fits the 64-byte USB MIDI FIFO: three SysEx bytes per
+    // four-byte packet
+    for (uint8_t start = 0; start < SYSEX_MAX_STATS; start += SYSEX_STATS_PER_REPLY) {
+        command(SYSEX_CMD_STATS, &start, 1);
+        CHECK_EQ(num_replies, 1);
+        CHECK_EQ(replies[0][4], start);
+        CHECK_EQ(replies[0][5], SYSEX_STATS_PER_REPLY);
+        CHECK((reply_lengths[0] + 2) / 3 * 4 <= 64);
+        for (int i = 0; i < SYSEX_STATS_PER_REPLY; i++) {
+            uint32_t counter = 0;
+            for (int k = 0; k < 5; k++) counter = (counter << 7) | replies[0][7 + i * 5 + k];
+            CHECK_EQ(counter, 0x12345678u + start + i);
+        }
+    }
+
+    // A short last page, and nothing past the end
+    uint8_t start = SYSEX_MAX_STATS - 3;
+    command(SYSEX_CMD_STATS, &start, 1);
+    CHECK_EQ(replies[0][5], 3);
+    CHECK_EQ(reply_lengths[0], 8 + 3 * 5);
+    start = SYSEX_MAX_STATS;
+    command(SYSEX_CMD_STATS, &start, 1);
+    CHECK_EQ(replies[0][5], 0);
+    CHECK_EQ(replies[0][6], SYSEX_MAX_STATS);
+
+    // No store hook: the store fails cleanly
+    command(SYSEX_CMD_STORE, NULL, 0);
+    CHECK_EQ(replies[0][5], SYSEX_STATUS_FAILED);
+}
+
+// Drain a queue in chunks of at most chunk bytes, like a FIFO with that
+// much room per frame, and return what came out
+static uint32_t drain(sysex_reply_queue_t *queue, uint32_t chunk, uint8_t *out) {
+    uint32_t total = 0;
+    const uint8_t *data;
+    uint32_t len;
+    while ((len = sysex_queue_peek(queue, &data)) > 0) {
+        // Never past the end of the reply being sent
+        CHECK(memchr(data, SYSEX_END, len - 1) == NULL);
+        uint32_t taken = len < chunk ? len : chunk;
+        memcpy(out + total, data, taken);
+        sysex_queue_consume(queue, taken);
+        total += taken;
+        // Part-way through a reply exactly when the last byte out isn't F7
+        CHECK(queue->open == (out[total - 1] != SYSEX_END));
+    }
+    return total;
+}
+
+static void test_reply_queue(void) {
+    static sysex_reply_queue_t queue;
+    static uint8_t expected[4 * SYSEX_REPLY_QUEUE_SIZE];
+    static uint8_t out[4 * SYSEX_REPLY_QUEUE_SIZE];
+    uint32_t expected_len = 0;
+
+    // Replies of every length, pushed and drained in uneven steps so the
+    // ring wraps inside replies
+    for (int round = 0; round < 40; round++) {
+        uint32_t pushed = 0;
+        for (uint32_t len = 5 + round % 7; pushed + len <= 300; len += 11) {
+            uint8_t msg[SYSEX_MAX_LENGTH];
+            msg[0] = SYSEX_START;
+            for (uint32_t i = 1; i < len - 1; i++) msg[i] = (round + i) & 0x7F;
+            msg[len - 1] = SYSEX_END;
+            CHECK(sysex_queue_push(&queue, msg, len));
+            memcpy(expected + expected_len, msg, len);
+            expected_len += len;
+            pushed += len;
+        }
+        uint32_t drained = drain(&queue, 1 + round % 13, out);
+        CHECK_EQ(drained, expected_len);
+        CHECK(memcmp(out, expected, drained) == 0);
+        expected_len = 0;
+    }
+
+    // A reply that doesn't fit is dropped whole
+    uint8_t big[SYSEX_MAX_LENGTH];
+    memset(big, 0x01, sizeof(big));
+    big[0] = SYSEX_START;
+    big[sizeof(big) - 1] = SYSEX_END;
+    int fitted = 0;
+    while (sysex_queue_push(&queue, big, sizeof(big))) fitted++;
+    CHECK_EQ(fitted, SYSEX_REPLY_QUEUE_SIZE / SYSEX_MAX_LENGTH);
+    CHECK_EQ(queue.dropped, 1);
+    CHECK_EQ(drain(&queue, 64, out), fitted * sizeof(big));
+
+    // A full dump fits in one go
+    command(SYSEX_CMD_DUMP, NULL, 0);
+    for (int i = 0; i < num_replies; i++) {
+        CHECK(sysex_queue_push(&queue, replies[i], reply_lengths[i]));
+    }
+    sysex_queue_consume(&queue, 4);
+    CHECK(queue.open);
+    sysex_queue_clear(&queue);
+    CHECK(!queue.open);
+    const uint8_t *data;
+    CHECK_EQ(sysex_queue_peek(&queue, &data), 0);
+}
+
+int main(void) {
+    test_parser();
+    test_get_set_swap();
+    test_conflicts();
+    test_dump_and_stats();
+    test_reply_queue();
+    return test_result();
+}
@@ -0,0 +1,111 @@
+// UMP encoder and MIDI 1.0 translation (ump.h) against reference packets.
+//
+// The expected words and bytes are written out by hand from the MIDI 2.0
+// UMP format specification, including its min-centre-max upscaling
+// examples, rather than computed with the code under test.
+
+#include <string.h>
+#include "ump.h"
+#include "test.h"
+
+static void check_words(const ump_t *packet, uint32_t word0, uint32_t word1) {
+    CHECK_EQ(packet->num_words, 2);
+    CHECK_EQ(packet->words[0], word0);
+    CHECK_EQ(packet->words[1], word1);
+}
+
+static void check_bytes(const ump_t *packet, const uint8_t *expected, uint8_t len) {
+    uint8_t out[UMP_MIDI1_MAX_BYTES];
+    uint8_t got = ump_to_midi1(packet, out);
+    CHECK_EQ(got, len);
+    if (got == len) CHECK(memcmp(out, expected, len) == 0);
+}
+
+static void test_scale_up(void) {
+    CHECK_EQ(ump_scale_up(0x00, 7, 16), 0x0000);
+    CHECK_EQ(ump_scale_up(0x40, 7, 16), 0x8000);
+    CHECK_EQ(ump_scale_up(0x41, 7, 16), 0x8208);
+    CHECK_EQ(ump_scale_up(0x7F, 7, 16), 0xFFFF);
+    CHECK_EQ(ump_scale_up(0x41, 7, 32), 0x82082082);
+    CHECK_EQ(ump_scale_up(0x7F, 7, 32), 0xFFFFFFFF);
+    CHECK_EQ(ump_scale_up(0x0001, 14, 32), 0x00040000);
+    CHECK_EQ(ump_scale_up(0x2000, 14, 32), 0x80000000);
+    CHECK_EQ(ump_scale_up(0x3FFF, 14, 32), 0xFFFFFFFF);
+    CHECK_EQ(ump_scale_up(0x2A, 7, 7), 0x2A);
+
+    // Scaling down again gives back every value
+    for (uint32_t v = 0; v < 128; v++) CHECK_EQ(ump_scale_down(ump_scale_up(v, 7, 32), 32, 7), v);
+    for (uint32_t v = 0; v < 16384; v++) CHECK_EQ(ump_scale_down(ump_scale_up(v, 14, 32), 32, 14), v);
+}
+
+static void test_encoders(void) {
+    ump_t packet;
+
+    ump_note_on(&packet, 0, 0, 0x3C, 0xFFFF, UMP_ATTRIBUTE_PITCH_7_9, 0x3C << 9);
+    check_words(&packet, 0x40903C03, 0xFFFF7800);
+
+    ump_note_off(&packet, 1, 2, 0x40, 0x8000);
+    check_words(&packet, 0x41824000, 0x80000000);
+
+    ump_control_change(&packet, 0, 0, 0x07, 0x80000000);
+    check_words(&packet, 0x40B00700, 0x80000000);
+
+    ump_registered_controller(&packet, 0, 0, 0x00, 0x00, 12u << 25);
+    check_words(&packet, 0x40200000, 0x18000000);
+
+    ump_pitch_bend(&packet, 0, 3, UMP_PITCH_BEND_CENTER);
+    check_words(&packet, 0x40E30000, 0x80000000);
+
+    // Out of range group, channel and 7-bit fields are masked
+    ump_control_change(&packet, 0x1F, 0x1F, 0xFF, 1);
+    check_words(&packet, 0x4FBF7F00, 0x00000001);
+}
+
+static void test_translation(void) {
+    ump_t packet;
+
+    ump_note_on(&packet, 0, 0, 0x3C, 0xFFFF, UMP_ATTRIBUTE_PITCH_7_9, 0x3C << 9);
+    check_bytes(&packet, (const uint8_t[]){0x90, 0x3C, 0x7F}, 3);
+
+    // The softest note on must not turn into a note off
+    ump_note_on(&packet, 0, 0, 0x3C, 0x0001, UMP_ATTRIBUTE_NONE, 0);
+    check_bytes(&packet, (const uint8_t[]){0x90, 0x3C, 0x01}, 3);
+
+    ump_note_off(&packet, 0, 2, 0x40, 0x8000);
+    check_bytes(&packet, (const uint8_t[]){0x82, 0x40, 0x40}, 3);
+
+    ump_control_change(&packet, 0, 0, 0x07, 0x82082082);
+    check_bytes(&packet, (const uint8_t[]){0xB0, 0x07, 0x41}, 3);
+
+    ump_registered_controller(&packet, 0, 0, 0x00, 0x00, 12u << 25);
+    check_bytes(&packet, (const uint8_t[]){
+        0xB0, 0x65, 0x00, 0xB0, 0x64, 0x00, 0xB0, 0x06, 0x0C,
+        0xB0, 0x26, 0x00, 0xB0, 0x65, 0x7F, 0xB0, 0x64, 0x7F}, 18);
+
+    ump_pitch_bend(&packet, 0, 3, UMP_PITCH_BEND_CENTER);
+    check_bytes(&packet, (const uint8_t[]){0xE3, 0x00, 0x40}, 3);
+    ump_pitch_bend(&packet, 0, 3, 0xFFFFFFFF);
+    check_bytes(&packet, (const uint8_t[]){0xE3, 0x7F, 0x7F}, 3);
+
+    // Type 2 packets are unwrapped, with the length of their status
+    packet = (ump_t){.words = {0x20903C64}, .num_words = 1};
+    check_bytes(&packet, (const uint8_t[]){0x90, 0x3C, 0x64}, 3);
+    packet = (ump_t){.words = {0x20C00500}, .num_words = 1};
+    check_bytes(&packet, (const uint8_t[]){0xC0, 0x05}, 2);
+
+    // No MIDI 1.0 form: system messages, per-note pitch bend, short packets
+    uint8_t out[UMP_MIDI1_MAX_BYTES];
+    packet = (ump_t){.words = {0x10F80000}, .num_words = 1};
+    CHECK_EQ(ump_to_midi1(&packet, out), 0);
+    packet = (ump_t){.words = {0x40603C00, 0x80000000}, .num_words = 2};
+    CHECK_EQ(ump_to_midi1(&packet, out), 0);
+    packet = (ump_t){.words = {0x40B00700}, .num_words = 1};
+    CHECK_EQ(ump_to_midi1(&packet, out), 0);
+}
+
+int main(void) {
+    test_scale_up();
+    test_encoders();
+    test_translation();
+    return test_result();
+}
@@ -0,0 +1,367 @@
+// Searches the fretted-mode softpot parameters (fret_hysteresis,
+// softpot_deviation_max, softpot_max_slew) against a corpus of recorded
+// softpot traces. Every trace is replayed through the firmware's own
+// softpot filter, fret quantiser and fret bend for each candidate of a grid,
+// spread over all cores. Each candidate is scored on:
+//
+//   spurious  note changes per minute to a fret the player wasn't on
+//   latency   mean time from the player reaching a fret to the note, ms
+//   error     RMS pitch error while touching, cents
+//
+// The Pareto front of the three is printed. The front candidate with the
+// lowest latency that stays within the spurious note budget (then the
+// lowest error) is written as a parameter file for
+// `stradex_ctl <device> load`.
+//
+// A trace is text, one sample per line, '#' starts a comment:
+//
+//   <time_us> <softpot> [<pitch>]
+//
+// pitch is the intended pitch in semitones above the open string, if the
+// trace is labelled. Otherwise the reference is the trace itself, median
+// filtered without delay (which no causal filter can do), through the
+// continuous pitch map.
+//
+//   tune_params [-j threads] [-s spurious_per_min] [-o params.txt]
+//               [-f fret_map.txt] trace...
+//
+// The spurious note budget defaults to 1 per minute.
+//
+// fret_map.txt holds the 16 fret_positions of the instrument the traces
+// were recorded on; without it the defaults are used.
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "config.h"
+#include "pitchmap.h"
+#include "quantizer.h"
+#include "softpot_filter.h"
+
+#define MAX_TRACES 64
+#define REFERENCE_WINDOW 9          // Centred median for unlabelled traces
+#define MISSED_ONSET_MS 100.0       // Latency charged when a fret is never reached
+
+static const int16_t hysteresis_grid[] = {0, 25, 50, 75, 100, 125, 150, 200, 250, 300};
+static const int16_t deviation_grid[] = {250, 375, 500, 625, 750, 1000, 1250, 1500, 2000, 2500};
+static const int16_t slew_grid[] = {0, 500, 1000, 1500, 2000, 3000, 4000};
+
+#define NUM_HYSTERESIS (sizeof(hysteresis_grid) / sizeof(hysteresis_grid[0]))
+#define NUM_DEVIATION (sizeof(deviation_grid) / sizeof(deviation_grid[0]))
+#define NUM_SLEW (sizeof(slew_grid) / sizeof(slew_grid[0]))
+#define NUM_CANDIDATES (NUM_HYSTERESIS * NUM_DEVIATION * NUM_SLEW)
+
+typedef struct {
+    const char *path;
+    int length;
+    uint32_t *time_us;
+    int16_t *softpot;
+    double *reference;              // Intended pitch, semitones
+    int16_t *reference_fret;        // -1 while not touching
+} trace_t;
+
+typedef struct {
+    int16_t hysteresis;
+    int16_t deviation_max;
+    int16_t max_slew;
+    double spurious;
+    double latency;
+    double error;
+} candidate_t;
+
+static trace_t traces[MAX_TRACES];
+static int num_traces;
+static candidate_t candidates[NUM_CANDIDATES];
+static int num_threads;
+
+static int16_t fret_positions[CONFIG_NUM_FRET_POSITIONS];
+static quantizer_table_t fret_table;
+static int16_t touch_threshold;
+static int16_t bend_max;
+
+static int compare_int16(const void *a, const void *b) {
+    return *(const int16_t *)a - *(const int16_t *)b;
+}
+
+static double pitch_of(int16_t value) {
+    return pitchmap_fractional_fret(fret_positions, CONFIG_NUM_FRET_POSITIONS, value) / (double)PITCHMAP_ONE;
+}
+
+static void build_reference(trace_t *trace, int labelled) {
+    for (int i = 0; i < trace->length; i++) {
+        int16_t window[REFERENCE_WINDOW];
+        int count = 0;
+        for (int k = i - REFERENCE_WINDOW / 2; k <= i + REFERENCE_WINDOW / 2; k++) {
+            if (k >= 0 && k < trace->length) {
+                window[count++] = trace->softpot[k];
+            }
+        }
+        qsort(window, count, sizeof(int16_t), compare_int16);
+        int16_t median = window[count / 2];
+
+        if (median < touch_threshold) {
+            trace->reference_fret[i] = -1;
+            continue;
+        }
+        if (!labelled) {
+            trace->reference[i] = pitch_of(median);
+        }
+        trace->reference_fret[i] = (int16_t)lround(trace->reference[i]);
+    }
+}
+
+static int load_trace(trace_t *trace, const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 0;
+    }
+
+    int capacity = 4096;
+    trace->path = path;
+    trace->time_us = malloc(capacity * sizeof(uint32_t));
+    trace->softpot = malloc(capacity * sizeof(int16_t));
+    trace->reference = malloc(capacity * sizeof(double));
+
+    char line[128];
+    int labelled = 1;
+    while (fgets(line, sizeof(line), in)) {
+        unsigned time_us;
+        int softpot;
+        double pitch;
+        if (line[0] == '#') continue;
+        int fields = sscanf(line, "%u %d %lf", &time_us, &softpot, &pitch);
+        if (fields < 2) continue;
+        if (fields < 3) labelled = 0;
+
+        if (trace->length == capacity) {
+            capacity *= 2;
+            trace->time_us = realloc(trace->time_us, capacity * sizeof(uint32_t));
+            trace->softpot = realloc(trace->softpot, capacity * sizeof(int16_t));
+            trace->reference = realloc(trace->reference, capacity * sizeof(double));
+        }
+        trace->time_us[trace->length] = time_us;
+        trace->softpot[trace->length] = softpot;
+        trace->reference[trace->length] = fields == 3 ? pitch : 0;
+        trace->length++;
+    }
+    fclose(in);
+
+    trace->reference_fret = malloc(trace->length * sizeof(int16_t));
+    build_reference(trace, labelled);
+    return trace->length > 1;
+}
+
+// Replay one trace the way interpret_midi_state() does in fretted mode
+static void score_trace(const trace_t *trace, const candidate_t *c, double *spurious, double *latency_ms,
+                        int *onsets, double *error_sum, int *error_count) {
+    softpot_filter_t filter = {0};
+    quantizer_t quantizer;
+    quantizer_init(&quantizer, fret_positions, CONFIG_NUM_FRET_POSITIONS, c->hysteresis, &fret_table);
+
+    int16_t previous_fret = -1;
+    int onset = -1;                 // Sample of a reference change not yet followed
+
+    for (int i = 0; i < trace->length; i++) {
+        int16_t value = trace->softpot[i];
+        if (c->max_slew != 0) {
+            value = softpot_filter_update(&filter, value, touch_threshold, c->max_slew);
+        }
+        int16_t fret = quantizer_update(&quantizer, value);
+        int32_t bend = PITCHMAP_BEND_CENTER;
+        if (fret > 0) {
+            bend = pitchmap_fret_bend(fret_positions, CONFIG_NUM_FRET_POSITIONS, value, fret, c->deviation_max,
+                                      bend_max);
+        }
+        double pitch = fret + (bend - PITCHMAP_BEND_CENTER) / (double)PITCHMAP_BEND_PER_SEMITONE;
+        int16_t target = trace->reference_fret[i];
+
+        // A new reference fret starts an onset; a previous one still pending
+        // was never reached
+        if (i > 0 && target != trace->reference_fret[i - 1] && target >= 0) {
+            if (onset >= 0) {
+                *latency_ms += MISSED_ONSET_MS;
+                (*onsets)++;
+            }
+            onset = i;
+        }
+        if (onset >= 0 && fret == target) {
+            *latency_ms += (trace->time_us[i] - trace->time_us[onset]) / 1000.0;
+            (*onsets)++;
+            onset = -1;
+        }
+
+        if (target >= 0) {
+            if (fret != previous_fret && previous_fret != -1 && fret != target) {
+                (*spurious)++;
+            }
+            double cents = (pitch - trace->reference[i]) * 100;
+            *error_sum += cents * cents;
+            (*error_count)++;
+        }
+        previous_fret = fret;
+    }
+}
+
+static void score(candidate_t *c) {
+    double spurious = 0, latency = 0, error_sum = 0, minutes = 0;
+    int onsets = 0, error_count = 0;
+
+    for (int t = 0; t < num_traces; t++) {
+        score_trace(&traces[t], c, &spurious, &latency, &onsets, &error_sum, &error_count);
+        minutes += (traces[t].time_us[traces[t].length - 1] - traces[t].time_us[0]) / 60e6;
+    }
+    c->spurious = minutes > 0 ? spurious / minutes : 0;
+    c->latency = onsets > 0 ? latency / onsets : 0;
+    c->error = error_count > 0 ? sqrt(error_sum / error_count) : 0;
+}
+
+static void *worker(void *arg) {
+    int id = (int)(intptr_t)arg;
+    for (int i = id; i < (int)NUM_CANDIDATES; i += num_threads) {
+        score(&candidates[i]);
+    }
+    return NULL;
+}
+
+// Of candidates with identical scores only the first one stays on the front
+static int dominates(const candidate_t *a, const candidate_t *b) {
+    if (a->spurious > b->spurious || a->latency > b->latency || a->error > b->error) return 0;
+    return a->spurious < b->spurious || a->latency < b->latency || a->error < b->error || a < b;
+}
+
+// Within the spurious budget lower latency wins, then lower error; outside
+// it fewer spurious notes win
+static int better(const candidate_t *a, const candidate_t *b, double budget) {
+    int a_ok = a->spurious <= budget, b_ok = b->spurious <= budget;
+    if (a_ok != b_ok) return a_ok;
+    if (!a_ok && a->spurious != b->spurious) return a->spurious < b->spurious;
+    if (a->latency != b->latency) return a->latency < b->latency;
+    return a->error < b->error;
+}
+
+static int compare_spurious(const void *a, const void *b) {
+    const candidate_t *x = *(candidate_t *const *)a, *y = *(candidate_t *const *)b;
+    if (x->spurious != y->spurious) return x->spurious < y->spurious ? -1 : 1;
+    return x->latency < y->latency ? -1 : x->latency > y->latency;
+}
+
+static int load_fret_map(const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 0;
+    }
+    int count = 0, value;
+    while (count < CONFIG_NUM_FRET_POSITIONS && fscanf(in, "%d", &value) == 1) {
+        fret_positions[count++] = value;
+    }
+    fclose(in);
+    if (count != CONFIG_NUM_FRET_POSITIONS) {
+        fprintf(stderr, "%s: expected %d fret positions\n", path, CONFIG_NUM_FRET_POSITIONS);
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    double budget = 1.0;
+    num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    memcpy(fret_positions, config_defaults.fret_positions, sizeof(fret_positions));
+    touch_threshold = config_defaults.softpot_touch_threshold;
+    bend_max = config_defaults.pitchbend_max_range;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+            num_threads = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "-s") == 0 && arg + 1 < argc) {
+            budget = atof(argv[++arg]);
+        } else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+            output = argv[++arg];
+        } else if (strcmp(argv[arg], "-f") == 0 && arg + 1 < argc) {
+            if (!load_fret_map(argv[++arg])) return 1;
+        } else {
+            break;
+        }
+    }
+    if (arg == argc || num_threads < 1) {
+        fprintf(stderr, "usage: %s [-j threads] [-s spurious_per_min] [-o params.txt] [-f fret_map.txt] trace...\n",
+                argv[0]);
+        return 1;
+    }
+    quantizer_build_table(&fret_table, fret_positions, CONFIG_NUM_FRET_POSITIONS);
+
+    for (; arg < argc && num_traces < MAX_TRACES; arg++) {
+        if (!load_trace(&traces[num_traces], argv[arg])) return 1;
+        num_traces++;
+    }
+
+    int n = 0;
+    for (size_t h = 0; h < NUM_HYSTERESIS; h++) {
+        for (size_t d = 0; d < NUM_DEVIATION; d++) {
+            for (size_t s = 0; s < NUM_SLEW; s++) {
+                candidates[n++] = (candidate_t){
+                    .hysteresis = hysteresis_grid[h],
+                    .deviation_max = deviation_grid[d],
+                    .max_slew = slew_grid[s]
+                };
+            }
+        }
+    }
+
+    pthread_t threads[num_threads];
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, worker, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    candidate_t *front[NUM_CANDIDATES];
+    int front_size = 0;
+    for (int i = 0; i < n; i++) {
+        int dominated = 0;
+        for (int k = 0; k < n && !dominated; k++) {
+            dominated = dominates(&candidates[k], &candidates[i]);
+        }
+        if (!dominated) {
+            front[front_size++] = &candidates[i];
+        }
+    }
+    qsort(front, front_size, sizeof(front[0]), compare_spurious);
+
+    candidate_t *best = front[0];
+    for (int i = 1; i < front_size; i++) {
+        if (better(front[i], best, budget)) {
+            best = front[i];
+        }
+    }
+
+    printf("%d traces, %d candidates on %d threads, %d on the Pareto front\n",
+           num_traces, n, num_threads, front_size);
+    printf("  hysteresis deviation_max max_slew  spurious/min latency_ms error_cents\n");
+    for (int i = 0; i < front_size; i++) {
+        candidate_t *c = front[i];
+        printf("%s %10d %13d %8d %12.2f %10.1f %11.1f\n", c == best ? "*" : " ",
+               c->hysteresis, c->deviation_max, c->max_slew, c->spurious, c->latency, c->error);
+    }
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    if (!output) printf("\n");
+    fprintf(out, "# tune_params: %.2f spurious/min, %.1f ms latency, %.1f cents error\n",
+            best->spurious, best->latency, best->error);
+    fprintf(out, "fret_hysteresis %d\n", best->hysteresis);
+    fprintf(out, "softpot_deviation_max %d\n", best->deviation_max);
+    fprintf(out, "softpot_max_slew %d\n", best->max_slew);
+    if (output) fclose(out);
+    return 0;
+}
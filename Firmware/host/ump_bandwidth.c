@@ -0,0 +1,97 @@
+// Compares the output bandwidth of the MIDI 2.0 UMP path with the MIDI 1.0
+// path for the same performance: a 4 s bowed note swelling in and out, with
+// a 5.5 Hz vibrato on the bend and a modulation sweep, at a 1 ms control
+// rate. Each controller is sampled at the given resolution, encoded as
+// UMPs and translated to MIDI 1.0 as the firmware does. A message only goes
+// out when its encoded value changes.
+//
+// USB carries MIDI 1.0 as 4-byte event packets, one per 3-byte message, and
+// MIDI 2.0 channel voice UMPs as 8 bytes.
+//
+//   ump_bandwidth [bits] [-v]
+//
+// bits is the source resolution of the controllers (7-16, default 12). -v
+// prints every packet and its translation.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ump.h"
+
+#define DURATION_MS 4000
+
+typedef struct {
+    uint32_t messages;
+    uint32_t usb_bytes;
+} path_stats_t;
+
+static path_stats_t midi1, midi2;
+static int verbose;
+
+// Send one packet on both paths, each only if its own encoding changed
+static void send(const ump_t *packet, uint32_t *last_ump, uint8_t *last_midi1) {
+    uint8_t bytes[UMP_MIDI1_MAX_BYTES];
+    uint8_t len = ump_to_midi1(packet, bytes);
+
+    if (packet->words[1] != *last_ump) {
+        midi2.messages++;
+        midi2.usb_bytes += packet->num_words * 4;
+        *last_ump = packet->words[1];
+        if (verbose) printf("UMP   %08X %08X\n", packet->words[0], packet->words[1]);
+    }
+    if (len && memcmp(bytes, last_midi1, len) != 0) {
+        midi1.messages += len / 3;
+        midi1.usb_bytes += len / 3 * 4;
+        memcpy(last_midi1, bytes, len);
+        if (verbose) printf("MIDI1 %02X %02X %02X\n", bytes[0], bytes[1], bytes[2]);
+    }
+}
+
+int main(int argc, char **argv) {
+    int bits = 12;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else {
+            bits = atoi(argv[i]);
+        }
+    }
+    if (bits < 7 || bits > 16) {
+        fprintf(stderr, "usage: %s [bits 7-16] [-v]\n", argv[0]);
+        return 1;
+    }
+    uint32_t top = (1u << bits) - 1;
+
+    ump_t packet;
+    uint32_t last_volume = ~0u, last_modulation = ~0u, last_bend = ~0u, last_note = ~0u;
+    uint8_t volume1[3] = {0}, modulation1[3] = {0}, bend1[3] = {0}, note1[3] = {0};
+
+    ump_note_on(&packet, 0, 0, 64, ump_scale_up(100, 7, 16), UMP_ATTRIBUTE_PITCH_7_9, 64 << 9);
+    send(&packet, &last_note, note1);
+
+    for (int ms = 0; ms < DURATION_MS; ms++) {
+        double t = ms / 1000.0;
+        double swell = sin(M_PI * t / (DURATION_MS / 1000.0));
+        double vibrato = t > 1.0 ? 0.02 * sin(2 * M_PI * 5.5 * t) : 0;
+
+        ump_control_change(&packet, 0, 0, 0x07, ump_scale_up((uint32_t)(swell * top), bits, 32));
+        send(&packet, &last_volume, volume1);
+        ump_control_change(&packet, 0, 0, 0x01, ump_scale_up((uint32_t)(t / 4.0 * top), bits, 32));
+        send(&packet, &last_modulation, modulation1);
+
+        // The bend is 14-bit at the source in the firmware
+        uint32_t bend = 8192 + (int32_t)(vibrato * 8191);
+        ump_pitch_bend(&packet, 0, 0, ump_scale_up(bend, 14, 32));
+        send(&packet, &last_bend, bend1);
+    }
+
+    ump_note_off(&packet, 0, 0, 64, 0);
+    send(&packet, &last_note, note1);
+
+    printf("%d-bit controllers, %d ms\n", bits, DURATION_MS);
+    printf("  MIDI 1.0: %6u messages, %7u USB bytes\n", midi1.messages, midi1.usb_bytes);
+    printf("  MIDI 2.0: %6u messages, %7u USB bytes (%.2fx)\n", midi2.messages, midi2.usb_bytes,
+           (double)midi2.usb_bytes / midi1.usb_bytes);
+    return 0;
+}
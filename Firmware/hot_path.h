@@ -0,0 +1,28 @@
+#ifndef _HOT_PATH_H_
+#define _HOT_PATH_H_
+
+/** \file hot_path.h
+ * \brief Placement of the sensor-to-MIDI hot path
+ *
+ * Functions on the way from an ADC reading to a queued MIDI message are
+ * defined as HOT_PATH(name), and the constant tables they read every scan
+ * as HOT_DATA(name). Built with STRADEX_SRAM_HOT_PATH these are linked into
+ * SRAM through the SDK's time-critical sections, so they never wait on a
+ * flash fetch after something else (tud_task(), a flash write) has evicted
+ * them from the XIP cache. Otherwise, and on the host, both do nothing.
+ *
+ * Only the marked code moves: SDK functions called from the hot path stay
+ * in flash, and a function that was left unmarked shows up as XIP misses
+ * in the per-stage profile (xip_profile.h).
+*/
+
+#if defined(STRADEX_SRAM_HOT_PATH) && STRADEX_SRAM_HOT_PATH
+#include "pico.h"
+#define HOT_PATH(name) __time_critical_func(name)
+#define HOT_DATA(name) __not_in_flash(#name) name
+#else
+#define HOT_PATH(name) name
+#define HOT_DATA(name) name
+#endif
+
+#endif
@@ -0,0 +1,228 @@
+#include "i2c_bus.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "i2c_bus.pio.h"
+
+#define HALF_CLOCK_US 5
+
+// PIO clock cycles per bit, see i2c_bus.pio
+#define HS_CYCLES_PER_BIT 9
+
+// Hs-mode master code 00001xxx; no device acknowledges it
+#define HS_MASTER_CODE 0x08
+
+// Fields of a byte frame for the state machine
+#define HS_FRAME_START (1u << 31)
+#define HS_FRAME_BYTE_SHIFT 23
+#define HS_FRAME_NACK (1u << 22)
+#define HS_FRAME_STOP (1u << 21)
+
+static const uint32_t baudrates[I2C_BUS_NUM_SPEEDS] = {100 * 1000, 400 * 1000, 1000 * 1000,
+                                                       3400 * 1000};
+
+static PIO hs_pio;
+static uint hs_sm;
+static uint hs_offset;
+static bool hs_claimed = false;
+static bool hs_active = false;
+static uint8_t hs_sda;
+static uint8_t hs_scl;
+
+uint32_t i2c_bus_baudrate(i2c_bus_speed_t speed) {
+    return baudrates[speed < I2C_BUS_NUM_SPEEDS ? speed : I2C_BUS_FAST];
+}
+
+static void hs_set_clkdiv(uint32_t baudrate) {
+    pio_sm_set_clkdiv(hs_pio, hs_sm, (float)clock_get_hz(clk_sys) / (HS_CYCLES_PER_BIT * baudrate));
+}
+
+// Send one byte frame and wait for the nine bits the state machine saw on
+// SDA. A timeout leaves the state machine waiting for the next frame, with
+// both lines released.
+static int hs_frame(uint32_t frame, absolute_time_t deadline) {
+    pio_sm_put(hs_pio, hs_sm, frame);
+    while (pio_sm_is_rx_fifo_empty(hs_pio, hs_sm)) {
+        if (time_reached(deadline)) {
+            uint32_t pins = (1u << hs_sda) | (1u << hs_scl);
+            pio_sm_set_enabled(hs_pio, hs_sm, false);
+            pio_sm_clear_fifos(hs_pio, hs_sm);
+            pio_sm_restart(hs_pio, hs_sm);
+            pio_sm_set_pindirs_with_mask(hs_pio, hs_sm, pins, pins);
+            pio_sm_exec(hs_pio, hs_sm, pio_encode_jmp(hs_offset + i2c_hs_offset_entry));
+            pio_sm_set_enabled(hs_pio, hs_sm, true);
+            return PICO_ERROR_TIMEOUT;
+        }
+    }
+    return (int)pio_sm_get(hs_pio, hs_sm);
+}
+
+static uint32_t hs_byte(uint8_t byte) {
+    return (uint32_t)byte << HS_FRAME_BYTE_SHIFT;
+}
+
+// Take the pins back from the state machine. The bus is still in Hs-mode
+// until the next STOP.
+static void hs_stop(void) {
+    pio_sm_set_enabled(hs_pio, hs_sm, false);
+    gpio_set_oeover(hs_sda, GPIO_OVERRIDE_NORMAL);
+    gpio_set_oeover(hs_scl, GPIO_OVERRIDE_NORMAL);
+    hs_active = false;
+}
+
+// Hand the pins to the state machine and send the master code at 400 kHz
+static bool hs_start(uint8_t sda, uint8_t scl) {
+    if (scl != sda + 1) return false;
+    if (!hs_claimed) {
+        hs_claimed = pio_claim_free_sm_and_add_program(&i2c_hs_program, &hs_pio, &hs_sm, &hs_offset);
+        if (!hs_claimed) return false;
+    }
+    hs_sda = sda;
+    hs_scl = scl;
+
+    pio_sm_config c = i2c_hs_program_get_default_config(hs_offset);
+    sm_config_set_out_pins(&c, sda, 1);
+    sm_config_set_set_pins(&c, sda, 1);
+    sm_config_set_in_pins(&c, sda);
+    sm_config_set_sideset_pins(&c, scl);
+    sm_config_set_out_shift(&c, false, false, 32);
+    sm_config_set_in_shift(&c, false, true, 9);
+    pio_sm_init(hs_pio, hs_sm, hs_offset + i2c_hs_offset_entry, &c);
+
+    // Outputs stay low; the inverted output enable makes pindir 1 release
+    // a line and pindir 0 pull it down
+    uint32_t pins = (1u << sda) | (1u << scl);
+    pio_sm_set_pins_with_mask(hs_pio, hs_sm, 0, pins);
+    pio_sm_set_pindirs_with_mask(hs_pio, hs_sm, pins, pins);
+    pio_gpio_init(hs_pio, sda);
+    pio_gpio_init(hs_pio, scl);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    gpio_set_oeover(sda, GPIO_OVERRIDE_INVERT);
+    gpio_set_oeover(scl, GPIO_OVERRIDE_INVERT);
+
+    hs_set_clkdiv(baudrates[I2C_BUS_FAST]);
+    pio_sm_set_enabled(hs_pio, hs_sm, true);
+    int bits = hs_frame(HS_FRAME_START | hs_byte(HS_MASTER_CODE) | HS_FRAME_NACK,
+                        make_timeout_time_us(100));
+    hs_set_clkdiv(baudrates[I2C_BUS_HIGH_SPEED]);
+
+    hs_active = true;
+    if (bits < 0 || !(bits & 1)) {
+        // SCL never came up, or something acknowledged the master code
+        hs_stop();
+    }
+    return hs_active;
+}
+
+uint32_t i2c_bus_set_speed(i2c_inst_t *i2c, uint8_t sda, uint8_t scl, i2c_bus_speed_t speed) {
+    enum gpio_drive_strength drive = speed >= I2C_BUS_FAST_PLUS ? GPIO_DRIVE_STRENGTH_12MA
+                                                                : GPIO_DRIVE_STRENGTH_4MA;
+    gpio_set_drive_strength(sda, drive);
+    gpio_set_drive_strength(scl, drive);
+
+    if (speed == I2C_BUS_HIGH_SPEED) {
+        if (hs_active) return baudrates[I2C_BUS_HIGH_SPEED];
+        if (hs_start(sda, scl)) return baudrates[I2C_BUS_HIGH_SPEED];
+
+        // Send the STOP that takes the devices out of Hs-mode and give the
+        // bus back to the I2C block
+        i2c_bus_recover(i2c, sda, scl, baudrates[I2C_BUS_FAST_PLUS]);
+        speed = I2C_BUS_FAST_PLUS;
+    } else if (hs_active) {
+        hs_stop();
+        i2c_bus_recover(i2c, sda, scl, i2c_bus_baudrate(speed));
+    }
+    return i2c_set_baudrate(i2c, i2c_bus_baudrate(speed));
+}
+
+bool i2c_bus_high_speed(void) {
+    return hs_active;
+}
+
+// Address frame, with a repeated START. Returns PICO_OK if it was
+// acknowledged.
+static int hs_address(uint8_t addr, bool read, absolute_time_t deadline) {
+    int bits = hs_frame(HS_FRAME_START | hs_byte((uint8_t)(addr << 1 | read)) | HS_FRAME_NACK,
+                        deadline);
+    if (bits < 0) return bits;
+    return (bits & 1) ? PICO_ERROR_GENERIC : PICO_OK;
+}
+
+int i2c_bus_hs_write_timeout_us(uint8_t addr, const uint8_t *src, size_t len, uint timeout_us) {
+    absolute_time_t deadline = make_timeout_time_us(timeout_us);
+    int result = hs_address(addr, false, deadline);
+    if (result != PICO_OK) return result;
+
+    for (size_t i = 0; i < len; i++) {
+        int bits = hs_frame(hs_byte(src[i]) | HS_FRAME_NACK, deadline);
+        if (bits < 0) return bits;
+        if (bits & 1) return PICO_ERROR_GENERIC;
+    }
+    return (int)len;
+}
+
+int i2c_bus_hs_read_timeout_us(uint8_t addr, uint8_t *dst, size_t len, uint timeout_us) {
+    absolute_time_t deadline = make_timeout_time_us(timeout_us);
+    int result = hs_address(addr, true, deadline);
+    if (result != PICO_OK) return result;
+
+    // Acknowledge every byte but the last
+    for (size_t i = 0; i < len; i++) {
+        uint32_t ack = i + 1 == len ? HS_FRAME_NACK : 0;
+        int bits = hs_frame(hs_byte(0xFF) | ack, deadline);
+        if (bits < 0) return bits;
+        dst[i] = (uint8_t)(bits >> 1);
+    }
+    return (int)len;
+}
+
+// Open drain: pull a line low by driving it as an output, release it by
+// turning it back into an input and letting the pull-up raise it
+static void line_low(uint8_t pin) {
+    gpio_set_dir(pin, GPIO_OUT);
+    busy_wait_us_32(HALF_CLOCK_US);
+}
+
+static void line_release(uint8_t pin) {
+    gpio_set_dir(pin, GPIO_IN);
+    busy_wait_us_32(HALF_CLOCK_US);
+}
+
+bool i2c_bus_recover(i2c_inst_t *i2c, uint8_t sda, uint8_t scl, uint32_t baudrate) {
+    // The STOP below also ends Hs-mode, which is entered again afterwards
+    bool high_speed = hs_active;
+    if (high_speed) {
+        hs_stop();
+        baudrate = baudrates[I2C_BUS_FAST_PLUS];
+    }
+
+    i2c_deinit(i2c);
+    gpio_init(sda);
+    gpio_init(scl);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    gpio_put(sda, 0);
+    gpio_put(scl, 0);
+    line_release(scl);
+
+    // Clock out whatever the device is still trying to send
+    for (int i = 0; i < I2C_BUS_RECOVERY_PULSES && !gpio_get(sda); i++) {
+        line_low(scl);
+        line_release(scl);
+    }
+
+    // START then STOP (SDA falls, then rises, while SCL is high)
+    line_low(sda);
+    line_release(sda);
+    bool released = gpio_get(sda) && gpio_get(scl);
+
+    i2c_init(i2c, baudrate);
+    gpio_set_function(sda, GPIO_FUNC_I2C);
+    gpio_set_function(scl, GPIO_FUNC_I2C);
+    if (high_speed && !hs_start(sda, scl)) {
+        i2c_bus_recover(i2c, sda, scl, baudrate);
+        return false;
+    }
+    return released;
+}
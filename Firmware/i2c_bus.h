@@ -0,0 +1,106 @@
+#ifndef _I2C_BUS_H_
+#define _I2C_BUS_H_
+
+#include "pico.h"
+#include "hardware/i2c.h"
+
+/** \file i2c_bus.h
+ * \brief I2C bus speed and recovery for the sensor bus
+ *
+ * The RP2350 I2C block runs Standard mode (100 kHz), Fast mode (400 kHz)
+ * and Fast-mode Plus (1 MHz). It has no High-speed mode (3.4 MHz), so Hs-mode
+ * is run by a PIO state machine instead (i2c_bus.pio). It sends the Hs
+ * master code at 400 kHz, after which the ADS1115 stays in Hs-mode until it
+ * sees a STOP. Every Hs transfer therefore starts with a repeated START and
+ * ends without a STOP. SCL must be the pin after SDA.
+ *
+ * The SCL rise time at 3.4 MHz needs a strong pull-up. The state machine
+ * waits for SCL to rise before each sample, so a slow bus runs slower rather
+ * than misreading, and the read-back check after a speed change catches one
+ * that doesn't work at all. If no PIO state machine is free, Hs-mode falls
+ * back to Fast-mode Plus.
+ *
+ * A device that was interrupted mid-read (e.g. by a reset or a glitch on
+ * SCL) can keep holding SDA low, waiting for clocks that never come. Then
+ * every transfer on the bus fails. The standard fix is to clock SCL by hand
+ * until the device lets go of SDA, then send a STOP.
+*/
+
+#define I2C_BUS_RECOVERY_PULSES 9
+
+typedef enum i2c_bus_speed {
+    I2C_BUS_STANDARD = 0,       // 100 kHz
+    I2C_BUS_FAST,               // 400 kHz
+    I2C_BUS_FAST_PLUS,          // 1 MHz
+    I2C_BUS_HIGH_SPEED,         // 3.4 MHz, PIO
+    I2C_BUS_NUM_SPEEDS
+} i2c_bus_speed_t;
+
+/*! \brief Baud rate of a bus speed
+ *
+ * \param speed Bus speed
+ * \return Baud rate in Hz
+ */
+uint32_t i2c_bus_baudrate(i2c_bus_speed_t speed);
+
+/*! \brief Switch the bus to another speed
+ *
+ * Fast-mode Plus and Hs-mode also raise the pad drive strength, so the lines
+ * can sink the larger pull-up current they need. Hs-mode hands the pins to
+ * the PIO and enters Hs-mode; any other speed hands them back to the I2C
+ * block, ending Hs-mode with a STOP.
+ *
+ * \param i2c The I2C instance, either i2c0 or i2c1
+ * \param sda SDA pin
+ * \param scl SCL pin
+ * \param speed Bus speed
+ * \return Baud rate actually set: the Fast-mode Plus rate if Hs-mode could
+ * not be entered
+ */
+uint32_t i2c_bus_set_speed(i2c_inst_t *i2c, uint8_t sda, uint8_t scl, i2c_bus_speed_t speed);
+
+/*! \brief Whether transfers have to go through the Hs-mode functions
+ *
+ * \return true while the PIO runs the bus in Hs-mode
+ */
+bool i2c_bus_high_speed(void);
+
+/*! \brief Hs-mode counterpart of i2c_write_timeout_us()
+ *
+ * \param addr 7-bit address of the device
+ * \param src Bytes to write
+ * \param len Number of bytes
+ * \param timeout_us Time the whole transfer may take
+ * \return Number of bytes written, PICO_ERROR_GENERIC if the device didn't
+ * acknowledge or PICO_ERROR_TIMEOUT
+ */
+int i2c_bus_hs_write_timeout_us(uint8_t addr, const uint8_t *src, size_t len, uint timeout_us);
+
+/*! \brief Hs-mode counterpart of i2c_read_timeout_us()
+ *
+ * \param addr 7-bit address of the device
+ * \param dst Buffer for the bytes read
+ * \param len Number of bytes
+ * \param timeout_us Time the whole transfer may take
+ * \return Number of bytes read, PICO_ERROR_GENERIC if the device didn't
+ * acknowledge or PICO_ERROR_TIMEOUT
+ */
+int i2c_bus_hs_read_timeout_us(uint8_t addr, uint8_t *dst, size_t len, uint timeout_us);
+
+/*! \brief Free a stuck bus and hand it back to the I2C block
+ *
+ * Takes the pins over as open-drain GPIOs and clocks SCL up to nine times
+ * at about 100 kHz until SDA is released. It then generates a START and a
+ * STOP to reset every device's bus logic, and re-initialises the I2C block
+ * at the given baud rate. In Hs-mode the PIO lets go of the pins first and
+ * Hs-mode is entered again afterwards.
+ *
+ * \param i2c The I2C instance, either i2c0 or i2c1
+ * \param sda SDA pin
+ * \param scl SCL pin
+ * \param baudrate Baud rate to restart the bus at
+ * \return true if both lines were released
+ */
+bool i2c_bus_recover(i2c_inst_t *i2c, uint8_t sda, uint8_t scl, uint32_t baudrate);
+
+#endif
@@ -0,0 +1,44 @@
+#include "idle.h"
+
+void idle_init(idle_tracker_t *idle, uint32_t now_us) {
+    *idle = (idle_tracker_t){.last_activity_us = now_us};
+}
+
+void idle_activity(idle_tracker_t *idle, uint32_t now_us) {
+    idle->last_activity_us = now_us;
+}
+
+bool idle_due(const idle_tracker_t *idle, uint32_t now_us, uint32_t timeout_us) {
+    return timeout_us != 0 && !idle->idle && now_us - idle->last_activity_us >= timeout_us;
+}
+
+void idle_enter(idle_tracker_t *idle) {
+    idle->idle = true;
+    idle->waking = false;
+    idle->entries++;
+}
+
+void idle_wake(idle_tracker_t *idle, uint32_t start_us) {
+    idle->idle = false;
+    idle->waking = true;
+    idle->wake_start_us = start_us;
+    idle->last_activity_us = start_us;
+    idle->wakes++;
+}
+
+void idle_scan_complete(idle_tracker_t *idle, uint32_t now_us) {
+    if (!idle->waking) return;
+
+    idle->waking = false;
+    idle->wake_us_last = now_us - idle->wake_start_us;
+    if (idle->wake_us_last > idle->wake_us_max) {
+        idle->wake_us_max = idle->wake_us_last;
+    }
+}
+
+void idle_window(int16_t rest, int16_t margin, int16_t *lo, int16_t *hi) {
+    int32_t low = (int32_t)rest - margin;
+    int32_t high = (int32_t)rest + margin;
+    *lo = low < INT16_MIN ? INT16_MIN : low;
+    *hi = high > INT16_MAX ? INT16_MAX : high;
+}
@@ -0,0 +1,86 @@
+#ifndef _IDLE_H_
+#define _IDLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file idle.h
+ * \brief When to stop scanning, and how long waking up takes
+ *
+ * After a stretch without playing, the firmware stops the full-rate scan.
+ * Each chip's window comparator then watches one touch sensor, and the CPU
+ * sleeps until an ALRT edge (see main.c). This tracker decides when that
+ * happens and times every wake-up. The time runs from the edge, or the
+ * button press, to the end of the first full scan after it. That is the
+ * earliest point a note can start.
+ *
+ * The tracker only does the bookkeeping: main.c arms the comparators,
+ * sleeps and restarts the scan. Its counters go out as the telemetry idle
+ * frame, and the worst wake-up as idle_wake_us_max in the stats.
+*/
+
+typedef struct idle_tracker {
+    bool idle;                  // Comparators armed, scan stopped
+    bool waking;                // Woken, first full scan not in yet
+    uint32_t last_activity_us;
+    uint32_t wake_start_us;     // Edge or button press that woke the scan
+
+    // Counters for reporting
+    uint32_t entries;
+    uint32_t wakes;
+    uint32_t false_alerts;      // Edges whose conversion was back inside the window
+    uint32_t wake_us_last;
+    uint32_t wake_us_max;
+} idle_tracker_t;
+
+/*! \brief Start out scanning, as if just played
+ *
+ * \param idle Tracker to initialise
+ * \param now_us Current time in microseconds
+ */
+void idle_init(idle_tracker_t *idle, uint32_t now_us);
+
+/*! \brief Report that the instrument is being played
+ *
+ * \param idle Tracker
+ * \param now_us Current time in microseconds
+ */
+void idle_activity(idle_tracker_t *idle, uint32_t now_us);
+
+/*! \brief Whether the scan has gone unused for long enough to stop it
+ *
+ * \param idle Tracker
+ * \param now_us Current time in microseconds
+ * \param timeout_us Time without activity, 0 never goes idle
+ * \return true if not idle yet and timeout_us has passed since the last
+ * activity
+ */
+bool idle_due(const idle_tracker_t *idle, uint32_t now_us, uint32_t timeout_us);
+
+/*! \brief Record that the comparators are armed and the scan stopped
+ */
+void idle_enter(idle_tracker_t *idle);
+
+/*! \brief Record a wake-up, which counts as activity
+ *
+ * \param idle Tracker
+ * \param start_us Time of the edge or button press that woke the scan
+ */
+void idle_wake(idle_tracker_t *idle, uint32_t start_us);
+
+/*! \brief Record a completed full scan
+ *
+ * The first one after a wake-up ends its timing.
+ *
+ * \param idle Tracker
+ * \param now_us Current time in microseconds
+ */
+void idle_scan_complete(idle_tracker_t *idle, uint32_t now_us);
+
+/*! \brief Comparator window around a resting reading
+ *
+ * [rest - margin, rest + margin], clamped to the conversion range.
+ */
+void idle_window(int16_t rest, int16_t margin, int16_t *lo, int16_t *hi);
+
+#endif
@@ -0,0 +1,140 @@
+#include "interp_map.h"
+#include "hot_path.h"
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#define INTERP_MAP_HARDWARE 1
+#include "hardware/interp.h"
+#else
+#define INTERP_MAP_HARDWARE 0
+#endif
+
+// d * num / den, truncated like C's division. The reciprocal leaves the
+// quotient at most two short, the loop makes up the difference.
+static int32_t HOT_PATH(divide)(const interp_map_scale_t *scale, int32_t d) {
+    bool negative = scale->negative ^ (d < 0);
+    uint32_t n = (uint32_t)(d < 0 ? -d : d) * scale->num;
+    uint32_t q = ((uint64_t)n * scale->reciprocal) >> 32;
+    uint32_t r = n - q * scale->den;
+    while (r >= scale->den) {
+        q++;
+        r -= scale->den;
+    }
+    return negative ? -(int32_t)q : (int32_t)q;
+}
+
+void interp_map_scale_init(interp_map_scale_t *scale, int32_t in_lo, int32_t in_hi, int32_t in_origin,
+                           int32_t out_origin, int32_t num, int32_t den) {
+    if (den < 1) den = 1;
+    scale->in_lo = in_lo;
+    scale->in_hi = in_hi;
+    scale->in_origin = in_origin;
+    scale->out_origin = out_origin;
+    scale->negative = num < 0;
+    scale->num = num < 0 ? -num : num;
+    scale->den = den;
+    scale->reciprocal = 0xFFFFFFFFu / (uint32_t)den;
+}
+
+int32_t HOT_PATH(interp_map_lerp_soft)(const interp_map_lut_t *lut, uint32_t x) {
+    uint32_t last = lut->num_entries - 1;
+    if (x >= last << lut->frac_bits) return lut->table[last];
+
+    uint32_t i = x >> lut->frac_bits;
+    int32_t alpha = (x >> (lut->frac_bits - 8)) & 0xFF;
+    int32_t a = lut->table[i];
+    int32_t b = lut->table[i + 1];
+    return a + (((b - a) * alpha) >> 8);
+}
+
+int32_t HOT_PATH(interp_map_clamp_soft)(int32_t value, int32_t lo, int32_t hi) {
+    if (value < lo) return lo;
+    if (value > hi) return hi;
+    return value;
+}
+
+int32_t HOT_PATH(interp_map_scale_soft)(const interp_map_scale_t *scale, int32_t x) {
+    int32_t clamped = interp_map_clamp_soft(x, scale->in_lo, scale->in_hi);
+    return scale->out_origin + divide(scale, clamped - scale->in_origin);
+}
+
+#if INTERP_MAP_HARDWARE
+
+void interp_map_init(void) {
+    // Interp1 lane 0 clamps ACCUM0 to [BASE0, BASE1], signed
+    interp_config clamp = interp_default_config();
+    interp_config_set_clamp(&clamp, true);
+    interp_config_set_signed(&clamp, true);
+    interp_set_config(interp1, 0, &clamp);
+}
+
+void interp_map_lut_init(interp_map_lut_t *lut, const int16_t *table, uint16_t num_entries,
+                         uint8_t frac_bits) {
+    lut->table = table;
+    lut->num_entries = num_entries;
+    lut->frac_bits = frac_bits;
+
+    // Lane 0 turns the input into a byte offset for PEEK2 = table + offset.
+    // Lane 1 reads the same accumulator and masks out the 8-bit alpha, and
+    // blend mode then gives BASE0 + alpha * (BASE1 - BASE0) / 256 on PEEK1.
+    interp_config lane0 = interp_default_config();
+    interp_config_set_shift(&lane0, frac_bits - 1);
+    interp_config_set_mask(&lane0, 1, 31);
+    interp_config_set_blend(&lane0, true);
+    interp_config lane1 = interp_default_config();
+    interp_config_set_shift(&lane1, frac_bits - 8);
+    interp_config_set_mask(&lane1, 0, 7);
+    interp_config_set_signed(&lane1, true);
+    interp_config_set_cross_input(&lane1, true);
+    lut->ctrl[0] = lane0.ctrl;
+    lut->ctrl[1] = lane1.ctrl;
+}
+
+int32_t HOT_PATH(interp_map_lerp)(const interp_map_lut_t *lut, uint32_t x) {
+    uint32_t last = lut->num_entries - 1;
+    if (x >= last << lut->frac_bits) return lut->table[last];
+
+    interp0->ctrl[0] = lut->ctrl[0];
+    interp0->ctrl[1] = lut->ctrl[1];
+    interp0->base[2] = (uintptr_t)lut->table;
+    interp0->accum[0] = x;
+    const int16_t *entry = (const int16_t *)(uintptr_t)interp0->peek[2];
+    interp0->base[0] = entry[0];
+    interp0->base[1] = entry[1];
+    return (int32_t)interp0->peek[1];
+}
+
+int32_t HOT_PATH(interp_map_clamp)(int32_t value, int32_t lo, int32_t hi) {
+    interp1->base[0] = lo;
+    interp1->base[1] = hi;
+    interp1->accum[0] = value;
+    return (int32_t)interp1->peek[0];
+}
+
+int32_t HOT_PATH(interp_map_scale)(const interp_map_scale_t *scale, int32_t x) {
+    int32_t clamped = interp_map_clamp(x, scale->in_lo, scale->in_hi);
+    return scale->out_origin + divide(scale, clamped - scale->in_origin);
+}
+
+#else
+
+void interp_map_init(void) {
+}
+
+void interp_map_lut_init(interp_map_lut_t *lut, const int16_t *table, uint16_t num_entries,
+                         uint8_t frac_bits) {
+    *lut = (interp_map_lut_t){.table = table, .num_entries = num_entries, .frac_bits = frac_bits};
+}
+
+int32_t interp_map_lerp(const interp_map_lut_t *lut, uint32_t x) {
+    return interp_map_lerp_soft(lut, x);
+}
+
+int32_t interp_map_clamp(int32_t value, int32_t lo, int32_t hi) {
+    return interp_map_clamp_soft(value, lo, hi);
+}
+
+int32_t interp_map_scale(const interp_map_scale_t *scale, int32_t x) {
+    return interp_map_scale_soft(scale, x);
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef _INTERP_MAP_H_
+#define _INTERP_MAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file interp_map.h
+ * \brief Table lookup with interpolation, and clamped scaling
+ *
+ * On the Pico these run on the calling core's SIO interpolators. Interp0
+ * in blend mode finds the table entry and interpolates between it and the
+ * next one. Interp1 in clamp mode clamps. The interpolators can't divide,
+ * so a scale precomputes a reciprocal and only multiplies per reading.
+ * Everywhere else the _soft versions are used. Both must match the
+ * straight-line references in interp_map_check.h bit for bit; the host test
+ * and the bench firmware on the device check this.
+ *
+ * The interpolators are per core and not saved across interrupts, so call
+ * these only from thread code, and call interp_map_init() once on each core
+ * that uses them.
+*/
+
+typedef struct interp_map_lut {
+    const int16_t *table;
+    uint16_t num_entries;       // At least 2
+    uint8_t frac_bits;          // Input steps between two entries, 8 to 16 bits
+    uint32_t ctrl[2];           // Interp0 lane setup for this table
+} interp_map_lut_t;
+
+typedef struct interp_map_scale {
+    int32_t in_lo;              // Input clamp
+    int32_t in_hi;
+    int32_t in_origin;
+    int32_t out_origin;
+    uint32_t num;               // |num|, the sign is kept separately
+    bool negative;
+    uint32_t den;
+    uint32_t reciprocal;        // 0xFFFFFFFF / den
+} interp_map_scale_t;
+
+/*! \brief Set up this core's interpolators
+ */
+void interp_map_init(void);
+
+/*! \brief Describe a table for interp_map_lerp()
+ *
+ * \param table Entries for inputs 0, 1 << frac_bits, 2 << frac_bits, ...
+ * \param num_entries Number of entries
+ * \param frac_bits Input bits between two entries, 8 to 16
+ */
+void interp_map_lut_init(interp_map_lut_t *lut, const int16_t *table, uint16_t num_entries,
+                         uint8_t frac_bits);
+
+/*! \brief Look up an input, interpolating linearly between entries
+ *
+ * table[i] + ((table[i + 1] - table[i]) * alpha >> 8), where i is the input's
+ * entry and alpha the top 8 bits of its remainder. Inputs at or past the
+ * last entry give the last entry.
+ */
+int32_t interp_map_lerp(const interp_map_lut_t *lut, uint32_t x);
+int32_t interp_map_lerp_soft(const interp_map_lut_t *lut, uint32_t x);
+
+/*! \brief Clamp a value to [lo, hi]
+ */
+int32_t interp_map_clamp(int32_t value, int32_t lo, int32_t hi);
+int32_t interp_map_clamp_soft(int32_t value, int32_t lo, int32_t hi);
+
+/*! \brief Precompute a clamped linear scale
+ *
+ * The scale gives out_origin + (clamp(x, in_lo, in_hi) - in_origin) * num / den,
+ * with the division truncating like C's. (clamp(x) - in_origin) * num must
+ * fit in 32 bits.
+ *
+ * \param den Divisor, at least 1
+ */
+void interp_map_scale_init(interp_map_scale_t *scale, int32_t in_lo, int32_t in_hi, int32_t in_origin,
+                           int32_t out_origin, int32_t num, int32_t den);
+
+/*! \brief Apply a scale built with interp_map_scale_init()
+ */
+int32_t interp_map_scale(const interp_map_scale_t *scale, int32_t x);
+int32_t interp_map_scale_soft(const interp_map_scale_t *scale, int32_t x);
+
+#endif
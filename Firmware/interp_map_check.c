@@ -0,0 +1,115 @@
+#include "interp_map_check.h"
+#include "interp_map.h"
+#include "config.h"
+#include "pitchmap.h"
+
+static uint32_t random_state = 2024;
+
+static uint32_t next_random() {
+    random_state = random_state * 1664525 + 1013904223;
+    return random_state >> 16;
+}
+
+// Division rounding towards minus infinity, as an arithmetic shift does
+static int32_t floor_div(int32_t n, int32_t d) {
+    int32_t q = n / d;
+    return (n % d != 0 && (n < 0) != (d < 0)) ? q - 1 : q;
+}
+
+int32_t interp_map_lerp_ref(const int16_t *table, uint16_t num_entries, uint8_t frac_bits, uint32_t x) {
+    uint32_t step = 1u << frac_bits;
+    uint32_t entry = x / step;
+    if (entry >= num_entries - 1u) return table[num_entries - 1];
+
+    // The top eight bits of the position between the two entries
+    int32_t alpha = (int32_t)((uint64_t)(x % step) * 256 / step);
+    return table[entry] + floor_div((table[entry + 1] - table[entry]) * alpha, 256);
+}
+
+int32_t interp_map_scale_ref(int32_t in_lo, int32_t in_hi, int32_t in_origin, int32_t out_origin,
+                             int32_t num, int32_t den, int32_t x) {
+    if (den < 1) den = 1;
+    int64_t clamped = x < in_lo ? in_lo : x > in_hi ? in_hi : x;
+    return out_origin + (int32_t)((clamped - in_origin) * num / den);
+}
+
+static uint32_t check_lerp(const int16_t *table, uint16_t num_entries, uint8_t frac_bits) {
+    uint32_t mismatches = 0;
+    interp_map_lut_t lut;
+    interp_map_lut_init(&lut, table, num_entries, frac_bits);
+
+    // Every input for the small steps, a dense sweep with every fraction for 16 bits
+    uint32_t end = (num_entries + 1u) << frac_bits;
+    for (uint32_t x = 0; x < end; x += frac_bits > 11 ? 1 + (next_random() & 0x3F) : 1) {
+        int32_t expected = interp_map_lerp_ref(table, num_entries, frac_bits, x);
+        mismatches += interp_map_lerp(&lut, x) != expected;
+        mismatches += interp_map_lerp_soft(&lut, x) != expected;
+    }
+    return mismatches;
+}
+
+static uint32_t check_scale(int32_t in_lo, int32_t in_hi, int32_t in_origin, int32_t out_origin,
+                            int32_t num, int32_t den, int32_t x) {
+    interp_map_scale_t scale;
+    interp_map_scale_init(&scale, in_lo, in_hi, in_origin, out_origin, num, den);
+    int32_t expected = interp_map_scale_ref(in_lo, in_hi, in_origin, out_origin, num, den, x);
+    return (interp_map_scale(&scale, x) != expected) + (interp_map_scale_soft(&scale, x) != expected);
+}
+
+uint32_t interp_map_check(void) {
+    const stradex_config_t *cfg = &config_defaults;
+    uint32_t mismatches = 0;
+
+    // A table with full-range steps in both directions
+    int16_t table[129];
+    for (int i = 0; i < 129; i++) {
+        table[i] = (int16_t)(next_random() - 32768);
+    }
+    table[1] = INT16_MAX;
+    table[2] = INT16_MIN;
+    mismatches += check_lerp(table, 129, 8);
+    mismatches += check_lerp(table, 129, 11);
+    mismatches += check_lerp(table, 17, 16);
+    mismatches += check_lerp(table, 2, 8);
+
+    for (int32_t x = -40000; x <= 40000; x += 7) {
+        int32_t expected = x < -1000 ? -1000 : x > 30000 ? 30000 : x;
+        mismatches += interp_map_clamp(x, -1000, 30000) != expected;
+        mismatches += interp_map_clamp_soft(x, -1000, 30000) != expected;
+    }
+
+    // The firmware's scales over every reading
+    for (int32_t x = INT16_MIN; x <= INT16_MAX; x++) {
+        mismatches += check_scale(cfg->fsr_min_value, cfg->fsr_max_value, cfg->fsr_min_value,
+                                  cfg->volume_max, cfg->volume_min - cfg->volume_max,
+                                  cfg->fsr_max_value - cfg->fsr_min_value, x);
+        mismatches += check_scale(-cfg->softpot_deviation_max, cfg->softpot_deviation_max, 0,
+                                  PITCHMAP_BEND_CENTER, cfg->pitchbend_max_range,
+                                  cfg->softpot_deviation_max, x);
+    }
+
+    // Random scales, including the largest products and divisors
+    for (int n = 0; n < 1000; n++) {
+        int32_t lo = -(int32_t)(next_random() & 0x7FFF);
+        int32_t hi = next_random() & 0x7FFF;
+        int32_t out_origin = (int16_t)next_random();
+        int32_t num = (int32_t)(next_random() & 0x7FFF) - 16384;
+        int32_t den = 1 + (next_random() & 0x7FFF);
+        if (n == 0) {
+            num = INT16_MAX;
+            den = 1;
+        } else if (n == 1) {
+            num = -INT16_MAX;
+            den = 3;
+        } else if (n == 2) {
+            num = 1;
+            den = 32768;
+        }
+        for (int k = 0; k < 64; k++) {
+            mismatches += check_scale(lo, hi, lo, out_origin, num, den, (int16_t)next_random());
+        }
+        mismatches += check_scale(lo, hi, lo, out_origin, num, den, hi);
+        mismatches += check_scale(lo, hi, lo, out_origin, num, den, INT16_MIN);
+    }
+    return mismatches;
+}
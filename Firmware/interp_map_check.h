@@ -0,0 +1,40 @@
+#ifndef _INTERP_MAP_CHECK_H_
+#define _INTERP_MAP_CHECK_H_
+
+#include <stdint.h>
+
+/** \file interp_map_check.h
+ * \brief Straight-line reference for interp_map, and a check against it
+ *
+ * The references compute each result directly from its definition: a
+ * table entry and alpha by division, the interpolation rounded towards
+ * minus infinity with an explicit floor, and a scale in 64-bit arithmetic
+ * with C's truncating division. They share no code with interp_map.c, so
+ * the check means something on the host as well, where interp_map runs its
+ * software versions. On the Pico the same check covers the interpolators.
+ * host/test_interp_map.c runs it, and so does the bench firmware.
+*/
+
+/*! \brief Reference for interp_map_lerp()
+ */
+int32_t interp_map_lerp_ref(const int16_t *table, uint16_t num_entries, uint8_t frac_bits, uint32_t x);
+
+/*! \brief Reference for interp_map_scale()
+ */
+int32_t interp_map_scale_ref(int32_t in_lo, int32_t in_hi, int32_t in_origin, int32_t out_origin,
+                             int32_t num, int32_t den, int32_t x);
+
+/*! \brief Compare interp_map with the references
+ *
+ * Covers lookups in a random table at 8, 11 and 16 fraction bits over the
+ * whole input range and past its end, clamps across both ends, the
+ * firmware's FSR window and fret bend scales at their defaults over every
+ * 16-bit input, and random scales. Both the interp_map calls and their
+ * _soft versions are checked. interp_map_init() must have been called on
+ * this core.
+ *
+ * \return Number of results that differ from the reference, 0 if all agree
+ */
+uint32_t interp_map_check(void);
+
+#endif
@@ -0,0 +1,59 @@
+#include "legato.h"
+#include "config.h"
+#include "hot_path.h"
+#include "pitchmap.h"
+
+uint8_t HOT_PATH(legato_note_change)(int16_t mode, int16_t legato_velocity, int16_t attack_velocity,
+                                     int16_t previous_note, int16_t current_note, int16_t *velocity,
+                                     legato_event_t events[LEGATO_MAX_EVENTS]) {
+    if (current_note == previous_note) return 0;
+
+    if (mode != LEGATO_OFF && previous_note != -1 && current_note != -1) {
+        if (legato_velocity != 0) {
+            *velocity = legato_velocity;
+        }
+        events[0] = (legato_event_t){LEGATO_NOTE_ON, current_note, *velocity};
+        events[1] = (legato_event_t){LEGATO_NOTE_OFF, previous_note, 0};
+        return 2;
+    }
+
+    uint8_t count = 0;
+    if (previous_note != -1) {
+        events[count++] = (legato_event_t){LEGATO_NOTE_OFF, previous_note, 0};
+    }
+    if (current_note != -1) {
+        *velocity = attack_velocity;
+        events[count++] = (legato_event_t){LEGATO_NOTE_ON, current_note, *velocity};
+    }
+    return count;
+}
+
+void legato_bend_reset(legato_bend_t *state) {
+    state->held_fret = -1;
+    state->string = -1;
+}
+
+int16_t HOT_PATH(legato_bend_update)(legato_bend_t *state, int16_t string, int16_t fret,
+                                     int16_t *pitch_bend, int16_t range) {
+    // The open string ends the slide, and another string starts a new one
+    if (fret == 0 || string != state->string) {
+        state->held_fret = -1;
+        state->string = string;
+    }
+    if (fret == 0) return fret;
+
+    int32_t offset = ((int32_t)(*pitch_bend - PITCHMAP_BEND_CENTER) * PITCHMAP_ONE) / PITCHMAP_BEND_PER_SEMITONE;
+    int32_t bend = -1;
+
+    if (state->held_fret != -1) {
+        bend = pitchmap_bend((fret - state->held_fret) * PITCHMAP_ONE + offset, range);
+    }
+    if (bend < 0) {
+        state->held_fret = fret;
+        bend = pitchmap_bend(offset, range);
+        if (bend < 0) bend = PITCHMAP_BEND_CENTER;
+    }
+
+    *pitch_bend = bend;
+    return state->held_fret;
+}
@@ -0,0 +1,71 @@
+#ifndef _LEGATO_H_
+#define _LEGATO_H_
+
+#include <stdint.h>
+
+/** \file legato.h
+ * \brief Note-to-note transitions for the legato modes (config_legato_mode)
+ *
+ * legato_note_change() turns a change of sounding note into the note on and
+ * note off messages to send, in order. With LEGATO_OVERLAP and LEGATO_BEND
+ * the new note on goes out before the old note off, so a mono synth glides
+ * instead of re-attacking.
+ *
+ * In LEGATO_BEND mode legato_bend_update() also keeps the note of the first
+ * fret of a slide sounding and reaches later frets by pitch bend, so a fast
+ * run along one string sends bends instead of note pairs. The held fret is
+ * given up when the slide leaves the bend range, on the open string and
+ * when another string is played.
+*/
+
+#define LEGATO_MAX_EVENTS 2
+
+enum legato_event_type {
+    LEGATO_NOTE_ON,
+    LEGATO_NOTE_OFF
+};
+
+typedef struct legato_event {
+    uint8_t type;       // legato_event_type
+    int16_t note;
+    int16_t velocity;   // Note on only
+} legato_event_t;
+
+typedef struct legato_bend {
+    int16_t held_fret;  // Fret of the note held through the slide, -1 = none
+    int16_t string;     // String the slide is on
+} legato_bend_t;
+
+/*! \brief Messages for a change of sounding note
+ *
+ * \param mode config_legato_mode
+ * \param legato_velocity Velocity of a legato note on, 0 reuses *velocity
+ * \param attack_velocity Velocity of a note on after silence
+ * \param previous_note Note sounding until now, -1 for none
+ * \param current_note Note to sound from now, -1 for none
+ * \param velocity Velocity of the sounding note, updated for a new note on
+ * \param events Receives the messages in sending order
+ * \return Number of messages, 0 if the note didn't change
+ */
+uint8_t legato_note_change(int16_t mode, int16_t legato_velocity, int16_t attack_velocity,
+                           int16_t previous_note, int16_t current_note, int16_t *velocity,
+                           legato_event_t events[LEGATO_MAX_EVENTS]);
+
+/*! \brief Forget the held fret, e.g. when every key is released
+ */
+void legato_bend_reset(legato_bend_t *state);
+
+/*! \brief Express a fret and its fretted-mode bend relative to the held fret
+ *
+ * \param string String being played
+ * \param fret Fret the softpot is quantised to, 0 for the open string
+ * \param pitch_bend Fretted-mode bend for the fret, in the receiver's
+ * default range of PITCHMAP_DEFAULT_BEND_RANGE semitones; replaced by the
+ * bend from the held fret, over range semitones
+ * \param range Bend range announced to the receiver, semitones
+ * \return Fret of the note to sound
+ */
+int16_t legato_bend_update(legato_bend_t *state, int16_t string, int16_t fret,
+                           int16_t *pitch_bend, int16_t range);
+
+#endif
@@ -3,6 +3,31 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "ads1115.h"
+#include "ads_health.h"
+#include "autorange.h"
+#include "bend_interp.h"
+#include "boot_log.h"
+#include "cc14.h"
+#include "config.h"
+#include "config_flash.h"
+#include "config_store.h"
+#include "fretcal.h"
+#include "hot_path.h"
+#include "i2c_bus.h"
+#include "idle.h"
+#include "interp_map.h"
+#include "legato.h"
+#include "midi_out.h"
+#include "midi_uart.h"
+#include "pitchmap.h"
+#include "quantizer.h"
+#include "sensor_map.h"
+#include "softpot_filter.h"
+#include "synth_audio.h"
+#include "sysex.h"
+#include "telemetry.h"
+#include "vibrato.h"
+#include "xip_profile.h"
 #include "tusb.h"
 
 ////////////////////// DEFINITIONS //////////////////////
@@ -10,19 +35,67 @@
 #define I2C_PORT i2c0
 #define I2C_SDA 4
 #define I2C_SCL 5
+#define I2C_BAUDRATE (400 * 1000) // Until the configured speed has been checked
 
-// ADS1115 Addresses
-#define ADS_1_ADDR 0x48
-#define ADS_2_ADDR 0x49
+// Analog sensors on the ADS1115 chips, one entry per conversion. Each chip
+// converts its own entries in this order; see sensor_map.h.
+// {address, mux, pga, rate, role, role index, filter}
+const sensor_channel_t HOT_DATA(sensor_map)[] = {
+    // ADS1 (0x48): key pressure FSRs
+    {0x48, ADS1115_MUX_SINGLE_0, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_FSR, 0, SENSOR_FILTER_NONE},
+    {0x48, ADS1115_MUX_SINGLE_1, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_FSR, 1, SENSOR_FILTER_NONE},
+    {0x48, ADS1115_MUX_SINGLE_2, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_FSR, 2, SENSOR_FILTER_NONE},
+    {0x48, ADS1115_MUX_SINGLE_3, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_FSR, 3, SENSOR_FILTER_NONE},
+    // ADS2 (0x49): softpot, modulation, FX (map as SENSOR_ROLE_FX to send CC2) and tuning
+    {0x49, ADS1115_MUX_SINGLE_0, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_SOFTPOT, 0, SENSOR_FILTER_RELEASE},
+    {0x49, ADS1115_MUX_SINGLE_1, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_MODULATION, 0, SENSOR_FILTER_NONE},
+    {0x49, ADS1115_MUX_SINGLE_2, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_NONE, 0, SENSOR_FILTER_NONE},
+    {0x49, ADS1115_MUX_SINGLE_3, ADS1115_PGA_4_096, ADS1115_RATE_860_SPS, SENSOR_ROLE_TUNING, 0, SENSOR_FILTER_NONE}
+};
+#define NUM_SENSOR_CHANNELS (sizeof(sensor_map) / sizeof(sensor_map[0]))
+
+sensor_schedule_t sensor_schedule;
+ads1115_adc_t ads_devices[SENSOR_MAP_MAX_DEVICES];
+
+// Chips that stop answering are taken out of the scan and reprobed; their
+// channels keep the last good reading meanwhile
+ads_health_t ads_health[SENSOR_MAP_MAX_DEVICES];
+uint32_t i2c_bus_recoveries = 0;
 
-ads1115_adc_t ads1, ads2;
+// Bus speed in use, and the configured speed it was derived from (the bus
+// steps down if a chip doesn't read back cleanly, counted in
+// i2c_speed_stepdowns)
+uint32_t i2c_baudrate = I2C_BAUDRATE;
+int16_t i2c_speed_requested = -1;
+uint32_t i2c_speed_stepdowns = 0;
+
+// Duration of the last full pass over the sensor map
+uint32_t last_scan_start = 0;
+uint32_t last_scan_us = 0;
 
 // ALRT Pins
 #define ADS_1_ALRT 6
 #define ADS_2_ALRT 7
 
+// Idle scanning (idle.h). While idle, each chip's window comparator watches
+// one of its touch sensors and moves on to the next every IDLE_TICK_US; the
+// CPU sleeps in between.
+#define IDLE_TICK_US 5000
+
+typedef struct {
+    int8_t channel;             // Map entry the comparator watches, -1 for none
+    uint8_t slot;               // Its position in the chip's channel list
+    int16_t lo, hi;             // Window around its resting reading
+} idle_watch_t;
+
+idle_tracker_t idle;
+idle_watch_t idle_watches[SENSOR_MAP_MAX_DEVICES];
+uint32_t idle_tick = 0;
+volatile bool alert_pending = false;
+volatile uint32_t alert_time = 0;       // First ALRT edge not yet looked at
+
 // Pushbutton Pins (PB)
-const int PB[] = {16, 17, 18, 19};
+const int HOT_DATA(PB)[] = {16, 17, 18, 19};
 #define NUM_PUSHBUTTONS (sizeof(PB) / sizeof(PB[0]))
 #define PB_1 PB[0]
 #define PB_2 PB[1] 
@@ -31,18 +104,17 @@ const int PB[] = {16, 17, 18, 19};
 
 // Sensor value storage variable arrays
 bool buttons[NUM_PUSHBUTTONS];
-int16_t adc_values_1[4];
-int16_t adc_values_2[4];
+int16_t sensor_values[SENSOR_MAP_MAX_CHANNELS]; // Indexed like sensor_map
+uint32_t sensor_fresh; // Map entries read on this loop pass
 
-// Non-blocking ADC reading state variables
+// Non-blocking ADC reading state variables, one per chip
 typedef struct {
-    int current_channel;
-    uint32_t last_switch_time;
+    uint32_t last_switch_time;  // time_us_32() of the channel switch
+    uint32_t settle_us;         // Wait before the reading belongs to the new channel
     bool waiting_for_switch;
 } adc_state_t;
 
-adc_state_t adc1_state = {0, 0, false};
-adc_state_t adc2_state = {0, 0, false};
+adc_state_t adc_states[SENSOR_MAP_MAX_DEVICES];
 
 // Current midi state variables
 int16_t current_note = -1;
@@ -53,58 +125,145 @@ int16_t current_volume = 127;
 int16_t previous_volume = 127;
 int16_t current_modulation = 0;
 int16_t previous_modulation = 0;
+int16_t previous_fx = -1;
+int16_t previous_expression = -1;
 bool note_on = false;
+int16_t current_string = -1;
+
+// What the on-board synth plays, published to core 1 every loop
+synth_params_t synth_params;
 
 // Fret detection state for hysteresis
 int16_t current_fret = -1;
+quantizer_t fret_quantizer;
+quantizer_table_t fret_table;
+
+// Per-key adaptive FSR ranging
+autorange_t fsr_ranges[4];
+
+// SysEx live-parameter protocol (MIDI OUT direction from the host)
+sysex_parser_t sysex_parser;
+
+// Main loop profiler counters, streamed over telemetry
+telemetry_profile_frame_t loop_profile;
+xip_profile_t xip_profile;
+_Static_assert(TELEMETRY_XIP_STAGES == XIP_NUM_STAGES, "the XIP frame must cover every stage");
+
+// Boot phase timings, kept across resets, and the phases in the last boot
+// frame sent
+boot_log_t __uninitialized_ram(boot_log);
+uint32_t boot_phases_reported = 0;
+_Static_assert(TELEMETRY_BOOT_PHASES == BOOT_NUM_PHASES, "the boot frame must cover every phase");
+
+// Slow telemetry frame due next: idle, serial MIDI, calibration, softpot
+#define TELEMETRY_NUM_SLOW_FRAMES 4
+uint8_t telemetry_slow_frame = 0;
+
+// The chips are brought up from the main loop while USB enumerates: the
+// next chip to probe, then the bus check. Nothing is played until the
+// first full scan.
+int boot_device = 0;
+bool sensors_ready = false;
+
+// Glide mode state: the fret of the note held through the current slide
+int16_t held_fret = -1;
+
+// Legato bend mode state (legato.h)
+legato_bend_t legato_bend = {.held_fret = -1, .string = -1};
+
+// Softpot after release detection and glitch rejection
+softpot_filter_t softpot_filter;
+int16_t softpot_filtered = 0;
+
+// Vibrato detector on the softpot stream and its last sent CC values
+vibrato_t vibrato;
+int16_t previous_vibrato_rate = -1;
+int16_t previous_vibrato_depth = -1;
+
+// Pitch bend upsampling between softpot samples
+bend_interp_t bend_interp;
+int16_t bend_target = PITCHMAP_BEND_CENTER;
+uint32_t last_bend_output_us = 0;
+
+// Pitch bend range last announced with RPN 0 (0 = not sent since the host
+// mounted or unmounted), and whether the host was mounted then
+int16_t sent_bend_range = 0;
+bool bend_range_host = false;
 
 // Tuning state variables
 int16_t tuning_offsets[4] = {0, 0, 0, 0}; // Tuning offset for each string in semitones
 
-// ADS1115 Channel Configurations
-uint16_t mux_configs[4] = {
-    ADS1115_MUX_SINGLE_0,
-    ADS1115_MUX_SINGLE_1,
-    ADS1115_MUX_SINGLE_2,
-    ADS1115_MUX_SINGLE_3
-};
+// Tuning and modulation pots are quantised with hysteresis so a pot resting
+// on a step boundary doesn't retrigger notes or spam CC1
+#define MAX_TUNING_EDGES 96
+quantizer_t tuning_quantizer;
+quantizer_table_t tuning_table;
+int16_t tuning_edges[MAX_TUNING_EDGES];
+int16_t tuning_band_offsets[MAX_TUNING_EDGES + 1];
+quantizer_t modulation_quantizer;
+quantizer_t fx_quantizer;
+quantizer_t expression_quantizer;
+quantizer_table_t modulation_table;
+int16_t modulation_edges[127]; // One edge per CC step above 0, shared by the 0-127 pots
 
-// Fret positions array (17 values from 9000 to 26000)
-int16_t fret_positions[16] = {
-    13200, // 2nd fret
-    14000, // 3rd fret  
-    14650, // 4th fret
-    15350, // 5th fret
-    16150, // 6th fret
-    16800, // 7th fret
-    17630, // 8th fret
-    18550, // 9th fret
-    19300, // 10th fret
-    20220, // 11th fret
-    21100, // 12th fret
-    21950, // 13th fret
-    22850, // 14th fret
-    24000, // 15th fret
-    24950,  // End boundary
-    26000  // End boundary
-};
+// Precomputed scales for the divisions on the hot path (interp_map.h): the
+// fixed FSR window for 7-bit and 14-bit volume, and the fretted-mode bend
+interp_map_scale_t volume_window;
+interp_map_scale_t volume14_window;
+interp_map_scale_t fret_bend_scale;
+
+// Controllers sent as 14-bit pairs skip the quantisers and use a deadband
+// over their own noise floor instead (config->cc14_controllers)
+cc14_t cc14_states[CC14_NUM_CONTROLLERS];
 
-// Base MIDI note values for buttons (G3, D4, A4, E5)
-int16_t base_notes[4] = {55, 62, 69, 76}; // G3=55, D4=62, A4=69, E5=76
+// Calibration and mapping (fret positions, base notes, FSR and tuning ranges)
+// come from the configuration store, see config.h
+config_store_t config_store;
 
-// FSR to Volume mapping configuration
-#define FSR_MIN_VALUE 1000    // FSR value for maximum volume
-#define FSR_MAX_VALUE 22000   // FSR value for minimum volume
-#define VOLUME_MAX 127        // Maximum MIDI volume (100%)
-#define VOLUME_MIN 13         // Minimum MIDI volume (~10%)
+#if STRADEX_SRAM_HOT_PATH
+// The hot path reads the configuration every scan, so the SRAM build keeps a
+// copy out of flash
+stradex_config_t config_ram;
+#endif
+
+// Fret map calibration: hold all four keys for CAL_HOLD_MS, then touch each
+// reference fret in turn and press key 1 to capture it (key 4 aborts)
+#define CAL_HOLD_MS 2000
+const int16_t cal_ref_frets[] = {1, 3, 5, 7, 10, 12};
+#define NUM_CAL_REF_FRETS (sizeof(cal_ref_frets) / sizeof(cal_ref_frets[0]))
+
+// Where calibration stands, for the stats and telemetry (no display to
+// prompt on)
+typedef enum {
+    CAL_STATUS_NONE = 0,        // Not run since boot
+    CAL_STATUS_CAPTURING,       // Waiting for cal_ref_frets[step]
+    CAL_STATUS_DONE,            // New fret map stored and in use
+    CAL_STATUS_ABORTED,
+    CAL_STATUS_FAILED,          // The fit or the fret map it gave was unusable
+    CAL_STATUS_NOT_STORED       // The fit was good but the flash write failed
+} calibration_status_t;
+
+typedef struct {
+    bool active;
+    int step;
+    uint32_t hold_start;
+    bool previous_buttons[4];
+    fretcal_session_t session;
+    calibration_status_t status;
+    uint32_t rms_error;         // Of the last successful fit, in ADC units
+} calibration_state_t;
+
+calibration_state_t calibration;
+
+// Note velocity for a fresh attack
+#define NOTE_VELOCITY 100
+
+// Everything goes out on UMP group 1, channel 1
+#define MIDI_GROUP 0
+#define MIDI_CHANNEL 0
 
 // Pitch bend configuration
-#define PITCHBEND_MAX_RANGE 2048   // Maximum pitch bend range (±2048 = ±2 semitones)
 #define PITCHBEND_CENTER 8192      // MIDI pitch bend center value (14-bit: 0-16383)
-#define SOFTPOT_DEVIATION_MAX 500  // Maximum softpot deviation from fret center for full pitch bend
-
-// Fret detection hysteresis configuration
-#define FRET_HYSTERESIS 75        // Units of hysteresis for fret switching stability
 
 // Modulation control configuration
 #define MODULATION_MIN 0          // Minimum modulation value (CC1)
@@ -113,36 +272,99 @@ int16_t base_notes[4] = {55, 62, 69, 76}; // G3=55, D4=62, A4=69, E5=76
 #define MIDI_EFFECT_MIN 0
 #define MIDI_EFFECT_MAX 127
 
-// Tuning control configuration  
-#define TUNING_RANGE 25           // ±13 semitones (one octave up/down)
-#define TUNING_CENTER_VALUE 13500 // Potentiometer center value for standard tuning
-#define TUNING_MIN_VALUE 1000        // Minimum potentiometer value
-#define TUNING_MAX_VALUE 26000    // Maximum potentiometer value
-
 // Define functions
 void serial_debug_print();
 void init_I2C();
+void recover_I2C();
+void set_I2C_speed(int16_t speed);
+bool check_I2C();
 void init_PB();
 void init_ads();
-bool read_ads_channels(ads1115_adc_t *ads, int16_t *adc_values, adc_state_t *state);
+bool boot_task();
+void init_alerts();
+void alert_callback(uint gpio, uint32_t events);
+bool is_wake_channel(uint8_t channel);
+int watch_next_channel(int device);
+void enter_idle();
+void disarm_comparators();
+void wake_from_idle(uint32_t start_us);
+bool idle_touched();
+void idle_task();
+void update_idle();
+bool read_ads_channels(int device);
+int setup_ads(int device);
+bool report_ads_result(int device, int result);
+int16_t sensor_value(sensor_role_t role, uint8_t index);
+bool sensor_mapped(sensor_role_t role, uint8_t index);
+bool sensor_updated(sensor_role_t role, uint8_t index);
+bool sensor_available(sensor_role_t role, uint8_t index);
+void update_pot_controls();
+int16_t update_pot_cc14(int controller, sensor_role_t role, uint8_t cc, int16_t neutral);
+bool cc14_enabled(int controller);
+void send_cc14(int controller, uint8_t cc, int16_t value, bool fresh);
+void send_control_change14(uint8_t controller, int16_t value, int16_t previous);
 void read_PB();
 void interpret_midi_state();
 int16_t get_fret_from_softpot(int16_t softpot_value);
-void send_note_on(int16_t note);
+bool calibration_task();
+uint32_t calibration_fret();
+void rebuild_fret_map();
+void rebuild_pot_maps();
+void rebuild_fsr_maps();
+void update_note_output();
+void send_note_on(int16_t note, int16_t velocity);
 void send_note_off(int16_t note);
-int16_t fsr_to_volume(int16_t fsr_value);
+int16_t fsr_to_volume(int16_t fsr_value, int key);
+int16_t fsr_to_level(int16_t fsr_value, int key, int16_t level_min, int16_t level_max,
+                     const interp_map_scale_t *window);
+void update_fsr_ranges();
 void send_volume_control(int16_t volume);
 int16_t calculate_pitch_bend(int16_t softpot_value, int16_t fret_position);
+int16_t get_glide_fret_and_bend(int16_t softpot_value, int16_t *pitch_bend);
+int16_t interpolate_pitch_bend(int16_t pitch_bend, bool new_note);
+bool uses_bend_range();
+void update_bend_range();
+void send_bend_range(int16_t semitones);
 void send_pitch_bend(int16_t pitch_bend_value);
 int16_t pot_to_tuning_offset(int16_t pot_value);
 void send_modulation_control(int16_t modulation);
 void send_midifx_control(int16_t midifx);
+void send_control_change(uint8_t controller, int16_t value);
+void update_softpot();
+void update_vibrato();
+void send_vibrato_controls();
+void send_telemetry();
+void update_synth();
+void sysex_task();
+void use_config(const stradex_config_t *stored);
+void main_loop_pass();
 
 int main()
 {
     ////////////////////// INITIALIZATION //////////////////////
+    boot_log_start(&boot_log, time_us_32());
+
+    // Get on the bus first, the host enumerates while the rest starts up
     stdio_init_all();
     tud_init(0);
+    boot_log_mark(&boot_log, BOOT_PHASE_USB_INIT, time_us_32());
+
+    // Use the stored configuration in place through XIP, or the defaults.
+    // The SRAM build copies either into RAM.
+    const stradex_config_t *stored = config_store_init(&config_store, config_flash_pico());
+    use_config(stored ? stored : &config_defaults);
+
+    for (int i = 0; i < 4; i++) {
+        autorange_init(&fsr_ranges[i], config->fsr_max_value, config->fsr_min_value);
+    }
+    interp_map_init();
+    rebuild_fret_map();
+    rebuild_pot_maps();
+    rebuild_fsr_maps();
+    for (int i = 0; i < CC14_NUM_CONTROLLERS; i++) {
+        cc14_init(&cc14_states[i]);
+    }
+    boot_log_mark(&boot_log, BOOT_PHASE_TABLES, time_us_32());
 
     // Initialize Push Buttons
     init_PB();
@@ -150,53 +372,207 @@ int main()
     // Initialize I2C
     init_I2C();
 
-    // Initialize ADS1115
-    // Edit contents of function to fiddle with ADS1115 settings
+    // Initialize ADS1115 bookkeeping; the chips themselves are set up by
+    // boot_task() from the main loop
     init_ads();
+    init_alerts();
+    idle_init(&idle, time_us_32());
+    boot_log_mark(&boot_log, BOOT_PHASE_GPIO, time_us_32());
+
+    // Standalone synth on core 1, a no-op unless built with STRADEX_SYNTH
+    for (int i = 0; i < SYNTH_NUM_VOICES; i++) {
+        synth_params.pitch[i] = config->base_notes[i] * SYNTH_PITCH_ONE;
+    }
+    synth_audio_start();
+
+    // DIN/TRS MIDI out, a no-op unless built with STRADEX_SERIAL_MIDI
+    midi_uart_init(config->serial_cc_interval_ms * 1000u);
 
     absolute_time_t next = make_timeout_time_ms(500);
     
+    // Initialisation runs once and stays in flash; only the loop is hot
     while (true) {
-        tud_task(); 
-
-        bool ads1_complete = read_ads_channels(&ads1, adc_values_1, &adc1_state);
-        bool ads2_complete = read_ads_channels(&ads2, adc_values_2, &adc2_state);
-        read_PB();
-        
-        interpret_midi_state();
-        
-        // Only send note if current_note has changed
-        if (current_note != previous_note) {
-            // Send note off for previous note if it was valid
-            if (previous_note != -1) {
-                send_note_off(previous_note);
-            }
-            // Send note on for current note if it's valid
-            if (current_note != -1) {
-                send_note_on(current_note);
+        main_loop_pass();
+    }
+}
+
+// One pass of the main loop: USB, the sensor scan, interpretation, MIDI and
+// telemetry out
+void HOT_PATH(main_loop_pass)() {
+    // Idle: sleep until an ALRT edge, a USB interrupt or the next tick.
+    // An interrupt just before the WFE leaves the event flag set, so
+    // none is slept through.
+    if (idle.idle && !alert_pending) {
+        best_effort_wfe_or_timeout(make_timeout_time_us(IDLE_TICK_US));
+    }
+
+    uint32_t loop_start = time_us_32();
+    uint32_t midi_messages = midi_out_get_stats()->messages;
+    xip_profile_begin(&xip_profile);
+
+    tud_task(); 
+    sysex_task();
+
+    // Frame boundary: live parameter edits are swapped in here only
+    if (config_apply_pending()) {
+        rebuild_fret_map();
+        rebuild_pot_maps();
+        rebuild_fsr_maps();
+        if (config->i2c_speed != i2c_speed_requested) {
+            set_I2C_speed(config->i2c_speed);
+        }
+        midi_uart_set_cc_interval(config->serial_cc_interval_ms * 1000u);
+        if (idle.idle) {
+            wake_from_idle(time_us_32());
+        }
+    }
+    update_bend_range();
+    xip_profile_mark(&xip_profile, XIP_STAGE_USB);
+
+    // Every chip works through its own mapped channels concurrently,
+    // once boot_task() has set them all up and unless idle
+    sensor_fresh = 0;
+    bool scan_complete = false;
+    bool booted = boot_task();
+    if (booted && !idle.idle) {
+        for (int device = 0; device < sensor_schedule.num_devices; device++) {
+            if (read_ads_channels(device)) {
+                scan_complete = true;
             }
-            previous_note = current_note;
         }
     }
+    read_PB();
+    if (idle.idle) {
+        idle_task();
+    }
+
+    // Ready to play after the first full scan (at boot or after idle),
+    // or straight away if no chip answered at all
+    if (booted && !idle.idle && !sensors_ready
+        && (scan_complete || sensor_schedule.active_mask == 0)) {
+        sensors_ready = true;
+        boot_log_mark(&boot_log, BOOT_PHASE_FIRST_SCAN, time_us_32());
+        idle_scan_complete(&idle, time_us_32());
+    }
+    xip_profile_mark(&xip_profile, XIP_STAGE_SCAN);
+
+    // Nothing is played from readings that aren't in yet
+    if (sensors_ready) {
+        // Adapt once per fresh reading, not per loop pass
+        update_fsr_ranges();
+        if (sensor_updated(SENSOR_ROLE_SOFTPOT, 0)) {
+            update_softpot();
+            update_vibrato();
+        }
+
+        if (!calibration_task()) {
+            interpret_midi_state();
+        }
+    }
+    xip_profile_mark(&xip_profile, XIP_STAGE_INTERPRET);
+
+    if (sensors_ready) {
+        update_note_output();
+        update_synth();
+        update_idle();
+    }
+
+    // Everything this pass queued goes to USB and serial in one pass
+    midi_out_end_frame();
+    midi_uart_task(time_us_32());
+    if (tud_mounted()) {
+        boot_log_mark(&boot_log, BOOT_PHASE_MOUNTED, time_us_32());
+    }
+    if (midi_out_get_stats()->messages != midi_messages) {
+        boot_log_mark(&boot_log, BOOT_PHASE_FIRST_MIDI, time_us_32());
+    }
+    xip_profile_mark(&xip_profile, XIP_STAGE_OUTPUT);
+
+    // Telemetry is strictly lower priority than MIDI: it only goes out
+    // on loop passes that didn't queue any MIDI
+    if (midi_out_get_stats()->messages == midi_messages && telemetry_due(loop_start)) {
+        send_telemetry();
+    }
+    xip_profile_mark(&xip_profile, XIP_STAGE_TELEMETRY);
+    xip_profile_end(&xip_profile);
+
+    uint32_t loop_time = time_us_32() - loop_start;
+    loop_profile.loops++;
+    loop_profile.loop_us_total += loop_time;
+    if (loop_time > loop_profile.loop_us_max) {
+        loop_profile.loop_us_max = loop_time;
+    }
+    if (scan_complete) {
+        loop_profile.scans_completed++;
+        last_scan_us = loop_start - last_scan_start;
+        last_scan_start = loop_start;
+    }
 }
 
 void serial_debug_print() {
-    printf("ADS1: A0:%5d  A1:%5d  A2:%5d  A3:%5d ", 
-            adc_values_1[0], adc_values_1[1], adc_values_1[2], adc_values_1[3]);
-    printf("ADS2: A0:%5d  A1:%5d  A2:%5d  A3:%5d ", 
-            adc_values_2[0], adc_values_2[1], adc_values_2[2], adc_values_2[3]);
+    for (int i = 0; i < NUM_SENSOR_CHANNELS; i++) {
+        printf("%02X/%d:%5d ", sensor_map[i].address, (sensor_map[i].mux >> 12) & 7, sensor_values[i]);
+    }
     printf("BTN: %d %d %d %d ", buttons[0], buttons[1], buttons[2], buttons[3]);
     printf("MIDI Note: %d (Note %s)\n", current_note, note_on ? "ON" : "OFF");
 }
 
 void init_I2C() {
-    i2c_init(I2C_PORT, 400*1000);
+    i2c_init(I2C_PORT, I2C_BAUDRATE);
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA);
     gpio_pull_up(I2C_SCL);
 }
 
+// Free a bus that a chip is holding down, then make every chip's registers
+// get rewritten on the next access
+void recover_I2C() {
+    i2c_bus_recover(I2C_PORT, I2C_SDA, I2C_SCL, i2c_baudrate);
+    i2c_bus_recoveries++;
+    if (i2c_baudrate > i2c_bus_baudrate(I2C_BUS_FAST_PLUS) && !i2c_bus_high_speed()) {
+        // Hs-mode couldn't be entered again, the bus carries on in Fast-mode Plus
+        i2c_baudrate = i2c_bus_baudrate(I2C_BUS_FAST_PLUS);
+    }
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        ads1115_forget_state(&ads_devices[device]);
+        adc_states[device].waiting_for_switch = false;
+    }
+}
+
+// Run the sensor bus at the configured speed. If any chip fails the
+// read-back check there, step down until they all pass.
+void set_I2C_speed(int16_t speed) {
+    i2c_speed_requested = speed;
+    while (true) {
+        i2c_baudrate = i2c_bus_set_speed(I2C_PORT, I2C_SDA, I2C_SCL, speed);
+        if (speed == I2C_BUS_STANDARD || check_I2C()) {
+            break;
+        }
+        i2c_speed_stepdowns++;
+        speed--;
+    }
+}
+
+// Pattern read-back on every chip that is answering. A chip that fails is
+// left to the health tracker.
+bool check_I2C() {
+    bool ok = true;
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        if (ads_health[device].state == ADS_HEALTH_OFFLINE) continue;
+
+        int result = ads1115_check_bus(&ads_devices[device]);
+        if (result == ADS1115_ERROR_TIMEOUT) {
+            recover_I2C();
+        }
+        if (result != ADS1115_OK) {
+            ok = false;
+        }
+        adc_states[device].waiting_for_switch = false;
+    }
+    return ok;
+}
+
 void init_PB() {
     for (int i = 0; i < NUM_PUSHBUTTONS; i++) {
         gpio_init(PB[i]);
@@ -204,109 +580,482 @@ void init_PB() {
     }
 }
 void init_ads() {
-    ads1115_init(I2C_PORT, ADS_1_ADDR, &ads1);
-    ads1115_init(I2C_PORT, ADS_2_ADDR, &ads2);
+    // An invalid map leaves an empty schedule: nothing is scanned, and
+    // sensor_channels in the stats is 0
+    if (!sensor_schedule_init(&sensor_schedule, sensor_map, NUM_SENSOR_CHANNELS)) {
+        return;
+    }
+
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        ads_health_init(&ads_health[device]);
+    }
+}
+
+// Bring the chips up one step per loop pass: probe each chip in turn, then
+// check the bus speed. Every step is a few short transfers, so tud_task()
+// keeps USB enumeration going in between instead of it waiting for all the
+// I2C traffic. Returns true once every step is done.
+bool boot_task() {
+    if (boot_device > sensor_schedule.num_devices) return true;
 
-    ads1115_set_pga(ADS1115_PGA_4_096, &ads1);
-    ads1115_set_data_rate(ADS1115_RATE_860_SPS, &ads1);
-    ads1115_set_operating_mode(ADS1115_MODE_CONTINUOUS, &ads1);
-    ads1115_set_pga(ADS1115_PGA_4_096, &ads2);
-    ads1115_set_data_rate(ADS1115_RATE_860_SPS, &ads2);
-    ads1115_set_operating_mode(ADS1115_MODE_CONTINUOUS, &ads2);
+    if (boot_device < sensor_schedule.num_devices) {
+        // A chip that doesn't answer starts out offline and is reprobed later
+        int device = boot_device++;
+        if (setup_ads(device) != ADS1115_OK) {
+            ads_health_offline(&ads_health[device], time_us_32());
+            sensor_schedule_set_active(&sensor_schedule, device, false);
+        }
+        return false;
+    }
+
+    boot_log_mark(&boot_log, BOOT_PHASE_ADS_PROBED, time_us_32());
+    set_I2C_speed(config->i2c_speed);
+    boot_log_mark(&boot_log, BOOT_PHASE_I2C_CHECKED, time_us_32());
+    boot_device++;
+    return true;
+}
+
+// The ALRT pins are open drain and active low
+void init_alerts() {
+    const uint pins[] = {ADS_1_ALRT, ADS_2_ALRT};
+    for (int i = 0; i < 2; i++) {
+        gpio_init(pins[i]);
+        gpio_set_dir(pins[i], GPIO_IN);
+        gpio_pull_up(pins[i]);
+    }
+    gpio_set_irq_enabled_with_callback(ADS_1_ALRT, GPIO_IRQ_EDGE_FALL, true, alert_callback);
+    gpio_set_irq_enabled(ADS_2_ALRT, GPIO_IRQ_EDGE_FALL, true);
+}
+
+// A comparator tripped. Only the first edge is timed until the main loop
+// has looked at it.
+void alert_callback(uint gpio, uint32_t events) {
+    (void) gpio;
+    (void) events;
+    if (!alert_pending) {
+        alert_time = time_us_32();
+        alert_pending = true;
+    }
+}
+
+// Sensors whose touch wakes the scan
+bool is_wake_channel(uint8_t channel) {
+    return sensor_map[channel].role == SENSOR_ROLE_FSR || sensor_map[channel].role == SENSOR_ROLE_SOFTPOT;
+}
+
+// Point a chip's comparator at its next touch sensor, with a window around
+// that sensor's last reading. Latching, so an edge is held until the
+// conversion is read, and two conversions outside the window to trip, so
+// the one still running on the previous input can't. A chip without touch
+// sensors goes to single-shot mode, which powers it down.
+int watch_next_channel(int device) {
+    ads1115_adc_t *ads = &ads_devices[device];
+    idle_watch_t *watch = &idle_watches[device];
+    uint8_t count = sensor_schedule.device_num_channels[device];
+
+    for (int i = 1; i <= count; i++) {
+        uint8_t slot = (watch->slot + i) % count;
+        uint8_t channel = sensor_schedule.device_channels[device][slot];
+        if (!is_wake_channel(channel)) continue;
+        if (channel == watch->channel) return ADS1115_OK; // The only one
+
+        watch->slot = slot;
+        watch->channel = channel;
+        idle_window(sensor_values[channel], config->idle_wake_margin, &watch->lo, &watch->hi);
+        int result = ads1115_set_thresholds(watch->lo, watch->hi, ads);
+        if (result != ADS1115_OK) return result;
+
+        const sensor_channel_t *entry = &sensor_map[channel];
+        ads1115_set_input_mux(entry->mux, ads);
+        ads1115_set_pga(entry->pga, ads);
+        ads1115_set_data_rate(entry->rate, ads);
+        ads1115_set_comparator_mode(ADS1115_COMPARATOR_WINDOW, ads);
+        ads1115_set_comparator_latching(ADS1115_COMPARATOR_LATCHING, ads);
+        ads1115_set_comparator_queue(ADS1115_COMPARATOR_QUE_2, ads);
+        return ads1115_write_config(ads);
+    }
+
+    ads1115_set_operating_mode(ADS1115_MODE_SINGLE_SHOT, ads);
+    return ads1115_write_config(ads);
+}
+
+// Stop the full-rate scan: arm every answering chip's comparator and let
+// the CPU sleep. If a chip can't be armed, keep scanning and try again
+// after another timeout.
+void enter_idle() {
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        uint8_t count = sensor_schedule.device_num_channels[device];
+        idle_watches[device] = (idle_watch_t){.channel = -1, .slot = count - 1};
+        if (ads_health[device].state == ADS_HEALTH_OFFLINE) continue;
+
+        if (!report_ads_result(device, watch_next_channel(device))) {
+            disarm_comparators();
+            idle_activity(&idle, time_us_32());
+            return;
+        }
+    }
+    idle_enter(&idle);
+    idle_tick = time_us_32();
+    sensors_ready = false;
+}
+
+// Comparators off and every chip back in continuous mode. Only the driver's
+// copy changes: the scanner's next channel switch writes it.
+void disarm_comparators() {
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        ads1115_adc_t *ads = &ads_devices[device];
+        ads1115_set_operating_mode(ADS1115_MODE_CONTINUOUS, ads);
+        ads1115_set_comparator_mode(ADS1115_COMPARATOR_TRADITIONAL, ads);
+        ads1115_set_comparator_latching(ADS1115_COMPARATOR_NONLATCHING, ads);
+        ads1115_set_comparator_queue(ADS1115_COMPARATOR_QUE_DISABLE, ads);
+        adc_states[device].waiting_for_switch = false;
+    }
+    sensor_schedule_restart(&sensor_schedule);
+}
+
+// Back to the full-rate scan. The wake-up is timed from start_us to the
+// end of the first full scan.
+void wake_from_idle(uint32_t start_us) {
+    disarm_comparators();
+    alert_pending = false;
+    idle_wake(&idle, start_us);
+}
+
+// Whether a watched sensor is really outside its window. Reading the
+// conversion also releases a latched ALRT. A chip that doesn't answer
+// counts as touched: the full scan deals with it.
+bool idle_touched() {
+    bool touched = false;
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        idle_watch_t *watch = &idle_watches[device];
+        if (watch->channel < 0 || ads_health[device].state == ADS_HEALTH_OFFLINE) continue;
+
+        uint16_t raw;
+        if (!report_ads_result(device, ads1115_read_adc(&raw, &ads_devices[device]))) {
+            return true;
+        }
+        int16_t value = (int16_t)raw;
+        if (value < watch->lo || value > watch->hi) {
+            touched = true;
+        }
+    }
+    return touched;
+}
+
+// While idle: wake on a confirmed touch or any button, otherwise move the
+// comparators on to their next touch sensor every IDLE_TICK_US
+void idle_task() {
+    uint32_t now = time_us_32();
+    if (alert_pending) {
+        uint32_t start = alert_time;
+        alert_pending = false;
+        if (idle_touched()) {
+            wake_from_idle(start);
+            return;
+        }
+        idle.false_alerts++;
+    }
+    for (int i = 0; i < NUM_PUSHBUTTONS; i++) {
+        if (buttons[i]) {
+            wake_from_idle(now);
+            return;
+        }
+    }
+
+    if (now - idle_tick < IDLE_TICK_US) return;
+    idle_tick = now;
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        if (idle_watches[device].channel < 0 || ads_health[device].state == ADS_HEALTH_OFFLINE) continue;
+        if (!report_ads_result(device, watch_next_channel(device))) {
+            wake_from_idle(now);
+            return;
+        }
+    }
 }
 
-void read_PB() {
+// Anything the player does keeps the full-rate scan going
+void HOT_PATH(update_idle)() {
+    uint32_t now = time_us_32();
+    bool playing = note_on || calibration.active || softpot_filtered >= config->softpot_touch_threshold;
+    for (int i = 0; i < NUM_PUSHBUTTONS; i++) {
+        playing |= buttons[i];
+    }
+    if (playing) {
+        idle_activity(&idle, now);
+    }
+    if (idle_due(&idle, now, config->idle_timeout_s * 1000000u)) {
+        enter_idle();
+    }
+}
+
+// Probe a chip and put it in continuous mode on the channel the scanner
+// starts with, comparator off. The register is written blind: the write's
+// acknowledge is the probe, and the scanner's first channel switch then
+// has nothing to change.
+int setup_ads(int device) {
+    adc_states[device].waiting_for_switch = false;
+    const sensor_channel_t *entry = &sensor_map[sensor_schedule_current(&sensor_schedule, device)];
+    uint16_t ads_config = entry->mux | entry->pga | entry->rate | ADS1115_MODE_CONTINUOUS |
+                          ADS1115_COMPARATOR_TRADITIONAL | ADS1115_COMPARATOR_POLARITY_LO |
+                          ADS1115_COMPARATOR_NONLATCHING | ADS1115_COMPARATOR_QUE_DISABLE;
+    return ads1115_init_config(I2C_PORT, sensor_schedule.addresses[device], ads_config,
+                               &ads_devices[device]);
+}
+
+// Feed a transfer result to the chip's health tracker. A timeout means the
+// bus itself may be stuck, so it is recovered first. Returns true on success.
+bool HOT_PATH(report_ads_result)(int device, int result) {
+    if (result >= 0) {
+        if (ads_health_success(&ads_health[device])) {
+            sensor_schedule_set_active(&sensor_schedule, device, true);
+        }
+        return true;
+    }
+
+    if (result == ADS1115_ERROR_TIMEOUT) {
+        recover_I2C();
+    }
+    if (ads_health_failure(&ads_health[device], time_us_32())) {
+        sensor_schedule_set_active(&sensor_schedule, device, false);
+        adc_states[device].waiting_for_switch = false;
+    }
+    return false;
+}
+
+void HOT_PATH(read_PB)() {
     for (int i = 0; i < 4; i++) {
         buttons[i] = gpio_get(PB[i]);
     }
 }
 
-bool read_ads_channels(ads1115_adc_t *ads, int16_t *adc_values, adc_state_t *state) {
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+bool HOT_PATH(read_ads_channels)(int device) {
+    ads1115_adc_t *ads = &ads_devices[device];
+    adc_state_t *state = &adc_states[device];
+    uint8_t channel = sensor_schedule_current(&sensor_schedule, device);
+    uint32_t current_time = time_us_32();
+
+    // An offline chip is only touched to reprobe it
+    if (ads_health[device].state == ADS_HEALTH_OFFLINE) {
+        if (ads_health_probe_due(&ads_health[device], current_time)) {
+            report_ads_result(device, setup_ads(device));
+        }
+        return false;
+    }
     
     // If we're waiting for a channel switch to settle
     if (state->waiting_for_switch) {
-        if (current_time - state->last_switch_time >= 3) {
-            // Channel has settled, read the ADC value
-            ads1115_read_adc(&adc_values[state->current_channel], ads);
+        if (current_time - state->last_switch_time >= state->settle_us) {
+            // Channel has settled, read the ADC value. On error, the
+            // channel keeps its last good value and is tried again.
+            uint16_t raw;
             state->waiting_for_switch = false;
-            state->current_channel++;
-            
-            // Check if we've read all channels
-            if (state->current_channel >= 4) {
-                state->current_channel = 0;
-                return true; // All channels read
+            if (!report_ads_result(device, ads1115_read_adc(&raw, ads))) {
+                return false;
             }
+            sensor_values[channel] = sensor_map_filter(&sensor_map[channel], sensor_values[channel], raw);
+            sensor_fresh |= 1u << channel;
+
+            // True once every chip has read all its channels
+            return sensor_schedule_advance(&sensor_schedule, device);
         }
-        return false; // Still waiting or not all channels read
+        return false; // Still waiting
     }
     
-    // Set up the next channel and start waiting
-    ads1115_set_input_mux(mux_configs[state->current_channel], ads);
-    ads1115_write_config(ads);
+    // Set up the next channel and start waiting. After a switch, the
+    // conversion in progress finishes on the old input, so wait for one more
+    // (plus 10% for the ADS1115 oscillator). The driver skips the write when
+    // the chip only has this one channel; then one fresh conversion will do.
+    const sensor_channel_t *entry = &sensor_map[channel];
+    uint32_t conversion_us = ads1115_conversion_us(entry->rate);
+    int switched = ads1115_select_channel(entry->mux, entry->pga, entry->rate, ads);
+    if (!report_ads_result(device, switched)) {
+        return false;
+    }
+    state->settle_us = ((switched ? 2 : 1) * conversion_us * 11) / 10;
     state->last_switch_time = current_time;
     state->waiting_for_switch = true;
     
     return false; // Channel switch initiated, need to wait
 }
 
+// Latest value of a mapped sensor, 0 if the role instance isn't mapped
+int16_t HOT_PATH(sensor_value)(sensor_role_t role, uint8_t index) {
+    int8_t channel = sensor_schedule_find(&sensor_schedule, role, index);
+    return channel < 0 ? 0 : sensor_values[channel];
+}
+
+bool HOT_PATH(sensor_mapped)(sensor_role_t role, uint8_t index) {
+    return sensor_schedule_find(&sensor_schedule, role, index) >= 0;
+}
+
+// Whether the sensor is mapped and its chip is answering
+bool HOT_PATH(sensor_available)(sensor_role_t role, uint8_t index) {
+    int8_t channel = sensor_schedule_find(&sensor_schedule, role, index);
+    return channel >= 0 && sensor_schedule_channel_active(&sensor_schedule, channel);
+}
+
+// Whether the sensor got a new reading on this loop pass
+bool HOT_PATH(sensor_updated)(sensor_role_t role, uint8_t index) {
+    int8_t channel = sensor_schedule_find(&sensor_schedule, role, index);
+    return channel >= 0 && (sensor_fresh & (1u << channel));
+}
+
 // Helper function to determine fret position from softpot value with hysteresis
-int16_t get_fret_from_softpot(int16_t softpot_value) {
-    // If softpot value is below minimum threshold, no fret is pressed
-    if (softpot_value < fret_positions[0]) {
-        current_fret = 0;
-        return 0; // Open string (fret 0)
+int16_t HOT_PATH(get_fret_from_softpot)(int16_t softpot_value) {
+    // Open string below the first fret position, highest fret above the last
+    current_fret = quantizer_update(&fret_quantizer, softpot_value);
+    return current_fret;
+}
+
+// Rebuild everything derived from fret_positions after the table changed
+void rebuild_fret_map() {
+    quantizer_build_table(&fret_table, config->fret_positions, CONFIG_NUM_FRET_POSITIONS);
+    quantizer_init(&fret_quantizer, config->fret_positions, CONFIG_NUM_FRET_POSITIONS,
+                   config->fret_hysteresis, &fret_table);
+    current_fret = -1;
+
+    // Deviation from the fret centre, clamped, to a bend around the centre
+    interp_map_scale_init(&fret_bend_scale, -config->softpot_deviation_max, config->softpot_deviation_max,
+                          0, PITCHBEND_CENTER, config->pitchbend_max_range, config->softpot_deviation_max);
+}
+
+// Rebuild the tuning and modulation quantisers from the configuration
+void rebuild_pot_maps() {
+    // Walk the steps of pot_to_tuning_offset() and record where each starts,
+    // so the quantiser reproduces it exactly apart from the hysteresis
+    int16_t num_edges = 0;
+    int16_t offset = pot_to_tuning_offset(config->tuning_min_value);
+    int32_t lo = config->tuning_min_value;
+    tuning_band_offsets[0] = offset;
+    while (num_edges < MAX_TUNING_EDGES && pot_to_tuning_offset(config->tuning_max_value) > offset) {
+        int32_t hi = config->tuning_max_value;
+        while (hi - lo > 1) {
+            int32_t mid = (lo + hi) / 2;
+            if (pot_to_tuning_offset(mid) > offset) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        offset = pot_to_tuning_offset(hi);
+        tuning_edges[num_edges++] = hi;
+        tuning_band_offsets[num_edges] = offset;
+        lo = hi;
     }
-    
-    // Find the raw fret position without hysteresis
-    int16_t raw_fret = 0;
-    for (int i = 0; i < 15; i++) {
-        if (softpot_value >= fret_positions[i] && softpot_value < fret_positions[i + 1]) {
-            raw_fret = i + 1; // Fret number (1-16)
-            break;
+    quantizer_build_table(&tuning_table, tuning_edges, num_edges);
+    quantizer_init(&tuning_quantizer, tuning_edges, num_edges, config->pot_hysteresis, &tuning_table);
+
+    // Modulation value k starts where raw * MODULATION_MAX / 32767 reaches k
+    for (int k = 1; k <= MODULATION_MAX; k++) {
+        modulation_edges[k - 1] = (k * 32767 + MODULATION_MAX - 1) / MODULATION_MAX;
+    }
+    quantizer_build_table(&modulation_table, modulation_edges, MODULATION_MAX);
+    quantizer_init(&modulation_quantizer, modulation_edges, MODULATION_MAX,
+                   config->pot_hysteresis, &modulation_table);
+    quantizer_init(&fx_quantizer, modulation_edges, MIDI_EFFECT_MAX,
+                   config->pot_hysteresis, &modulation_table);
+    quantizer_init(&expression_quantizer, modulation_edges, MODULATION_MAX,
+                   config->pot_hysteresis, &modulation_table);
+}
+
+// Rebuild the fixed FSR windows: fsr_min_value is full level, fsr_max_value
+// and above the minimum
+void rebuild_fsr_maps() {
+    int32_t span = config->fsr_max_value - config->fsr_min_value;
+    int16_t volume14_min = ump_scale_up(config->volume_min & 0x7F, 7, 14);
+    int16_t volume14_max = ump_scale_up(config->volume_max & 0x7F, 7, 14);
+
+    interp_map_scale_init(&volume_window, config->fsr_min_value, config->fsr_max_value, config->fsr_min_value,
+                          config->volume_max, config->volume_min - config->volume_max, span);
+    interp_map_scale_init(&volume14_window, config->fsr_min_value, config->fsr_max_value, config->fsr_min_value,
+                          volume14_max, volume14_min - volume14_max, span);
+}
+
+// Runs the fret map calibration mode. Returns true while calibrating, in
+// which case the normal interpretation is skipped.
+bool calibration_task() {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool all_pressed = buttons[0] && buttons[1] && buttons[2] && buttons[3];
+
+    if (!calibration.active) {
+        if (!all_pressed) {
+            calibration.hold_start = now;
+            return false;
         }
+        if (now - calibration.hold_start < CAL_HOLD_MS) {
+            return false;
+        }
+
+        // Enter calibration; the held keys must be released before capturing
+        calibration.active = true;
+        calibration.step = 0;
+        for (int i = 0; i < 4; i++) {
+            calibration.previous_buttons[i] = true;
+        }
+        fretcal_reset(&calibration.session);
+        current_note = -1;
+        calibration.status = CAL_STATUS_CAPTURING;
+        return true;
     }
-    
-    // If above maximum, use highest fret
-    if (raw_fret == 0) {
-        raw_fret = 16;
+
+    bool capture = buttons[0] && !calibration.previous_buttons[0];
+    bool abort = buttons[3] && !calibration.previous_buttons[3];
+    for (int i = 0; i < 4; i++) {
+        calibration.previous_buttons[i] = buttons[i];
     }
-    
-    // Apply hysteresis if we have a current fret
-    if (current_fret != -1) {
-        // Check if we're switching to an adjacent fret
-        if (abs(raw_fret - current_fret) == 1) {
-            // Apply hysteresis - need to cross threshold + hysteresis to switch
-            int boundary_index = (raw_fret > current_fret) ? raw_fret - 1 : current_fret - 1;
-            
-            if (boundary_index >= 0 && boundary_index < 15) {
-                int16_t threshold = fret_positions[boundary_index];
-                
-                if (raw_fret > current_fret) {
-                    // Moving up frets - need to exceed threshold + hysteresis
-                    if (softpot_value < threshold + FRET_HYSTERESIS) {
-                        return current_fret; // Stay on current fret
-                    }
-                } else {
-                    // Moving down frets - need to go below threshold - hysteresis
-                    if (softpot_value > threshold - FRET_HYSTERESIS) {
-                        return current_fret; // Stay on current fret
-                    }
-                }
-            }
+
+    // Sound the reference fret while key 1 is held so the player can check it
+    current_note = buttons[0] ? config->base_notes[0] + cal_ref_frets[calibration.step] : -1;
+
+    if (abort) {
+        calibration.status = CAL_STATUS_ABORTED;
+        calibration.active = false;
+        current_note = -1;
+        return true;
+    }
+    if (!capture) {
+        return true;
+    }
+
+    fretcal_add_sample(&calibration.session, cal_ref_frets[calibration.step], sensor_value(SENSOR_ROLE_SOFTPOT, 0));
+    calibration.step++;
+    if (calibration.step < NUM_CAL_REF_FRETS) {
+        return true;
+    }
+
+    // All reference frets captured: fit and regenerate the fret map
+    fretcal_fit_t fit;
+    stradex_config_t updated = *config;
+    if (fretcal_solve(&calibration.session, &fit) && fretcal_build_table(&fit, updated.fret_positions)
+        && config_check(&updated)) {
+        // Persist the new map and switch to the stored copy in place
+        const stradex_config_t *stored = config_store_write(&config_store, &updated);
+        if (stored) {
+            use_config(stored);
+            rebuild_fret_map();
+            calibration.status = CAL_STATUS_DONE;
+            calibration.rms_error = (uint32_t)fit.rms_error;
+        } else {
+            calibration.status = CAL_STATUS_NOT_STORED;
         }
+    } else {
+        calibration.status = CAL_STATUS_FAILED;
     }
-    
-    // Update and return new fret
-    current_fret = raw_fret;
-    return raw_fret;
+    calibration.active = false;
+    return true;
+}
+
+// Reference fret to touch next, 0 outside calibration
+uint32_t calibration_fret() {
+    return calibration.active ? cal_ref_frets[calibration.step] : 0;
 }
 
 // Main function to interpret sensor data and update MIDI state
-void interpret_midi_state() {
+void HOT_PATH(interpret_midi_state)() {
     // Reset current note
     current_note = -1;
     note_on = false;
+    current_string = -1;
     
     // Check which button is pressed (assuming only one at a time for monophonic)
     int pressed_button = -1;
@@ -319,58 +1068,94 @@ void interpret_midi_state() {
     
     // If no button is pressed, no note should play
     if (pressed_button == -1) {
+        held_fret = -1;
+        legato_bend_reset(&legato_bend);
         return;
     }
+    current_string = pressed_button;
     
     // Get the base note for the pressed button with tuning offset
-    int16_t base_note = base_notes[pressed_button] + tuning_offsets[pressed_button];
+    int16_t base_note = config->base_notes[pressed_button] + tuning_offsets[pressed_button];
     
     // Read FSR value for volume control based on which button is pressed
-    // FSR values are on ADS1 channels 0-3 corresponding to buttons 0-3
-    int16_t fsr_value = adc_values_1[pressed_button];
+    int16_t fsr_value = sensor_value(SENSOR_ROLE_FSR, pressed_button);
     
     // Convert FSR to MIDI volume and send if changed
-    current_volume = fsr_to_volume(fsr_value);
-    if (current_volume != previous_volume) {
+    current_volume = fsr_to_volume(fsr_value, pressed_button);
+    if (cc14_enabled(CC14_VOLUME)) {
+        int16_t volume14 = fsr_to_level(fsr_value, pressed_button,
+                                        ump_scale_up(config->volume_min & 0x7F, 7, 14),
+                                        ump_scale_up(config->volume_max & 0x7F, 7, 14), &volume14_window);
+        send_cc14(CC14_VOLUME, 0x07, volume14, sensor_updated(SENSOR_ROLE_FSR, pressed_button));
+        previous_volume = current_volume;
+    } else if (current_volume != previous_volume) {
         send_volume_control(current_volume);
         previous_volume = current_volume;
     }
     
-    // Determine which ADC channel corresponds to the softpot for this string
-    // Assuming adc_values_2[0] is the softpot for now (you may need to adjust this)
-    int16_t softpot_value = adc_values_2[0];
-    
-    // Get fret position from softpot
-    int16_t fret = get_fret_from_softpot(softpot_value);
+    // Softpot 0 is the fingerboard for every string. Release sweeps and
+    // glitches are already removed by update_softpot()
+    int16_t softpot_value = softpot_filtered;
+
+    // Between sparse samples, a detected vibrato can be replaced by a smooth
+    // sine of the same rate and depth. With the softpot's chip offline the
+    // last good position is held still instead.
+    if (!sensor_available(SENSOR_ROLE_SOFTPOT, 0)) {
+        vibrato_reset(&vibrato, softpot_value);
+    } else if (config->vibrato_resynth && vibrato.active) {
+        softpot_value = vibrato_resynth(&vibrato, time_us_32());
+    }
     
-    // Calculate pitch bend based on softpot deviation from fret center
-    // Skip pitch bend for open strings (fret 0)
+    int16_t fret;
     int16_t pitch_bend = PITCHBEND_CENTER; // Default to center (no bend)
-    if (fret > 0) {
-        pitch_bend = calculate_pitch_bend(softpot_value, fret);
+    if (config->play_mode == PLAY_MODE_GLIDE) {
+        // Fretless: hold one note for the slide and carry the pitch as bend
+        fret = get_glide_fret_and_bend(softpot_value, &pitch_bend);
+    } else {
+        // Get fret position from softpot
+        fret = get_fret_from_softpot(softpot_value);
+
+        // Calculate pitch bend based on softpot deviation from fret center
+        // Skip pitch bend for open strings (fret 0)
+        if (fret > 0) {
+            pitch_bend = calculate_pitch_bend(softpot_value, fret);
+        }
+
+        // Legato bend mode: keep the held note and move to the new fret by bend
+        if (config->legato_mode == LEGATO_BEND) {
+            fret = legato_bend_update(&legato_bend, pressed_button, fret, &pitch_bend,
+                                      config->glide_bend_range);
+        }
+
+        // Count frets too short to have been played, once per sample
+        if (sensor_updated(SENSOR_ROLE_SOFTPOT, 0)) {
+            softpot_filter_fret(&softpot_filter, fret);
+        }
     }
     
+    // Emit intermediate bends at a steady rate between softpot samples
+    if (config->bend_interp_mode != BEND_INTERP_OFF) {
+        pitch_bend = interpolate_pitch_bend(pitch_bend, base_note + fret != previous_note);
+    }
+
     // Send pitch bend if changed
     if (pitch_bend != current_pitchbend) {
         send_pitch_bend(pitch_bend);
         current_pitchbend = pitch_bend;
     }
     
-    // Read modulation control from ADS2 channel 2
-    int16_t modulation_raw = adc_values_2[1]; // Channel 2 (0-indexed)
-    current_modulation = (modulation_raw * MODULATION_MAX) / 32767; // Scale to 0-127
-    if (current_modulation != previous_modulation) {
-        send_modulation_control(current_modulation);
-        previous_modulation = current_modulation;
-    }
-    
-    // Read tuning control from ADS2 channel 4 and update tuning offsets
-    int16_t tuning_raw = adc_values_2[3]; // Channel 4 (0-indexed)
-    int16_t new_tuning_offset = pot_to_tuning_offset(tuning_raw);
-    
-    // Update all string tunings (could be made per-string if needed)
-    for (int i = 0; i < 4; i++) {
-        tuning_offsets[i] = new_tuning_offset;
+    update_pot_controls();
+    send_vibrato_controls();
+
+    // Read tuning control and update tuning offsets
+    if (sensor_mapped(SENSOR_ROLE_TUNING, 0)) {
+        int16_t tuning_raw = sensor_value(SENSOR_ROLE_TUNING, 0);
+        int16_t new_tuning_offset = tuning_band_offsets[quantizer_update(&tuning_quantizer, tuning_raw)];
+
+        // Update all string tunings (could be made per-string if needed)
+        for (int i = 0; i < 4; i++) {
+            tuning_offsets[i] = new_tuning_offset;
+        }
     }
     
     // Calculate final MIDI note (base note + fret offset)
@@ -378,157 +1163,571 @@ void interpret_midi_state() {
     note_on = true;
 }
 
-void send_note_on(int16_t note) {
-    if (!tud_midi_mounted()) return;
+// Send the 0-127 controller pots that are present in the sensor map. If a
+// pot's chip goes offline, its controller returns to neutral rather than
+// staying wherever the last reading left it.
+void HOT_PATH(update_pot_controls)() {
+    if (sensor_mapped(SENSOR_ROLE_MODULATION, 0) && cc14_enabled(CC14_MODULATION)) {
+        current_modulation = update_pot_cc14(CC14_MODULATION, SENSOR_ROLE_MODULATION, 0x01, MODULATION_MIN);
+        previous_modulation = current_modulation;
+    } else if (sensor_mapped(SENSOR_ROLE_MODULATION, 0)) {
+        current_modulation = MODULATION_MIN;
+        if (sensor_available(SENSOR_ROLE_MODULATION, 0)) {
+            int16_t modulation_raw = sensor_value(SENSOR_ROLE_MODULATION, 0);
+            current_modulation = quantizer_update(&modulation_quantizer, modulation_raw); // Scale to 0-127
+        }
+        if (current_modulation != previous_modulation) {
+            send_modulation_control(current_modulation);
+            previous_modulation = current_modulation;
+        }
+    }
+
+    if (sensor_mapped(SENSOR_ROLE_FX, 0) && cc14_enabled(CC14_FX)) {
+        previous_fx = update_pot_cc14(CC14_FX, SENSOR_ROLE_FX, 0x02, MIDI_EFFECT_MIN);
+    } else if (sensor_mapped(SENSOR_ROLE_FX, 0)) {
+        int16_t fx = MIDI_EFFECT_MIN;
+        if (sensor_available(SENSOR_ROLE_FX, 0)) {
+            fx = quantizer_update(&fx_quantizer, sensor_value(SENSOR_ROLE_FX, 0));
+        }
+        if (fx != previous_fx) {
+            send_midifx_control(fx);
+            previous_fx = fx;
+        }
+    }
 
-    const uint8_t vel = 100;
-    uint8_t msg[3];
-    
-    msg[0] = 0x90; // Note On
-    msg[1] = note;
-    msg[2] = vel;
-    
-    tud_midi_stream_write(0, msg, 3);
+    if (sensor_mapped(SENSOR_ROLE_EXPRESSION, 0) && cc14_enabled(CC14_EXPRESSION)) {
+        previous_expression = update_pot_cc14(CC14_EXPRESSION, SENSOR_ROLE_EXPRESSION, 0x0B, MIDI_EFFECT_MAX);
+    } else if (sensor_mapped(SENSOR_ROLE_EXPRESSION, 0)) {
+        int16_t expression = MIDI_EFFECT_MAX;
+        if (sensor_available(SENSOR_ROLE_EXPRESSION, 0)) {
+            expression = quantizer_update(&expression_quantizer, sensor_value(SENSOR_ROLE_EXPRESSION, 0));
+        }
+        if (expression != previous_expression) {
+            send_control_change(0x0B, expression); // CC11 (Expression)
+            previous_expression = expression;
+        }
+    }
 }
 
-void send_note_off(int16_t note) {
-    if (!tud_midi_mounted()) return;
+// Send a pot as a 14-bit controller: the full reading range, or the
+// neutral 0-127 value while its chip is offline. Returns the 7-bit value.
+int16_t HOT_PATH(update_pot_cc14)(int controller, sensor_role_t role, uint8_t cc, int16_t neutral) {
+    int16_t value = ump_scale_up(neutral, 7, 14);
+    bool fresh = false;
+    if (sensor_available(role, 0)) {
+        int16_t raw = sensor_value(role, 0);
+        value = raw < 0 ? 0 : raw >> 1;
+        fresh = sensor_updated(role, 0);
+    }
+    send_cc14(controller, cc, value, fresh);
+    return value >> 7;
+}
 
-    uint8_t msg[3];
-    
-    msg[0] = 0x80; // Note Off
-    msg[1] = note;
-    msg[2] = 0;
-    
-    tud_midi_stream_write(0, msg, 3);
+bool HOT_PATH(cc14_enabled)(int controller) {
+    return (config->cc14_controllers >> controller) & 1;
+}
+
+// Send a 14-bit controller once it moves past its noise deadband
+void HOT_PATH(send_cc14)(int controller, uint8_t cc, int16_t value, bool fresh) {
+    cc14_t *state = &cc14_states[controller];
+    int16_t previous = state->sent;
+    if (cc14_update(state, value, fresh, config->cc14_noise_gain)) {
+        send_control_change14(cc, state->sent, previous);
+    }
+}
+
+// Send note changes. In legato modes a note-to-note change sends the new note
+// on before the old note off, so mono synths glide instead of re-attacking.
+void HOT_PATH(update_note_output)() {
+    legato_event_t events[LEGATO_MAX_EVENTS];
+    uint8_t count = legato_note_change(config->legato_mode, config->legato_velocity, NOTE_VELOCITY,
+                                       previous_note, current_note, &current_velocity, events);
+    for (int i = 0; i < count; i++) {
+        if (events[i].type == LEGATO_NOTE_ON) {
+            send_note_on(events[i].note, events[i].velocity);
+        } else {
+            send_note_off(events[i].note);
+        }
+    }
+    previous_note = current_note;
+}
+
+// Note on, built as a MIDI 2.0 UMP like every channel message so a UMP
+// transport can be added under midi_out.h without touching the callers. For
+// now midi_out translates it to MIDI 1.0, which keeps the top 7 bits of the
+// velocity and drops the pitch attribute; both only matter once a host can
+// receive UMPs.
+void HOT_PATH(send_note_on)(int16_t note, int16_t velocity) {
+    if (!midi_out_connected()) return;
+
+    ump_t packet;
+    ump_note_on(&packet, MIDI_GROUP, MIDI_CHANNEL, note, ump_scale_up(velocity & 0x7F, 7, 16),
+                UMP_ATTRIBUTE_PITCH_7_9, (note & 0x7F) << 9);
+    midi_out_ump(&packet);
+}
+
+void HOT_PATH(send_note_off)(int16_t note) {
+    if (!midi_out_connected()) return;
+
+    ump_t packet;
+    ump_note_off(&packet, MIDI_GROUP, MIDI_CHANNEL, note, 0);
+    midi_out_ump(&packet);
+}
+
+// Track each key's rest and peak pressure readings
+void HOT_PATH(update_fsr_ranges)() {
+    if (config->fsr_adapt_shift == 0) return;
+
+    for (int i = 0; i < 4; i++) {
+        if (sensor_updated(SENSOR_ROLE_FSR, i)) {
+            autorange_update(&fsr_ranges[i], sensor_value(SENSOR_ROLE_FSR, i), buttons[i],
+                             config->fsr_adapt_shift, config->fsr_min_value);
+        }
+    }
 }
 
 // Convert FSR value to MIDI volume (0-127)
-// FSR is inverse: higher FSR values = lower volume
-int16_t fsr_to_volume(int16_t fsr_value) {
-    if (fsr_value < FSR_MIN_VALUE) {
-        return VOLUME_MAX; // Maximum volume
-    } else if (fsr_value > FSR_MAX_VALUE) {
-        return VOLUME_MIN; // Minimum volume
-    } else {
-        // Linear interpolation between FSR_MIN_VALUE and FSR_MAX_VALUE
-        // Map FSR_MIN_VALUE->VOLUME_MAX and FSR_MAX_VALUE->VOLUME_MIN
-        int16_t fsr_range = FSR_MAX_VALUE - FSR_MIN_VALUE;
-        int16_t fsr_offset = fsr_value - FSR_MIN_VALUE;
-        int16_t volume = VOLUME_MAX - ((fsr_offset * (VOLUME_MAX - VOLUME_MIN)) / fsr_range);
-        return volume;
+int16_t HOT_PATH(fsr_to_volume)(int16_t fsr_value, int key) {
+    return fsr_to_level(fsr_value, key, config->volume_min, config->volume_max, &volume_window);
+}
+
+// Convert FSR value to a level between level_min and level_max
+// FSR is inverse: higher FSR values = lower level. window is the same range
+// over the fixed window, see rebuild_fsr_maps()
+int16_t HOT_PATH(fsr_to_level)(int16_t fsr_value, int key, int16_t level_min, int16_t level_max,
+                               const interp_map_scale_t *window) {
+    // Adaptive ranging: rescale between this key's own rest and peak readings
+    if (config->fsr_adapt_shift != 0) {
+        return autorange_scale(&fsr_ranges[key], fsr_value, level_min, level_max);
     }
+
+    // Fixed window: fsr_min_value->level_max and fsr_max_value->level_min
+    return interp_map_scale(window, fsr_value);
 }
 
 // Send MIDI volume control change (CC7)
-void send_volume_control(int16_t volume) {
-    if (!tud_midi_mounted()) return;
-
-    uint8_t msg[3];
-    
-    msg[0] = 0xB0; // Control Change on channel 1
-    msg[1] = 0x07; // CC7 (Main Volume)
-    msg[2] = volume & 0x7F; // Ensure 7-bit value
-    
-    tud_midi_stream_write(0, msg, 3);
+void HOT_PATH(send_volume_control)(int16_t volume) {
+    send_control_change(0x07, volume); // CC7 (Main Volume)
 }
 
 // Calculate pitch bend based on softpot deviation from fret center
-int16_t calculate_pitch_bend(int16_t softpot_value, int16_t fret_position) {
-    // Find the fret boundaries for the current fret
-    int16_t fret_start, fret_end;
-    
-    if (fret_position == 0) {
-        // Open string - use first fret as reference
-        fret_start = 0;
-        fret_end = fret_positions[0];
-    } else if (fret_position >= 16) {
-        // Beyond last fret - use last fret boundaries
-        fret_start = fret_positions[15];
-        fret_end = fret_positions[16];
-    } else {
-        // Normal fret - use current and next fret positions
-        fret_start = fret_positions[fret_position - 1];
-        fret_end = fret_positions[fret_position];
+int16_t HOT_PATH(calculate_pitch_bend)(int16_t softpot_value, int16_t fret_position) {
+    // Same result as pitchmap_fret_bend(), without a division per reading
+    int32_t center = pitchmap_fret_center(config->fret_positions, CONFIG_NUM_FRET_POSITIONS, fret_position);
+    return interp_map_scale(&fret_bend_scale, softpot_value - center);
+}
+
+// Glide mode: map the softpot to a fractional fret and express it as a bend
+// around the held note. The note is only retriggered when the slide leaves
+// the announced bend range.
+int16_t HOT_PATH(get_glide_fret_and_bend)(int16_t softpot_value, int16_t *pitch_bend) {
+    int32_t pitch = pitchmap_fractional_fret(config->fret_positions, CONFIG_NUM_FRET_POSITIONS, softpot_value);
+    int32_t bend = -1;
+
+    if (held_fret != -1) {
+        bend = pitchmap_bend(pitch - held_fret * PITCHMAP_ONE, config->glide_bend_range);
     }
-    
-    // Calculate center position between fret boundaries
-    int16_t fret_center = (fret_start + fret_end) / 2;
-    
-    // Calculate deviation from center
-    int16_t deviation = softpot_value - fret_center;
-    
-    // Limit deviation to maximum range
-    if (deviation > SOFTPOT_DEVIATION_MAX) {
-        deviation = SOFTPOT_DEVIATION_MAX;
-    } else if (deviation < -SOFTPOT_DEVIATION_MAX) {
-        deviation = -SOFTPOT_DEVIATION_MAX;
+    if (bend < 0) {
+        // New slide, or out of range: retrigger on the nearest fret
+        held_fret = (pitch + PITCHMAP_ONE / 2) >> PITCHMAP_FRAC_BITS;
+        bend = pitchmap_bend(pitch - held_fret * PITCHMAP_ONE, config->glide_bend_range);
     }
-    
-    // Convert deviation to pitch bend value
-    // Scale deviation to pitch bend range and add to center
-    int16_t pitch_bend = PITCHBEND_CENTER + ((deviation * PITCHBEND_MAX_RANGE) / SOFTPOT_DEVIATION_MAX);
-    
-    return pitch_bend;
+
+    *pitch_bend = bend;
+    return held_fret;
+}
+
+// Turn the sparse per-sample bend into a steady stream of interpolated
+// values, one per bend_interp_us at most. A new note jumps straight to its
+// bend; an unchanged target settles and stops producing messages.
+int16_t HOT_PATH(interpolate_pitch_bend)(int16_t pitch_bend, bool new_note) {
+    uint32_t now = time_us_32();
+
+    if (new_note) {
+        bend_interp_reset(&bend_interp, pitch_bend, now);
+        bend_target = pitch_bend;
+        last_bend_output_us = now;
+        return pitch_bend;
+    }
+    if (pitch_bend != bend_target) {
+        bend_interp_push(&bend_interp, config->bend_interp_mode, pitch_bend, now);
+        bend_target = pitch_bend;
+    }
+
+    if (now - last_bend_output_us < config->bend_interp_us) {
+        return current_pitchbend; // Not due yet, leave the last value standing
+    }
+    last_bend_output_us = now;
+    return bend_interp_output(&bend_interp, config->bend_interp_mode, now);
+}
+
+// Whether the receiver has been told the glide bend range, or keeps its
+// default of 2 semitones
+bool HOT_PATH(uses_bend_range)() {
+    return config->play_mode == PLAY_MODE_GLIDE || config->legato_mode == LEGATO_BEND;
+}
+
+// Announce the glide bend range with RPN 0 when the output is connected, when
+// the host mounts and whenever it changes
+void HOT_PATH(update_bend_range)() {
+    if (tud_midi_mounted() != bend_range_host) {
+        bend_range_host = tud_midi_mounted();
+        sent_bend_range = 0;
+    }
+    if (!midi_out_connected()) return;
+
+    if (uses_bend_range() && sent_bend_range != config->glide_bend_range) {
+        send_bend_range(config->glide_bend_range);
+        sent_bend_range = config->glide_bend_range;
+    }
+}
+
+// Send RPN 0 (pitch bend sensitivity): semitones in the top 7 bits, cents
+// in the next 7. As MIDI 1.0 it is followed by the null RPN so later data entry
+// messages can't change it by accident.
+void HOT_PATH(send_bend_range)(int16_t semitones) {
+    ump_t packet;
+    ump_registered_controller(&packet, MIDI_GROUP, MIDI_CHANNEL, 0x00, 0x00, (uint32_t)(semitones & 0x7F) << 25);
+    midi_out_ump(&packet);
 }
 
 // Send MIDI pitch bend message
-void send_pitch_bend(int16_t pitch_bend_value) {
-    if (!tud_midi_mounted()) return;
+void HOT_PATH(send_pitch_bend)(int16_t pitch_bend_value) {
+    if (!midi_out_connected()) return;
 
     // Ensure pitch bend value is within 14-bit range (0-16383)
     if (pitch_bend_value < 0) pitch_bend_value = 0;
     if (pitch_bend_value > 16383) pitch_bend_value = 16383;
     
-    uint8_t msg[3];
-    
-    msg[0] = 0xE0; // Pitch Bend on channel 1
-    msg[1] = pitch_bend_value & 0x7F;        // LSB (7 bits)
-    msg[2] = (pitch_bend_value >> 7) & 0x7F; // MSB (7 bits)
-    
-    tud_midi_stream_write(0, msg, 3);
+    ump_t packet;
+    ump_pitch_bend(&packet, MIDI_GROUP, MIDI_CHANNEL, ump_scale_up(pitch_bend_value, 14, 32));
+    midi_out_ump(&packet);
 }
 
 // Convert potentiometer value to tuning offset in semitones
 int16_t pot_to_tuning_offset(int16_t pot_value) {
-    // Map potentiometer range to ±12 semitones
-    if (pot_value < TUNING_MIN_VALUE) pot_value = TUNING_MIN_VALUE;
-    if (pot_value > TUNING_MAX_VALUE) pot_value = TUNING_MAX_VALUE;
-    
-    // Calculate offset from center
-    int32_t offset_from_center = pot_value - TUNING_CENTER_VALUE;
-    
-    // Scale to ±12 semitones
-    int16_t tuning_offset = (offset_from_center * TUNING_RANGE) / (TUNING_MAX_VALUE / 2);
-    
-    // Clamp to valid range
-    if (tuning_offset > TUNING_RANGE) tuning_offset = TUNING_RANGE;
-    if (tuning_offset < -TUNING_RANGE) tuning_offset = -TUNING_RANGE;
-    
-    return tuning_offset;
+    // Map potentiometer range to ±tuning_range semitones
+    return pitchmap_tuning_offset(pot_value, config->tuning_min_value, config->tuning_max_value,
+                                  config->tuning_center_value, config->tuning_range);
 }
 
 // Send MIDI modulation control change (CC1)
-void send_modulation_control(int16_t modulation) {
-    if (!tud_midi_mounted()) return;
+void HOT_PATH(send_modulation_control)(int16_t modulation) {
+    send_control_change(0x01, modulation); // CC1 (Modulation)
+}
 
-    uint8_t msg[3];
-    
-    msg[0] = 0xB0; // Control Change on channel 1
-    msg[1] = 0x01; // CC1 (Modulation)
-    msg[2] = modulation & 0x7F; // Ensure 7-bit value
-    
-    tud_midi_stream_write(0, msg, 3);
+void HOT_PATH(send_midifx_control)(int16_t midifx) {
+    send_control_change(0x02, midifx);
+}
+
+// Bow the sounding string with the key pressure at the played note and bend.
+// The other strings are lifted and ring out at their last pitch.
+void HOT_PATH(update_synth)() {
+    for (int i = 0; i < SYNTH_NUM_VOICES; i++) {
+        synth_params.pressure[i] = 0;
+    }
+    if (note_on && current_string >= 0 && current_string < SYNTH_NUM_VOICES) {
+        int32_t range = uses_bend_range() ? config->glide_bend_range : PITCHMAP_DEFAULT_BEND_RANGE;
+        int32_t bend = ((int32_t)(current_pitchbend - PITCHBEND_CENTER) * range * SYNTH_PITCH_ONE) / PITCHBEND_CENTER;
+        synth_params.pitch[current_string] = current_note * SYNTH_PITCH_ONE + bend;
+        synth_params.pressure[current_string] = current_volume;
+    }
+    synth_params.modulation = current_modulation;
+    synth_audio_update(&synth_params);
+}
+
+// Send one of the slow counter frames, returns true if it went out
+static bool send_slow_telemetry(uint8_t slot) {
+    if (slot == 0) {
+        telemetry_idle_frame_t idle_frame = {
+            .entries = idle.entries,
+            .wakes = idle.wakes,
+            .false_alerts = idle.false_alerts,
+            .wake_us_last = idle.wake_us_last,
+            .wake_us_max = idle.wake_us_max
+        };
+        return telemetry_send(TELEMETRY_FRAME_IDLE, &idle_frame, sizeof(idle_frame));
+    }
+    if (slot == 1) {
+        const serial_midi_stats_t *serial_stats = midi_uart_get_stats();
+        telemetry_serial_midi_frame_t serial_midi = {
+            .messages = serial_stats->messages,
+            .bytes = serial_stats->bytes,
+            .status_saved = serial_stats->status_saved,
+            .cc_held = serial_stats->cc_held,
+            .cc_replaced = serial_stats->cc_replaced,
+            .dropped_bytes = serial_stats->dropped_bytes
+        };
+        return telemetry_send(TELEMETRY_FRAME_SERIAL_MIDI, &serial_midi, sizeof(serial_midi));
+    }
+    if (slot == 3) {
+        telemetry_softpot_frame_t softpot = {
+            .held_samples = softpot_filter.held_samples,
+            .releases = softpot_filter.releases,
+            .spurious_changes = softpot_filter.spurious_changes
+        };
+        return telemetry_send(TELEMETRY_FRAME_SOFTPOT, &softpot, sizeof(softpot));
+    }
+    telemetry_calibration_frame_t cal = {
+        .status = calibration.status,
+        .step = calibration.step,
+        .fret = calibration_fret(),
+        .rms_error = calibration.rms_error
+    };
+    return telemetry_send(TELEMETRY_FRAME_CALIBRATION, &cal, sizeof(cal));
+}
+
+// Send the boot timings if a phase has been reached since they last went
+// out. Returns true if the frame was due, whether or not it fit.
+static bool send_boot_telemetry() {
+    uint32_t phases = boot_log_phases(&boot_log);
+    if (phases == boot_phases_reported) return false;
+
+    telemetry_boot_frame_t boot = {.boots = boot_log.boots};
+    for (int i = 0; i < BOOT_NUM_PHASES; i++) {
+        boot.phase_us[i] = boot_log.phase_us[i];
+        boot.previous_us[i] = boot_log.previous_us[i];
+    }
+    if (telemetry_send(TELEMETRY_FRAME_BOOT, &boot, sizeof(boot))) {
+        boot_phases_reported = phases;
+    }
+    return true;
 }
 
-void send_midifx_control(int16_t midifx) {
-    if (!tud_midi_mounted()) return;
+void send_telemetry() {
+    // The boot timings go out once, and again whenever a later phase (the
+    // first MIDI message, say) has been reached. They take a period of their
+    // own until they are queued, so the periodic frames can't crowd them out.
+    if (send_boot_telemetry()) return;
+
+    telemetry_sensor_frame_t sensors;
+    for (int i = 0; i < 8; i++) {
+        sensors.raw[i] = i < NUM_SENSOR_CHANNELS ? sensor_values[i] : 0;
+    }
+    sensors.softpot_filtered = softpot_filtered;
+    sensors.buttons = 0;
+    for (int i = 0; i < 4; i++) {
+        sensors.buttons |= buttons[i] << i;
+    }
+    sensors.fret = current_fret;
+    sensors.note = current_note;
+    sensors.pitch_bend = current_pitchbend;
+    sensors.volume = current_volume;
+    sensors.modulation = current_modulation;
+    sensors.tuning_offset = tuning_offsets[0];
+    telemetry_send(TELEMETRY_FRAME_SENSORS, &sensors, sizeof(sensors));
+
+    if (telemetry_send(TELEMETRY_FRAME_PROFILE, &loop_profile, sizeof(loop_profile))) {
+        loop_profile = (telemetry_profile_frame_t){0};
+    }
+
+    telemetry_xip_frame_t xip = {.pass_misses_max = xip_profile.pass_misses_max};
+    for (int i = 0; i < XIP_NUM_STAGES; i++) {
+        xip.accesses[i] = xip_profile.accesses[i];
+        xip.misses[i] = xip_profile.misses[i];
+        xip.misses_max[i] = xip_profile.misses_max[i];
+    }
+    if (telemetry_send(TELEMETRY_FRAME_XIP, &xip, sizeof(xip))) {
+        xip_profile_clear(&xip_profile);
+    }
+
+    const midi_out_stats_t *midi_stats = midi_out_get_stats();
+    telemetry_midi_frame_t midi = {
+        .messages = midi_stats->messages,
+        .bytes = midi_stats->bytes,
+        .dropped_bytes = midi_stats->dropped_bytes,
+        .unmounted = midi_stats->unmounted
+    };
+    telemetry_send(TELEMETRY_FRAME_MIDI, &midi, sizeof(midi));
+
+    // The slow counters take turns, one per period, so a period's frames
+    // fit in the vendor FIFO together (TELEMETRY_PERIOD_BYTES)
+    if (send_slow_telemetry(telemetry_slow_frame)) {
+        telemetry_slow_frame = (telemetry_slow_frame + 1) % TELEMETRY_NUM_SLOW_FRAMES;
+    }
+}
 
-    uint8_t msg[3];
+// Switch to a stored configuration, copied into SRAM in the SRAM build
+void use_config(const stradex_config_t *stored) {
+#if STRADEX_SRAM_HOT_PATH
+    config_ram = *stored;
+    config = &config_ram;
+#else
+    config = stored;
+#endif
+}
 
-    msg[0] = 0xB0;
-    msg[1] = 0x02;
-    msg[2] = midifx & 0x7F;
+static void sysex_reply(const uint8_t *msg, uint32_t len) {
+    midi_out_write(msg, len);
+}
 
-    tud_midi_stream_write(0, msg, 3);
-}
\ No newline at end of file
+static bool sysex_store(const stradex_config_t *cfg) {
+    return config_store_write(&config_store, cfg) != NULL;
+}
+
+// Health state of each chip, two bits per chip in sensor map order
+static uint32_t ads_health_states() {
+    uint32_t states = 0;
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        states |= (uint32_t)ads_health[device].state << (device * 2);
+    }
+    return states;
+}
+
+// Times any chip went offline, including not answering at boot
+static uint32_t ads_offline_events() {
+    uint32_t events = 0;
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        events += ads_health[device].offline_events;
+    }
+    return events;
+}
+
+// Times an offline chip answered a reprobe
+static uint32_t ads_reconnects() {
+    uint32_t reconnects = 0;
+    for (int device = 0; device < sensor_schedule.num_devices; device++) {
+        reconnects += ads_health[device].reconnects;
+    }
+    return reconnects;
+}
+
+static uint8_t sysex_stats(uint32_t *counters, uint8_t max_counters) {
+    const midi_out_stats_t *midi_stats = midi_out_get_stats();
+    uint32_t values[] = {
+        midi_stats->messages,
+        midi_stats->bytes,
+        midi_stats->dropped_bytes,
+        midi_stats->unmounted,
+        loop_profile.loops,
+        loop_profile.loop_us_max,
+        loop_profile.scans_completed,
+        softpot_filter.held_samples,
+        softpot_filter.releases,
+        ads1115_get_stats()->transactions,
+        ads1115_get_stats()->bytes,
+        ads1115_get_stats()->errors,
+        i2c_bus_recoveries,
+        ads_health_states(),
+        ads1115_get_stats()->bus_us,
+        last_scan_us,
+        i2c_baudrate,
+        synth_audio_get_stats()->underruns,
+        synth_audio_get_stats()->render_cycles_max,
+        midi_stats->ump_bytes,
+        xip_profile.pass_misses_max,
+        boot_log.phase_us[BOOT_PHASE_FIRST_SCAN],
+        boot_log.phase_us[BOOT_PHASE_MOUNTED],
+        idle.wake_us_max,
+        midi_stats->dropped_replies,
+        i2c_speed_stepdowns,
+        calibration.status,
+        calibration_fret(),
+        calibration.rms_error,
+        sensor_schedule.num_channels,
+        ads_offline_events(),
+        ads_reconnects(),
+        boot_log_phases(&boot_log) & ~boot_phases_reported,
+        softpot_filter.spurious_changes
+    };
+    uint8_t count = sizeof(values) / sizeof(values[0]);
+    if (count > max_counters) count = max_counters;
+
+    for (int i = 0; i < count; i++) {
+        counters[i] = values[i];
+    }
+    return count;
+}
+
+static const sysex_hooks_t sysex_hooks = {
+    .reply = sysex_reply,
+    .store = sysex_store,
+    .stats = sysex_stats
+};
+
+// Read incoming MIDI and handle any complete SysEx message
+void sysex_task() {
+    uint8_t buffer[64];
+    uint32_t count;
+
+    while (tud_midi_available() && (count = tud_midi_stream_read(buffer, sizeof(buffer))) > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (sysex_parse(&sysex_parser, buffer[i])) {
+                sysex_handle(&sysex_parser, &sysex_hooks);
+            }
+        }
+    }
+}
+
+// Filter each new softpot sample: hold the last valid reading across a
+// finger lift, then switch cleanly to the open string
+void HOT_PATH(update_softpot)() {
+    int8_t channel = sensor_schedule_find(&sensor_schedule, SENSOR_ROLE_SOFTPOT, 0);
+    if (config->softpot_max_slew == 0 || sensor_map[channel].filter != SENSOR_FILTER_RELEASE) {
+        softpot_filtered = sensor_values[channel];
+        return;
+    }
+    softpot_filtered = softpot_filter_update(&softpot_filter, sensor_values[channel],
+                                             config->softpot_touch_threshold,
+                                             config->softpot_max_slew);
+}
+
+// Feed each new softpot sample to the vibrato detector
+void HOT_PATH(update_vibrato)() {
+    int16_t softpot_value = softpot_filtered;
+
+    if (softpot_value < config->fret_positions[0]) {
+        vibrato_reset(&vibrato, softpot_value); // Not touched
+    } else {
+        vibrato_update(&vibrato, softpot_value, time_us_32());
+    }
+}
+
+// Send the detected vibrato rate (3-10 Hz) and depth as CCs if mapped
+void HOT_PATH(send_vibrato_controls)() {
+    if (config->vibrato_rate_cc != 0) {
+        int32_t rate = vibrato_rate_q8(&vibrato);
+        int16_t value = 0;
+        if (rate > 3 * 256) {
+            value = ((rate - 3 * 256) * 127) / (7 * 256);
+            if (value > 127) value = 127;
+        }
+        if (value != previous_vibrato_rate) {
+            send_control_change(config->vibrato_rate_cc, value);
+            previous_vibrato_rate = value;
+        }
+    }
+
+    if (config->vibrato_depth_cc != 0) {
+        int16_t value = 0;
+        if (vibrato.active) {
+            value = (vibrato.depth * 127) / config->softpot_deviation_max;
+            if (value > 127) value = 127;
+        }
+        if (value != previous_vibrato_depth) {
+            send_control_change(config->vibrato_depth_cc, value);
+            previous_vibrato_depth = value;
+        }
+    }
+}
+
+// Send a 14-bit controller: the MSB on the controller and the LSB on
+// controller + 32, with the MSB left out when it hasn't changed since
+// previous
+void HOT_PATH(send_control_change14)(uint8_t controller, int16_t value, int16_t previous) {
+    if (!midi_out_connected()) return;
+
+    if (previous < 0 || (previous >> 7) != (value >> 7)) {
+        send_control_change(controller, value >> 7);
+    }
+    send_control_change(controller + 32, value & 0x7F);
+}
+
+// Send a 0-127 controller, scaled up to 32 bits for MIDI 2.0
+void HOT_PATH(send_control_change)(uint8_t controller, int16_t value) {
+    if (!midi_out_connected()) return;
+
+    ump_t packet;
+    ump_control_change(&packet, MIDI_GROUP, MIDI_CHANNEL, controller, ump_scale_up(value & 0x7F, 7, 32));
+    midi_out_ump(&packet);
+}
@@ -0,0 +1,110 @@
+#include "midi_out.h"
+#include "sysex.h"
+#include "tusb.h"
+#include "hot_path.h"
+
+static midi_out_stats_t stats;
+static midi_out_midi1_writer_t serial_writer;
+static sysex_reply_queue_t replies;
+
+// Channel messages of the current frame
+static ump_t frame[MIDI_OUT_FRAME_EVENTS];
+static uint8_t frame_count;
+
+void midi_out_set_serial_transport(midi_out_midi1_writer_t writer) {
+    serial_writer = writer;
+}
+
+bool HOT_PATH(midi_out_connected)(void) {
+    return serial_writer != NULL || tud_midi_mounted();
+}
+
+static bool HOT_PATH(write_stream)(const uint8_t *msg, uint32_t len) {
+    uint32_t written = tud_midi_stream_write(0, msg, len);
+    stats.messages++;
+    stats.bytes += written;
+    stats.dropped_bytes += len - written;
+
+    return written == len;
+}
+
+// Send queued replies: finish the one part-way out, then, if start is set,
+// one more. Returns true once the stream is between two messages.
+static bool HOT_PATH(send_replies)(bool start) {
+    if (!replies.open && !start) return true;
+
+    const uint8_t *data;
+    uint32_t len;
+    while ((len = sysex_queue_peek(&replies, &data)) > 0) {
+        uint32_t written = tud_midi_stream_write(0, data, len);
+        stats.bytes += written;
+        sysex_queue_consume(&replies, written);
+        if (written < len) return false; // FIFO full, carry on next frame
+        if (!replies.open) {
+            stats.messages++;
+            return true;
+        }
+    }
+    return !replies.open;
+}
+
+bool HOT_PATH(midi_out_ump)(const ump_t *packet) {
+    if (!midi_out_connected()) {
+        stats.unmounted++;
+        return false;
+    }
+    if (frame_count == MIDI_OUT_FRAME_EVENTS) {
+        midi_out_end_frame();
+    }
+    frame[frame_count++] = *packet;
+    return true;
+}
+
+void HOT_PATH(midi_out_end_frame)(void) {
+    bool usb = tud_midi_mounted();
+    if (!usb) sysex_queue_clear(&replies);
+
+    // A reply part-way out has to be finished first: anything written into
+    // the middle of it would cut it short at the host. If it can't be, the
+    // FIFO is full and the channel messages wouldn't fit anyway.
+    bool stream_free = usb && send_replies(false);
+
+    for (int i = 0; i < frame_count; i++) {
+        const ump_t *packet = &frame[i];
+        uint8_t msg[UMP_MIDI1_MAX_BYTES];
+        uint8_t len = ump_to_midi1(packet, msg);
+        if (len == 0) stats.untranslated++;
+
+        if (!usb) {
+            stats.unmounted++;
+        } else {
+            stats.ump_bytes += packet->num_words * 4;
+            if (len > 0 && stream_free) {
+                write_stream(msg, len);
+            } else if (len > 0) {
+                stats.messages++;
+                stats.dropped_bytes += len;
+            }
+        }
+        if (serial_writer && len > 0) {
+            serial_writer(msg, len);
+        }
+    }
+    frame_count = 0;
+
+    // Replies go after the channel messages, one new one per frame
+    if (stream_free) send_replies(true);
+}
+
+bool HOT_PATH(midi_out_write)(const uint8_t *msg, uint32_t len) {
+    if (!tud_midi_mounted()) {
+        stats.unmounted++;
+        return false;
+    }
+    return sysex_queue_push(&replies, msg, len);
+}
+
+const midi_out_stats_t *midi_out_get_stats(void) {
+    stats.dropped_replies = replies.dropped;
+    return &stats;
+}
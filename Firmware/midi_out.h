@@ -0,0 +1,84 @@
+#ifndef _MIDI_OUT_H_
+#define _MIDI_OUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ump.h"
+
+/** \file midi_out.h
+ * \brief Single write path for outgoing MIDI, with queue statistics
+ *
+ * Channel messages are handed in as MIDI 2.0 UMPs (midi_out_ump()) and
+ * translated to MIDI 1.0 bytes for the USB MIDI stream. The TinyUSB MIDI
+ * class in Pico SDK 2.2 has no MIDI 2.0 alternate setting, so there is no
+ * way for a host to pick UMPs yet and MIDI 1.0 is the only output.
+ *
+ * Channel messages are collected over a main loop pass and go out in
+ * midi_out_end_frame(): one pass over the frame's events translates each
+ * one once and hands the bytes to USB and, if registered, to the serial
+ * transport (midi_uart.h). Queued SysEx replies follow on USB.
+*/
+
+#define MIDI_OUT_FRAME_EVENTS 32        // Channel messages per frame before an early flush
+
+typedef struct midi_out_stats {
+    uint32_t messages;      // Messages handed to the USB MIDI FIFO
+    uint32_t bytes;         // Bytes accepted by the FIFO
+    uint32_t dropped_bytes; // Bytes the FIFO had no room for
+    uint32_t unmounted;     // Messages discarded while no host was mounted
+    uint32_t ump_bytes;     // Size of the same channel messages as UMPs
+    uint32_t untranslated;  // UMPs with no MIDI 1.0 form, not sent
+    uint32_t dropped_replies; // SysEx replies the reply queue had no room for
+} midi_out_stats_t;
+
+/*! \brief Writes MIDI 1.0 messages to a serial transport
+ *
+ * \param msg One or more complete messages
+ * \param len Number of bytes
+ * \return true if the messages were queued
+ */
+typedef bool (*midi_out_midi1_writer_t)(const uint8_t *msg, uint32_t len);
+
+/*! \brief Register or drop the serial transport
+ *
+ * \param writer Transport to send MIDI 1.0 through as well, NULL for none
+ */
+void midi_out_set_serial_transport(midi_out_midi1_writer_t writer);
+
+/*! \brief Whether anything is listening: a mounted host or a serial transport
+ */
+bool midi_out_connected(void);
+
+/*! \brief Add one channel message to this frame's events
+ *
+ * It goes out with midi_out_end_frame(). A full frame is sent early.
+ *
+ * \param packet MIDI 2.0 (or MIDI 1.0 type 2) UMP
+ * \return true if the message was added, false if nothing is connected
+ */
+bool midi_out_ump(const ump_t *packet);
+
+/*! \brief Send this frame's channel messages to every transport
+ *
+ * Call once per main loop pass, after the last message of the pass.
+ */
+void midi_out_end_frame(void);
+
+/*! \brief Queue one SysEx reply for the USB MIDI stream
+ *
+ * For replies to the host, so it doesn't go to the serial transport.
+ * Replies leave from midi_out_end_frame(), after the frame's channel
+ * messages and one new reply per frame. A reply too long for the FIFO is
+ * sent over several frames, with no channel message in between.
+ *
+ * \param msg Complete SysEx message, F0 to F7
+ * \param len Number of bytes in the message
+ * \return true if the message was queued
+ */
+bool midi_out_write(const uint8_t *msg, uint32_t len);
+
+/*! \brief Get the running MIDI queue counters
+ */
+const midi_out_stats_t *midi_out_get_stats(void);
+
+#endif
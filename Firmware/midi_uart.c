@@ -0,0 +1,73 @@
+#include "midi_uart.h"
+#include "hot_path.h"
+
+static serial_midi_t serial;
+
+#if STRADEX_SERIAL_MIDI
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/uart.h"
+#include "midi_out.h"
+
+#define MIDI_UART uart0
+
+static int dma_channel;
+static uint32_t in_flight;  // Bytes the running transfer was started with
+
+static bool HOT_PATH(write_messages)(const uint8_t *msg, uint32_t len) {
+    serial_midi_write(&serial, msg, len, time_us_32());
+    return true;
+}
+
+void midi_uart_init(uint32_t cc_interval_us) {
+    serial_midi_init(&serial, cc_interval_us);
+    uart_init(MIDI_UART, SERIAL_MIDI_BAUD);
+    gpio_set_function(MIDI_UART_TX_PIN, GPIO_FUNC_UART);
+
+    // Bytes from the queue to the UART FIFO, paced by the UART
+    dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, uart_get_dreq_num(MIDI_UART, true));
+    dma_channel_configure(dma_channel, &c, &uart_get_hw(MIDI_UART)->dr, NULL, 0, false);
+
+    midi_out_set_serial_transport(write_messages);
+}
+
+void midi_uart_set_cc_interval(uint32_t cc_interval_us) {
+    serial_midi_set_cc_interval(&serial, cc_interval_us);
+}
+
+// Release what the finished transfer sent, then start on the next
+// contiguous run of the queue
+void HOT_PATH(midi_uart_task)(uint32_t now_us) {
+    serial_midi_poll(&serial, now_us);
+    if (dma_channel_is_busy(dma_channel)) return;
+
+    serial_midi_consume(&serial, in_flight);
+    const uint8_t *data;
+    in_flight = serial_midi_peek(&serial, &data);
+    if (in_flight > 0) {
+        dma_channel_transfer_from_buffer_now(dma_channel, data, in_flight);
+    }
+}
+
+#else
+
+void midi_uart_init(uint32_t cc_interval_us) {
+}
+
+void midi_uart_set_cc_interval(uint32_t cc_interval_us) {
+}
+
+void midi_uart_task(uint32_t now_us) {
+}
+
+#endif
+
+const serial_midi_stats_t *midi_uart_get_stats(void) {
+    return &serial.stats;
+}
@@ -0,0 +1,42 @@
+#ifndef _MIDI_UART_H_
+#define _MIDI_UART_H_
+
+#include <stdint.h>
+#include "serial_midi.h"
+
+/** \file midi_uart.h
+ * \brief DIN/TRS MIDI out on a UART, fed by DMA
+ *
+ * Built with STRADEX_SERIAL_MIDI. Registers with midi_out.h as a second
+ * transport, so every channel message also goes out as MIDI 1.0 at 31250
+ * baud on MIDI_UART_TX_PIN, encoded by serial_midi.h. DMA moves the queued
+ * bytes into the UART FIFO; the main loop only starts each transfer. Wire
+ * the pin to a DIN or TRS socket through the usual 3.3 V MIDI out
+ * resistors. Without STRADEX_SERIAL_MIDI these calls do nothing.
+*/
+
+#define MIDI_UART_TX_PIN 0              // UART0 TX
+
+/*! \brief Set up the UART and its DMA channel and register the transport
+ *
+ * \param cc_interval_us Controller rate limit, see serial_midi.h
+ */
+void midi_uart_init(uint32_t cc_interval_us);
+
+/*! \brief Change the controller rate limit
+ */
+void midi_uart_set_cc_interval(uint32_t cc_interval_us);
+
+/*! \brief Send held controllers that are due and keep the DMA going
+ *
+ * Call every main loop pass, after midi_out_end_frame().
+ *
+ * \param now_us Current time in microseconds
+ */
+void midi_uart_task(uint32_t now_us);
+
+/*! \brief Serial MIDI counters since boot
+ */
+const serial_midi_stats_t *midi_uart_get_stats(void);
+
+#endif
@@ -0,0 +1,82 @@
+#include "pitchmap.h"
+#include "hot_path.h"
+
+int32_t HOT_PATH(pitchmap_fractional_fret)(const int16_t *positions, int num_positions,
+                                           int16_t value) {
+    // Up to the first boundary, ramp up from the centre of the open string's
+    // span (see pitchmap_fret_center())
+    if (value < positions[0]) {
+        int32_t open_center = positions[0] / 2;
+        if (value <= open_center) return 0;
+        return ((int32_t)(value - open_center) << (PITCHMAP_FRAC_BITS - 1)) / (positions[0] - open_center);
+    }
+    if (value >= positions[num_positions - 1]) {
+        return (num_positions - 1) * PITCHMAP_ONE + PITCHMAP_ONE / 2;
+    }
+
+    // Find the band [positions[lo], positions[lo + 1]) holding the value
+    int lo = 0;
+    int hi = num_positions - 1;
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if (value >= positions[mid]) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    int32_t width = positions[lo + 1] - positions[lo];
+    int32_t frac = ((int32_t)(value - positions[lo]) << PITCHMAP_FRAC_BITS) / width;
+    return lo * PITCHMAP_ONE + PITCHMAP_ONE / 2 + frac;
+}
+
+int32_t HOT_PATH(pitchmap_fret_center)(const int16_t *positions, int num_positions, int16_t fret) {
+    int32_t start, end;
+    if (fret == 0) {
+        start = 0;
+        end = positions[0];
+    } else if (fret >= num_positions) {
+        start = positions[num_positions - 1];
+        end = start + (positions[num_positions - 1] - positions[num_positions - 2]);
+    } else {
+        start = positions[fret - 1];
+        end = positions[fret];
+    }
+    return (start + end) / 2;
+}
+
+int32_t HOT_PATH(pitchmap_fret_bend)(const int16_t *positions, int num_positions, int16_t value,
+                                     int16_t fret, int16_t deviation_max, int16_t bend_max) {
+    int32_t deviation = value - pitchmap_fret_center(positions, num_positions, fret);
+    if (deviation > deviation_max) {
+        deviation = deviation_max;
+    } else if (deviation < -deviation_max) {
+        deviation = -deviation_max;
+    }
+    return PITCHMAP_BEND_CENTER + (deviation * bend_max) / deviation_max;
+}
+
+int16_t pitchmap_tuning_offset(int16_t pot_value, int16_t pot_min, int16_t pot_max,
+                               int16_t pot_center, int16_t range) {
+    if (pot_value < pot_min) pot_value = pot_min;
+    if (pot_value > pot_max) pot_value = pot_max;
+
+    int32_t offset_from_center = pot_value - pot_center;
+    int16_t tuning_offset = (offset_from_center * range) / (pot_max / 2);
+
+    if (tuning_offset > range) tuning_offset = range;
+    if (tuning_offset < -range) tuning_offset = -range;
+    return tuning_offset;
+}
+
+int32_t HOT_PATH(pitchmap_bend)(int32_t offset, int16_t range) {
+    if (range <= 0) return offset == 0 ? PITCHMAP_BEND_CENTER : -1;
+
+    int32_t limit = (int32_t)range * PITCHMAP_ONE;
+    if (offset > limit || offset < -limit) return -1;
+
+    int32_t bend = PITCHMAP_BEND_CENTER + (offset * PITCHMAP_BEND_CENTER) / limit;
+    if (bend > PITCHMAP_BEND_MAX) bend = PITCHMAP_BEND_MAX;
+    return bend;
+}
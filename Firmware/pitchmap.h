@@ -0,0 +1,87 @@
+#ifndef _PITCHMAP_H_
+#define _PITCHMAP_H_
+
+#include <stdint.h>
+
+/** \file pitchmap.h
+ * \brief Continuous (fractional) pitch from the softpot through the fret map
+ *
+ * Boundary i of the fret map separates fret i from fret i + 1, so it maps
+ * to pitch i + 0.5 and each fret centre lands on a whole semitone. Between
+ * boundaries the pitch is interpolated linearly, and from the centre of the
+ * open string's span up to the first boundary, which makes it continuous and
+ * monotonic along the whole fingerboard.
+ *
+ * Glide mode calls pitchmap_fractional_fret() on every softpot reading, so
+ * the band search is a binary search over the boundaries and the only
+ * division is the one within the band.
+*/
+
+#define PITCHMAP_FRAC_BITS 12 // Pitches are in 1/4096 semitone
+#define PITCHMAP_ONE (1 << PITCHMAP_FRAC_BITS)
+
+#define PITCHMAP_BEND_CENTER 8192
+#define PITCHMAP_BEND_MAX 16383
+#define PITCHMAP_DEFAULT_BEND_RANGE 2 // Semitones, until a receiver is told otherwise with RPN 0
+#define PITCHMAP_BEND_PER_SEMITONE (PITCHMAP_BEND_CENTER / PITCHMAP_DEFAULT_BEND_RANGE) // At the default range
+
+/*! \brief Map a softpot reading to a fractional fret
+ *
+ * \param positions Fret boundary table, strictly increasing
+ * \param num_positions Number of boundaries
+ * \param value Softpot reading
+ * \return Fret in 1/PITCHMAP_ONE semitones; 0 (open string) up to the
+ * centre of the open string's span, clamped at the last boundary
+ */
+int32_t pitchmap_fractional_fret(const int16_t *positions, int num_positions,
+                                 int16_t value);
+
+/*! \brief Centre of a fret's span on the softpot
+ *
+ * The open string uses the span of the first fret, and past the last
+ * boundary the last fret's width is extended.
+ *
+ * \param positions Fret boundary table, strictly increasing
+ * \param num_positions Number of boundaries, at least 2
+ * \param fret Fret number, 0 for the open string
+ */
+int32_t pitchmap_fret_center(const int16_t *positions, int num_positions, int16_t fret);
+
+/*! \brief Fretted-mode bend for a reading within a fret
+ *
+ * The reading's deviation from the centre of the fret's span, clamped to
+ * ±deviation_max, scaled to ±bend_max around PITCHMAP_BEND_CENTER. The open
+ * string uses the span of the first fret, and past the last boundary the
+ * last fret's width is extended.
+ *
+ * \param positions Fret boundary table, strictly increasing
+ * \param num_positions Number of boundaries, at least 2
+ * \param value Softpot reading
+ * \param fret Fret the reading has been quantised to
+ * \param deviation_max Deviation that gives the full bend
+ * \param bend_max Bend at full deviation
+ * \return Bend value
+ */
+int32_t pitchmap_fret_bend(const int16_t *positions, int num_positions, int16_t value,
+                           int16_t fret, int16_t deviation_max, int16_t bend_max);
+
+/*! \brief Tuning offset for a tuning pot reading
+ *
+ * The reading is clamped to [pot_min, pot_max]; half of pot_max either side
+ * of pot_center is the full range.
+ *
+ * \param range Largest offset either way, semitones
+ * \return Offset in semitones, within ±range
+ */
+int16_t pitchmap_tuning_offset(int16_t pot_value, int16_t pot_min, int16_t pot_max,
+                               int16_t pot_center, int16_t range);
+
+/*! \brief Express a pitch offset as a 14-bit pitch bend
+ *
+ * \param offset Pitch relative to the sounding note, 1/PITCHMAP_ONE semitones
+ * \param range Bend range in semitones (as sent with RPN 0)
+ * \return Bend value 0-16383, or -1 if the offset doesn't fit in the range
+ */
+int32_t pitchmap_bend(int32_t offset, int16_t range);
+
+#endif
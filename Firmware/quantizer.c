@@ -0,0 +1,59 @@
+#include "quantizer.h"
+#include "hot_path.h"
+
+void quantizer_init(quantizer_t *q, const int16_t *edges, uint8_t num_edges,
+                    int16_t hysteresis, const quantizer_table_t *table) {
+    q->edges = edges;
+    q->num_edges = num_edges;
+    q->hysteresis = hysteresis;
+    q->table = table;
+    q->band = -1;
+}
+
+void quantizer_build_table(quantizer_table_t *table, const int16_t *edges,
+                           uint8_t num_edges) {
+    uint8_t band = 0;
+    for (int i = 0; i < QUANTIZER_TABLE_SIZE; i++) {
+        int32_t slice_start = -32768 + (i << QUANTIZER_TABLE_SHIFT);
+        while (band < num_edges && edges[band] <= slice_start) band++;
+        table->first_band[i] = band;
+    }
+}
+
+int16_t HOT_PATH(quantizer_band)(const quantizer_t *q, int16_t value) {
+    if (q->table) {
+        // Start from the lowest band in this value's slice and walk up
+        int16_t band = q->table->first_band[((int32_t)value + 32768) >> QUANTIZER_TABLE_SHIFT];
+        while (band < q->num_edges && value >= q->edges[band]) band++;
+        return band;
+    }
+
+    // Binary search for the number of edges at or below the value
+    int16_t lo = 0;
+    int16_t hi = q->num_edges;
+    while (lo < hi) {
+        int16_t mid = (lo + hi) / 2;
+        if (value >= q->edges[mid]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int16_t HOT_PATH(quantizer_update)(quantizer_t *q, int16_t value) {
+    if (q->band >= 0) {
+        // Stay while inside the current band widened by the hysteresis. The
+        // widening stops short of the input range's ends, so an edge near
+        // full scale can still be crossed.
+        int32_t lower = q->band > 0 ? q->edges[q->band - 1] - q->hysteresis : INT32_MIN;
+        int32_t upper = q->band < q->num_edges ? q->edges[q->band] + q->hysteresis : INT32_MAX;
+        if (q->band > 0 && lower < INT16_MIN + 1) lower = INT16_MIN + 1;
+        if (q->band < q->num_edges && upper > INT16_MAX) upper = INT16_MAX;
+        if (value >= lower && value < upper) return q->band;
+    }
+
+    q->band = quantizer_band(q, value);
+    return q->band;
+}
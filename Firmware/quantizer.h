@@ -0,0 +1,63 @@
+#ifndef _QUANTIZER_H_
+#define _QUANTIZER_H_
+
+#include <stdint.h>
+
+/** \file quantizer.h
+ * \brief Multi-band quantiser with hysteresis
+ *
+ * A set of ascending band edges splits the input range into
+ * num_edges + 1 bands; band b holds the values with exactly b edges at or
+ * below them. Once in a band, the input has to move past the band's edges
+ * by more than the hysteresis width before the band changes, so a value
+ * resting near an edge can't flicker.
+ *
+ * State lives in the caller's struct, nothing is allocated. An optional
+ * precomputed table turns the band search into one lookup plus at most a
+ * couple of compares.
+ *
+ * The widened band stops at the ends of the int16 range. An edge within the
+ * hysteresis of full scale (the top modulation step, say) is crossed when
+ * the input reaches full scale.
+*/
+
+#define QUANTIZER_TABLE_SHIFT 10
+#define QUANTIZER_TABLE_SIZE (65536 >> QUANTIZER_TABLE_SHIFT)
+
+// Lowest band of each 1024-wide slice of the int16 range
+typedef struct quantizer_table {
+    uint8_t first_band[QUANTIZER_TABLE_SIZE];
+} quantizer_table_t;
+
+typedef struct quantizer {
+    const int16_t *edges;           // Ascending band edges
+    uint8_t num_edges;
+    int16_t hysteresis;
+    const quantizer_table_t *table; // Optional, NULL for a plain search
+    int16_t band;                   // Current band, -1 before the first value
+} quantizer_t;
+
+/*! \brief Set up a quantiser
+ *
+ * \param edges Ascending band edges; must stay valid while in use
+ * \param table Table built with quantizer_build_table(), or NULL
+ */
+void quantizer_init(quantizer_t *q, const int16_t *edges, uint8_t num_edges,
+                    int16_t hysteresis, const quantizer_table_t *table);
+
+/*! \brief Precompute the band lookup table for a set of edges
+ */
+void quantizer_build_table(quantizer_table_t *table, const int16_t *edges,
+                           uint8_t num_edges);
+
+/*! \brief Band of a value, ignoring hysteresis
+ */
+int16_t quantizer_band(const quantizer_t *q, int16_t value);
+
+/*! \brief Quantise a value, with hysteresis against the current band
+ *
+ * \return The (possibly unchanged) current band
+ */
+int16_t quantizer_update(quantizer_t *q, int16_t value);
+
+#endif
@@ -0,0 +1,106 @@
+#include "sensor_map.h"
+#include "hot_path.h"
+
+static void sensor_schedule_clear(sensor_schedule_t *schedule, const sensor_channel_t *map) {
+    *schedule = (sensor_schedule_t){0};
+    schedule->map = map;
+    for (int r = 0; r < SENSOR_ROLE_COUNT; r++) {
+        for (int i = 0; i < SENSOR_MAP_MAX_ROLE_INDEX; i++) {
+            schedule->lookup[r][i] = -1;
+        }
+    }
+}
+
+static bool sensor_schedule_build(sensor_schedule_t *schedule, const sensor_channel_t *map,
+                                  uint8_t num_channels) {
+    if (num_channels == 0 || num_channels > SENSOR_MAP_MAX_CHANNELS) return false;
+
+    for (int c = 0; c < num_channels; c++) {
+        const sensor_channel_t *channel = &map[c];
+        if (channel->address < SENSOR_MAP_FIRST_ADDRESS || channel->address > SENSOR_MAP_LAST_ADDRESS) return false;
+        if (channel->role >= SENSOR_ROLE_COUNT || channel->index >= SENSOR_MAP_MAX_ROLE_INDEX) return false;
+
+        // Find or add the chip
+        int device = 0;
+        while (device < schedule->num_devices && schedule->addresses[device] != channel->address) device++;
+        if (device == schedule->num_devices) {
+            if (device == SENSOR_MAP_MAX_DEVICES) return false;
+            schedule->addresses[device] = channel->address;
+            schedule->num_devices++;
+        }
+
+        // The same input can't be converted twice per pass
+        for (int i = 0; i < schedule->device_num_channels[device]; i++) {
+            if (map[schedule->device_channels[device][i]].mux == channel->mux) return false;
+        }
+        if (schedule->device_num_channels[device] == SENSOR_MAP_MAX_DEVICE_CHANNELS) return false;
+        schedule->device_channels[device][schedule->device_num_channels[device]++] = c;
+        schedule->channel_device[c] = device;
+
+        if (channel->role != SENSOR_ROLE_NONE) {
+            if (schedule->lookup[channel->role][channel->index] != -1) return false;
+            schedule->lookup[channel->role][channel->index] = c;
+        }
+    }
+
+    schedule->num_channels = num_channels;
+    schedule->active_mask = (1 << schedule->num_devices) - 1;
+    return true;
+}
+
+bool sensor_schedule_init(sensor_schedule_t *schedule, const sensor_channel_t *map,
+                          uint8_t num_channels) {
+    sensor_schedule_clear(schedule, map);
+    if (sensor_schedule_build(schedule, map, num_channels)) return true;
+
+    // Leave an empty schedule behind rather than half a map
+    sensor_schedule_clear(schedule, map);
+    return false;
+}
+
+uint8_t HOT_PATH(sensor_schedule_current)(const sensor_schedule_t *schedule, uint8_t device) {
+    return schedule->device_channels[device][schedule->position[device]];
+}
+
+bool HOT_PATH(sensor_schedule_advance)(sensor_schedule_t *schedule, uint8_t device) {
+    if (++schedule->position[device] < schedule->device_num_channels[device]) return false;
+
+    schedule->position[device] = 0;
+    schedule->pass_mask |= 1 << device;
+    if ((schedule->pass_mask & schedule->active_mask) != schedule->active_mask) return false;
+
+    schedule->pass_mask = 0;
+    return true;
+}
+
+void sensor_schedule_restart(sensor_schedule_t *schedule) {
+    for (int device = 0; device < schedule->num_devices; device++) {
+        schedule->position[device] = 0;
+    }
+    schedule->pass_mask = 0;
+}
+
+void sensor_schedule_set_active(sensor_schedule_t *schedule, uint8_t device, bool active) {
+    if (active) {
+        schedule->active_mask |= 1 << device;
+        schedule->pass_mask &= ~(1 << device);  // Count from a fresh pass
+    } else {
+        schedule->active_mask &= ~(1 << device);
+    }
+}
+
+bool HOT_PATH(sensor_schedule_channel_active)(const sensor_schedule_t *schedule, uint8_t channel) {
+    return schedule->active_mask & (1 << schedule->channel_device[channel]);
+}
+
+int8_t HOT_PATH(sensor_schedule_find)(const sensor_schedule_t *schedule, sensor_role_t role, uint8_t index) {
+    if (role >= SENSOR_ROLE_COUNT || index >= SENSOR_MAP_MAX_ROLE_INDEX) return -1;
+    return schedule->lookup[role][index];
+}
+
+int16_t HOT_PATH(sensor_map_filter)(const sensor_channel_t *channel, int16_t previous, int16_t raw) {
+    if (channel->filter == SENSOR_FILTER_AVERAGE) {
+        return previous + ((int32_t)raw - previous) / 4;
+    }
+    return raw;
+}
@@ -0,0 +1,156 @@
+#ifndef _SENSOR_MAP_H_
+#define _SENSOR_MAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file sensor_map.h
+ * \brief Declarative map of the analog sensors on the ADS1115 chips
+ *
+ * Each map entry describes one conversion: which chip (I2C address
+ * 0x48-0x4B), which input multiplexer setting, the PGA and data rate to use,
+ * what the reading means (its role and role index, e.g. FSR of key 2) and
+ * how it is filtered. The scanner, scheduler and interpreter all work from
+ * the map, so wiring a sensor differently or adding one is a table change.
+ *
+ * Each chip converts its own channels in map order, round robin, and the
+ * chips run concurrently. A full pass is reported once every active chip
+ * has gone through all of its entries, so a chip that stopped answering doesn't stall
+ * the others. Only the schedule lives here; the I2C side is in the ADS1115
+ * driver. host/test_sensor_map.c checks validation and scan coverage.
+*/
+
+#define SENSOR_MAP_MAX_DEVICES 4
+#define SENSOR_MAP_MAX_CHANNELS 16
+#define SENSOR_MAP_MAX_DEVICE_CHANNELS 8    // 4 single ended + 4 differential
+#define SENSOR_MAP_MAX_ROLE_INDEX 4
+#define SENSOR_MAP_FIRST_ADDRESS 0x48
+#define SENSOR_MAP_LAST_ADDRESS 0x4B
+
+/*! \brief What a sensor reading means to the interpreter */
+typedef enum sensor_role {
+    SENSOR_ROLE_NONE = 0,       // Scanned and reported, not interpreted
+    SENSOR_ROLE_FSR,            // Key pressure, index = key
+    SENSOR_ROLE_SOFTPOT,        // Fingerboard position
+    SENSOR_ROLE_MODULATION,     // CC1 pot
+    SENSOR_ROLE_TUNING,         // Transpose pot
+    SENSOR_ROLE_FX,             // CC2 pot
+    SENSOR_ROLE_EXPRESSION,     // CC11 pedal
+    SENSOR_ROLE_COUNT
+} sensor_role_t;
+
+/*! \brief Per-channel filtering before the value reaches the interpreter */
+typedef enum sensor_filter {
+    SENSOR_FILTER_NONE = 0,
+    SENSOR_FILTER_RELEASE,      // Softpot release and glitch filter, see softpot_filter.h
+    SENSOR_FILTER_AVERAGE       // One-pole average over about four samples
+} sensor_filter_t;
+
+typedef struct sensor_channel {
+    uint8_t address;            // ADS1115 I2C address
+    uint16_t mux;               // enum ads1115_mux_t
+    uint16_t pga;               // enum ads1115_pga_t
+    uint16_t rate;              // enum ads1115_rate_t
+    uint8_t role;               // sensor_role_t
+    uint8_t index;              // Instance of the role, e.g. the key number
+    uint8_t filter;             // sensor_filter_t
+} sensor_channel_t;
+
+typedef struct sensor_schedule {
+    const sensor_channel_t *map;
+    uint8_t num_channels;
+    uint8_t num_devices;
+    uint8_t addresses[SENSOR_MAP_MAX_DEVICES];
+    uint8_t device_channels[SENSOR_MAP_MAX_DEVICES][SENSOR_MAP_MAX_DEVICE_CHANNELS];
+    uint8_t device_num_channels[SENSOR_MAP_MAX_DEVICES];
+    uint8_t position[SENSOR_MAP_MAX_DEVICES];   // Next entry in device_channels
+    uint8_t channel_device[SENSOR_MAP_MAX_CHANNELS];
+    uint8_t active_mask;        // Devices being scanned
+    uint8_t pass_mask;          // Devices that wrapped since the last full pass
+
+    // Map entry for each role instance, -1 when not mapped
+    int8_t lookup[SENSOR_ROLE_COUNT][SENSOR_MAP_MAX_ROLE_INDEX];
+} sensor_schedule_t;
+
+/*! \brief Check a sensor map and build its schedule
+ *
+ * Groups the entries by chip in map order and builds the role lookup.
+ * Fails on an address outside 0x48-0x4B, more than four chips, more than
+ * eight entries on one chip, a duplicate (address, mux) pair, a role index
+ * out of range or the same role instance mapped twice.
+ *
+ * \param schedule Schedule to build
+ * \param map Sensor map, must outlive the schedule
+ * \param num_channels Number of map entries
+ * \return true if the map is valid; otherwise the schedule is left empty
+ */
+bool sensor_schedule_init(sensor_schedule_t *schedule, const sensor_channel_t *map,
+                          uint8_t num_channels);
+
+/*! \brief Map entry the device is converting or about to convert
+ *
+ * \param schedule Schedule
+ * \param device Device number, 0 to num_devices - 1
+ * \return Index into the sensor map
+ */
+uint8_t sensor_schedule_current(const sensor_schedule_t *schedule, uint8_t device);
+
+/*! \brief Move a device on to its next channel after a reading
+ *
+ * \param schedule Schedule
+ * \param device Device number, 0 to num_devices - 1
+ * \return true if this reading completed a pass over the whole map, i.e.
+ * every active device has wrapped around since the last full pass
+ */
+bool sensor_schedule_advance(sensor_schedule_t *schedule, uint8_t device);
+
+/*! \brief Start every device over at its first channel
+ *
+ * The next full pass then covers fresh readings only, e.g. after the scan
+ * was paused.
+ *
+ * \param schedule Schedule
+ */
+void sensor_schedule_restart(sensor_schedule_t *schedule);
+
+/*! \brief Take a device out of the scan or put it back
+ *
+ * Inactive devices (e.g. a chip that stopped answering) don't hold up the
+ * full-pass detection of the others. All devices start active.
+ *
+ * \param schedule Schedule
+ * \param device Device number, 0 to num_devices - 1
+ * \param active Whether the device is scanned
+ */
+void sensor_schedule_set_active(sensor_schedule_t *schedule, uint8_t device, bool active);
+
+/*! \brief Whether the device behind a map entry is being scanned
+ *
+ * \param schedule Schedule
+ * \param channel Index into the sensor map
+ * \return true if the entry's device is active
+ */
+bool sensor_schedule_channel_active(const sensor_schedule_t *schedule, uint8_t channel);
+
+/*! \brief Map entry of a role instance
+ *
+ * \param schedule Schedule
+ * \param role Sensor role
+ * \param index Role index
+ * \return Index into the sensor map, or -1 if the role instance isn't mapped
+ */
+int8_t sensor_schedule_find(const sensor_schedule_t *schedule, sensor_role_t role, uint8_t index);
+
+/*! \brief Apply a channel's filter to a new raw reading
+ *
+ * Only the stateless filters are applied here; SENSOR_FILTER_RELEASE passes
+ * the reading through and is handled by the softpot filter.
+ *
+ * \param channel Map entry the reading belongs to
+ * \param previous Previous filtered value
+ * \param raw New raw reading
+ * \return Filtered value
+ */
+int16_t sensor_map_filter(const sensor_channel_t *channel, int16_t previous, int16_t raw);
+
+#endif
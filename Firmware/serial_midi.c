@@ -0,0 +1,163 @@
+#include "serial_midi.h"
+#include "hot_path.h"
+
+#define QUEUE_MASK (SERIAL_MIDI_QUEUE_SIZE - 1)
+
+// Length of the message starting with this status byte, 0 for SysEx
+static uint32_t HOT_PATH(message_length)(uint8_t status) {
+    switch (status & 0xF0) {
+    case 0xC0:
+    case 0xD0:
+        return 2;
+    case 0xF0:
+        if (status == 0xF0) return 0;
+        if (status == 0xF1 || status == 0xF3) return 2;
+        if (status == 0xF2) return 3;
+        return 1;
+    default:
+        return 3;
+    }
+}
+
+// Controllers whose order matters: data entry, data increment/decrement,
+// NRPN and RPN select, and channel mode messages
+static bool HOT_PATH(rate_limited)(uint8_t controller) {
+    if (controller == 6 || controller == 38) return false;
+    if (controller >= 96 && controller <= 101) return false;
+    return controller < 120;
+}
+
+static void HOT_PATH(put)(serial_midi_t *serial, uint8_t byte) {
+    serial->queue[serial->head++ & QUEUE_MASK] = byte;
+    serial->stats.bytes++;
+}
+
+// Queue one complete message, leaving out the status byte where running
+// status allows
+static void HOT_PATH(queue_message)(serial_midi_t *serial, const uint8_t *msg, uint32_t len,
+                                    uint32_t now_us) {
+    uint8_t status = msg[0];
+    bool channel = status < 0xF0;
+    bool skip_status = channel && status == serial->running_status
+                       && now_us - serial->status_us < SERIAL_MIDI_STATUS_REFRESH_US;
+
+    uint32_t needed = skip_status ? len - 1 : len;
+    if (SERIAL_MIDI_QUEUE_SIZE - (serial->head - serial->tail) < needed) {
+        serial->stats.dropped_bytes += len;
+        return;
+    }
+
+    serial->stats.messages++;
+    if (skip_status) {
+        serial->stats.status_saved++;
+    } else {
+        put(serial, status);
+        if (channel) {
+            serial->running_status = status;
+            serial->status_us = now_us;
+        } else if (status < 0xF8) {
+            serial->running_status = 0;
+        }
+    }
+    for (uint32_t i = 1; i < len; i++) {
+        put(serial, msg[i]);
+    }
+}
+
+static void HOT_PATH(send_held)(serial_midi_t *serial, uint8_t controller, uint32_t now_us) {
+    uint8_t msg[3] = {serial->cc_held_status[controller], controller, serial->cc_held_value[controller]};
+    serial->cc_held_status[controller] = 0;
+    serial->cc_sent_us[controller] = now_us;
+    queue_message(serial, msg, 3, now_us);
+}
+
+// A controller either goes out now or replaces the held value
+static void HOT_PATH(control_change)(serial_midi_t *serial, const uint8_t *msg, uint32_t now_us) {
+    uint8_t controller = msg[1] & 0x7F;
+    if (serial->cc_interval_us == 0 || !rate_limited(controller)) {
+        queue_message(serial, msg, 3, now_us);
+        return;
+    }
+
+    // Never mix channels: a value held for another channel goes out first
+    uint8_t held = serial->cc_held_status[controller];
+    if (held != 0 && held != msg[0]) {
+        send_held(serial, controller, now_us);
+    }
+
+    bool msb_held = controller >= 32 && controller < 64 && serial->cc_held_status[controller - 32] == msg[0];
+    if (!msb_held && now_us - serial->cc_sent_us[controller] >= serial->cc_interval_us) {
+        serial->cc_held_status[controller] = 0;
+        serial->cc_sent_us[controller] = now_us;
+        queue_message(serial, msg, 3, now_us);
+        return;
+    }
+
+    if (serial->cc_held_status[controller] != 0) {
+        serial->stats.cc_replaced++;
+    } else {
+        serial->stats.cc_held++;
+    }
+    serial->cc_held_status[controller] = msg[0];
+    serial->cc_held_value[controller] = msg[2];
+}
+
+void serial_midi_init(serial_midi_t *serial, uint32_t cc_interval_us) {
+    *serial = (serial_midi_t){.cc_interval_us = cc_interval_us};
+
+    // As if every controller went out one interval before time 0, so none
+    // is held at boot
+    for (int controller = 0; controller < 128; controller++) {
+        serial->cc_sent_us[controller] = 0u - cc_interval_us;
+    }
+}
+
+void serial_midi_set_cc_interval(serial_midi_t *serial, uint32_t cc_interval_us) {
+    serial->cc_interval_us = cc_interval_us;
+}
+
+void HOT_PATH(serial_midi_write)(serial_midi_t *serial, const uint8_t *bytes, uint32_t len,
+                                 uint32_t now_us) {
+    uint32_t i = 0;
+    while (i < len) {
+        uint32_t length = message_length(bytes[i]);
+        if (length == 0) {
+            // SysEx runs up to and including its end byte
+            length = 1;
+            while (i + length < len && bytes[i + length - 1] != 0xF7) {
+                length++;
+            }
+        }
+        if (i + length > len) return; // Truncated message
+
+        if ((bytes[i] & 0xF0) == 0xB0) {
+            control_change(serial, &bytes[i], now_us);
+        } else {
+            queue_message(serial, &bytes[i], length, now_us);
+        }
+        i += length;
+    }
+}
+
+void HOT_PATH(serial_midi_poll)(serial_midi_t *serial, uint32_t now_us) {
+    for (int controller = 0; controller < 128; controller++) {
+        if (serial->cc_held_status[controller] == 0) continue;
+        if (now_us - serial->cc_sent_us[controller] < serial->cc_interval_us) continue;
+
+        // An LSB waits for its MSB, which comes first in this loop anyway
+        if (controller >= 32 && controller < 64 && serial->cc_held_status[controller - 32] != 0) continue;
+        send_held(serial, controller, now_us);
+    }
+}
+
+uint32_t HOT_PATH(serial_midi_peek)(const serial_midi_t *serial, const uint8_t **data) {
+    uint32_t queued = serial->head - serial->tail;
+    uint32_t offset = serial->tail & QUEUE_MASK;
+    uint32_t contiguous = SERIAL_MIDI_QUEUE_SIZE - offset;
+    *data = &serial->queue[offset];
+    return queued < contiguous ? queued : contiguous;
+}
+
+void HOT_PATH(serial_midi_consume)(serial_midi_t *serial, uint32_t count) {
+    serial->tail += count;
+}
@@ -0,0 +1,102 @@
+#ifndef _SERIAL_MIDI_H_
+#define _SERIAL_MIDI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file serial_midi.h
+ * \brief MIDI 1.0 byte stream for a 31250 baud DIN/TRS link
+ *
+ * Complete MIDI 1.0 messages go into a byte queue that the UART transport
+ * (midi_uart.h) drains. A link this slow carries about 1000 three-byte
+ * messages per second, so the encoder saves bytes two ways:
+ *
+ * - Running status: a channel message with the same status byte as the one
+ *   before it goes out without it. System common messages cancel running
+ *   status, real-time messages leave it alone. The status byte is sent
+ *   again at least every SERIAL_MIDI_STATUS_REFRESH_US, so a receiver
+ *   plugged in mid-stream catches on.
+ * - Controller rate limiting: a continuous controller goes out at most once
+ *   per interval. A newer value replaces one that is held back, and the
+ *   held value goes out as soon as its interval is over, so the receiver
+ *   always ends up at the last value. An LSB (CC 32-63) is held while its
+ *   MSB is, and held controllers go out in controller order, so an MSB is
+ *   never sent after its LSB. Data entry, RPN/NRPN select and channel mode
+ *   controllers are never held, since their order matters.
+ *
+ * Time only comes in through now_us and the bytes only leave through
+ * serial_midi_peek(), so host/test_serial_midi.c checks the stream byte
+ * for byte without the UART.
+*/
+
+#define SERIAL_MIDI_BAUD 31250
+#define SERIAL_MIDI_QUEUE_SIZE 256              // Bytes, a power of two
+#define SERIAL_MIDI_STATUS_REFRESH_US 1000000
+
+typedef struct serial_midi_stats {
+    uint32_t messages;          // Messages queued
+    uint32_t bytes;             // Bytes queued
+    uint32_t status_saved;      // Status bytes left out by running status
+    uint32_t cc_held;           // Controllers held back by the rate limit
+    uint32_t cc_replaced;       // Held controllers replaced before they went out
+    uint32_t dropped_bytes;     // Messages the queue had no room for
+} serial_midi_stats_t;
+
+typedef struct serial_midi {
+    uint8_t queue[SERIAL_MIDI_QUEUE_SIZE];
+    uint32_t head;              // Free-running write and read positions
+    uint32_t tail;
+    uint8_t running_status;     // 0 for none
+    uint32_t status_us;         // When the running status byte was last sent
+
+    uint32_t cc_interval_us;    // 0 sends every controller straight away
+    uint32_t cc_sent_us[128];
+    uint8_t cc_held_status[128]; // Status byte of a held controller, 0 for none
+    uint8_t cc_held_value[128];
+
+    serial_midi_stats_t stats;
+} serial_midi_t;
+
+/*! \brief Start with an empty queue and no running status
+ *
+ * \param serial Encoder to initialise
+ * \param cc_interval_us Shortest time between two values of a controller
+ */
+void serial_midi_init(serial_midi_t *serial, uint32_t cc_interval_us);
+
+/*! \brief Change the controller rate limit
+ */
+void serial_midi_set_cc_interval(serial_midi_t *serial, uint32_t cc_interval_us);
+
+/*! \brief Queue MIDI 1.0 messages
+ *
+ * Takes one or more complete messages, e.g. the translation of a UMP. A
+ * message that doesn't fit in the queue is dropped whole and counted.
+ *
+ * \param serial Encoder
+ * \param bytes Messages, each starting with its status byte
+ * \param len Number of bytes
+ * \param now_us Current time in microseconds
+ */
+void serial_midi_write(serial_midi_t *serial, const uint8_t *bytes, uint32_t len, uint32_t now_us);
+
+/*! \brief Queue the held controllers whose interval is over
+ *
+ * \param serial Encoder
+ * \param now_us Current time in microseconds
+ */
+void serial_midi_poll(serial_midi_t *serial, uint32_t now_us);
+
+/*! \brief The queued bytes that are contiguous in memory
+ *
+ * \param serial Encoder
+ * \param data Receives a pointer to the oldest queued byte
+ * \return Number of bytes from there, 0 if the queue is empty
+ */
+uint32_t serial_midi_peek(const serial_midi_t *serial, const uint8_t **data);
+
+/*! \brief Release bytes returned by serial_midi_peek() once they are sent
+ */
+void serial_midi_consume(serial_midi_t *serial, uint32_t count);
+
+#endif
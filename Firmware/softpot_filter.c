@@ -0,0 +1,79 @@
+#include "softpot_filter.h"
+#include "hot_path.h"
+
+static int16_t HOT_PATH(median3)(int16_t a, int16_t b, int16_t c) {
+    if (a > b) { int16_t t = a; a = b; b = t; }
+    if (b > c) { b = c; }
+    return a > b ? a : b;
+}
+
+int16_t HOT_PATH(softpot_filter_update)(softpot_filter_t *filter, int16_t raw,
+                                        int16_t touch_threshold, int16_t max_slew) {
+    if (raw < touch_threshold) {
+        if (!filter->touched) {
+            filter->output = raw;
+            return raw;
+        }
+
+        // Possibly lifting: hold the last valid value until confirmed. A
+        // jump on either side of this sample isn't consecutive agreement.
+        filter->suspect_count = 0;
+        if (++filter->release_count < SOFTPOT_RELEASE_CONFIRM) {
+            filter->held_samples++;
+            return filter->output;
+        }
+        filter->touched = false;
+        filter->releases++;
+        filter->suspect_count = 0;
+        filter->output = raw;
+        return raw;
+    }
+    filter->release_count = 0;
+
+    if (!filter->touched) {
+        // New touch: start the median window from this reading
+        filter->touched = true;
+        for (int i = 0; i < SOFTPOT_MEDIAN_SIZE; i++) {
+            filter->window[i] = raw;
+        }
+        filter->output = raw;
+        return raw;
+    }
+
+    filter->window[filter->window_index] = raw;
+    filter->window_index = (filter->window_index + 1) % SOFTPOT_MEDIAN_SIZE;
+    int16_t value = median3(filter->window[0], filter->window[1], filter->window[2]);
+
+    int32_t step = value - filter->output;
+    if (step > max_slew || step < -max_slew) {
+        // Only believe the jump once consecutive raw samples agree on it
+        int32_t spread = raw - filter->suspect_value;
+        if (filter->suspect_count == 0 || spread > max_slew || spread < -max_slew) {
+            filter->suspect_count = 0;
+        }
+        filter->suspect_value = raw;
+        if (++filter->suspect_count < SOFTPOT_SLEW_CONFIRM) {
+            filter->held_samples++;
+            return filter->output;
+        }
+    }
+    filter->suspect_count = 0;
+    filter->output = value;
+    return value;
+}
+
+void HOT_PATH(softpot_filter_fret)(softpot_filter_t *filter, int16_t fret) {
+    if (fret == filter->fret) {
+        if (filter->fret_samples != 0 && filter->fret_samples < SOFTPOT_SPURIOUS_SAMPLES) {
+            filter->fret_samples++;
+        }
+        return;
+    }
+
+    // 0 samples: nothing played since reset yet
+    if (filter->fret_samples != 0 && filter->fret_samples < SOFTPOT_SPURIOUS_SAMPLES) {
+        filter->spurious_changes++;
+    }
+    filter->fret = fret;
+    filter->fret_samples = 1;
+}
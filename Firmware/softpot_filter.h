@@ -0,0 +1,71 @@
+#ifndef _SOFTPOT_FILTER_H_
+#define _SOFTPOT_FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file softpot_filter.h
+ * \brief Softpot release detection and glitch rejection
+ *
+ * When the finger lifts, the wiper floats and the readings sweep down
+ * through several frets before settling in the open-string region. The
+ * filter holds the last valid reading across that transition:
+ *
+ * - a 3-sample median removes single outliers,
+ * - a jump larger than the slew limit is held off until the following
+ *   samples settle near the new position (a real fast slide) or it turns
+ *   into a release; a floating wiper keeps moving and never settles,
+ * - a release is only reported after the reading has stayed under the
+ *   touch threshold for a couple of samples, and then switches cleanly.
+ *
+ * The price is latency: a fast slide comes through SOFTPOT_SLEW_CONFIRM - 1
+ * samples late and a release SOFTPOT_RELEASE_CONFIRM - 1 samples late.
+ * host/tune_params searches recorded traces for the touch threshold and
+ * slew limit that trade this off best.
+*/
+
+#define SOFTPOT_MEDIAN_SIZE 3
+#define SOFTPOT_RELEASE_CONFIRM 2   // Samples under the threshold to release
+#define SOFTPOT_SLEW_CONFIRM 2      // Samples to accept a jump as a real move
+#define SOFTPOT_SPURIOUS_SAMPLES 8  // A fret held for fewer samples wasn't played
+
+typedef struct softpot_filter {
+    int16_t window[SOFTPOT_MEDIAN_SIZE];
+    uint8_t window_index;
+    int16_t output;             // Last accepted value
+    bool touched;
+    uint8_t release_count;      // Consecutive samples under the threshold
+    uint8_t suspect_count;      // Consecutive samples agreeing on a jump
+    int16_t suspect_value;      // Where the jump seems to have gone
+
+    int16_t fret;               // Fret played from the filtered value
+    uint8_t fret_samples;       // Samples it has lasted, up to SOFTPOT_SPURIOUS_SAMPLES
+
+    // Counters for reporting
+    uint32_t held_samples;      // Samples replaced by the last valid value
+    uint32_t releases;
+    uint32_t spurious_changes;  // Frets left again within SOFTPOT_SPURIOUS_SAMPLES
+} softpot_filter_t;
+
+/*! \brief Feed one new softpot sample
+ *
+ * \param raw Softpot reading
+ * \param touch_threshold Readings below this mean the finger is off
+ * \param max_slew Largest believable change between two samples
+ * \return Filtered reading; below touch_threshold once released
+ */
+int16_t softpot_filter_update(softpot_filter_t *filter, int16_t raw,
+                              int16_t touch_threshold, int16_t max_slew);
+
+/*! \brief Count the fret played from one softpot sample
+ *
+ * A fret that lasts fewer than SOFTPOT_SPURIOUS_SAMPLES samples (about 9 ms
+ * at 860 SPS) is too short to have been played: it is what a floating wiper
+ * or a glitch that got through looks like. Those are counted in
+ * spurious_changes.
+ *
+ * \param fret Fret quantised from the sample, 0 for the open string
+ */
+void softpot_filter_fret(softpot_filter_t *filter, int16_t fret);
+
+#endif
@@ -0,0 +1,164 @@
+#include "synth.h"
+#include "hot_path.h"
+
+#define DELAY_MASK (SYNTH_DELAY_SIZE - 1)
+#define PERIOD_A4_Q16 7149382           // 48000 / 440 Hz, Q16
+#define BOW_POSITION_Q16 8323           // Bridge side of the string, 0.127
+#define LOOP_DELAY_Q16 19661            // Delay of the loss filter, 0.3 samples
+#define MIN_DELAY_Q16 (2 << 16)
+#define MAX_DELAY_Q16 ((SYNTH_DELAY_SIZE - 2) << 16)
+#define LOSS_COEF 24576                 // One-pole bridge low-pass, 0.75
+#define BRIDGE_GAIN 31130               // 0.95
+#define BOW_MIN_VELOCITY 983            // 0.03, the lightest bow stroke
+#define BOW_VELOCITY_RANGE 6554         // 0.2 more at full pressure
+#define ROUND_Q15 (1 << 14)             // Round rather than floor, or the loop drifts to a DC offset
+#define LFO_STEP ((uint32_t)(5.5 * 4294967296.0 * SYNTH_BLOCK / SYNTH_SAMPLE_RATE))
+
+// 2^(i/48), quarter-semitone steps over one octave, Q16
+static const uint32_t HOT_DATA(pow2_table)[49] = {
+    65536, 66489, 67456, 68438, 69433, 70443, 71468, 72507, 73562, 74632,
+    75717, 76819, 77936, 79069, 80220, 81386, 82570, 83771, 84990, 86226,
+    87480, 88752, 90043, 91353, 92682, 94030, 95398, 96785, 98193, 99621,
+    101070, 102540, 104032, 105545, 107080, 108638, 110218, 111821, 113448, 115098,
+    116772, 118470, 120194, 121942, 123715, 125515, 127341, 129193, 131072
+};
+
+// Bow friction curve min(1, (3|v| + 0.75)^-4) for v = 0 to 1 in 128 steps,
+// Q15: the bow sticks at small velocity differences and slips at large ones
+static const int16_t HOT_DATA(bow_table)[129] = {
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 31764, 28973, 26482, 24253, 22254, 20457, 18837, 17375, 16052,
+    14852, 13763, 12771, 11867, 11042, 10287, 9596, 8962, 8379, 7843,
+    7349, 6894, 6473, 6083, 5723, 5389, 5079, 4791, 4523, 4273,
+    4041, 3824, 3621, 3432, 3255, 3089, 2934, 2788, 2651, 2523,
+    2402, 2288, 2181, 2080, 1985, 1896, 1811, 1731, 1655, 1584,
+    1516, 1452, 1391, 1333, 1279, 1227, 1177, 1130, 1086, 1044,
+    1003, 965, 928, 893, 860, 828, 798, 769, 742, 715,
+    690, 666, 643, 621, 600, 580, 560, 542, 524, 507,
+    490, 474, 459, 445, 431, 417, 405, 392, 380, 369,
+    358, 347, 337, 327, 317, 308, 299, 291, 283, 275,
+    267, 260, 253, 246, 239, 233, 226, 220, 215, 209,
+    203, 198, 193, 188, 183, 179, 174, 170, 166
+};
+
+static inline int32_t saturate16(int32_t value) {
+    if (value > 32767) return 32767;
+    if (value < -32768) return -32768;
+    return value;
+}
+
+static inline int32_t friction(int32_t velocity) {
+    uint32_t x = velocity < 0 ? -velocity : velocity;
+    if (x > 32767) x = 32767;
+    int32_t step = x >> 8;
+    int32_t frac = x & 0xFF;
+    return bow_table[step] + (((bow_table[step + 1] - bow_table[step]) * frac) >> 8);
+}
+
+// Value written delay_q16 samples before the write position, linearly
+// interpolated
+static inline int32_t delay_read(const int16_t *line, uint16_t write, int32_t delay_q16) {
+    uint16_t index = write - (delay_q16 >> 16);
+    int32_t frac = (delay_q16 & 0xFFFF) >> 1;
+    int32_t a = line[index & DELAY_MASK];
+    int32_t b = line[(index - 1) & DELAY_MASK];
+    return a + (((b - a) * frac) >> 15);
+}
+
+// Parabolic sine approximation, phase full turn = 2^32, Q15
+static int32_t HOT_PATH(lfo_q15)(uint32_t phase) {
+    int32_t x = (int32_t)phase >> 16;
+    int32_t magnitude = x < 0 ? -x : x;
+    return (4 * x * (32768 - magnitude)) >> 15;
+}
+
+void synth_init(synth_t *synth) {
+    *synth = (synth_t){0};
+    for (int v = 0; v < SYNTH_NUM_VOICES; v++) {
+        synth->voices[v].pitch = 60 * SYNTH_PITCH_ONE;
+    }
+}
+
+void HOT_PATH(synth_set_voice)(synth_t *synth, int voice, int32_t pitch, int16_t pressure) {
+    synth_voice_t *v = &synth->voices[voice];
+    if (pitch < 0) pitch = 0;
+    if (pitch > 127 * SYNTH_PITCH_ONE) pitch = 127 * SYNTH_PITCH_ONE;
+    if (pressure < 0) pressure = 0;
+    if (pressure > 127) pressure = 127;
+
+    v->pitch = pitch;
+    v->bow_target = pressure ? BOW_MIN_VELOCITY + (pressure * BOW_VELOCITY_RANGE) / 127 : 0;
+}
+
+void HOT_PATH(synth_set_modulation)(synth_t *synth, int16_t modulation) {
+    if (modulation < 0) modulation = 0;
+    if (modulation > 127) modulation = 127;
+    synth->vibrato_depth = (modulation * (SYNTH_PITCH_ONE / 2)) / 127;
+}
+
+int32_t HOT_PATH(synth_period_q16)(int32_t pitch) {
+    // Octaves and quarter-semitone steps below A4
+    int32_t below = 69 * SYNTH_PITCH_ONE - pitch;
+    int32_t octave = below >= 0 ? below / (12 * SYNTH_PITCH_ONE)
+                                : -((-below + 12 * SYNTH_PITCH_ONE - 1) / (12 * SYNTH_PITCH_ONE));
+    int32_t rem = below - octave * 12 * SYNTH_PITCH_ONE;
+    int32_t step = rem >> 6;
+    int32_t frac = rem & 0x3F;
+    uint32_t ratio = pow2_table[step] + (((pow2_table[step + 1] - pow2_table[step]) * frac) >> 6);
+
+    int64_t period = ((int64_t)PERIOD_A4_Q16 * ratio) >> 16;
+    if (octave >= 0) {
+        period <<= octave;
+    } else {
+        period >>= -octave;
+    }
+    return period > INT32_MAX ? INT32_MAX : period;
+}
+
+// Render one block of one voice, adding into mix
+static void HOT_PATH(render_voice)(synth_voice_t *v, uint16_t write, int32_t pitch, int32_t *mix) {
+    int32_t delay = synth_period_q16(pitch) - LOOP_DELAY_Q16;
+    int32_t bridge_delay = ((int64_t)delay * BOW_POSITION_Q16) >> 16;
+    int32_t neck_delay = delay - bridge_delay;
+    if (bridge_delay < MIN_DELAY_Q16) bridge_delay = MIN_DELAY_Q16;
+    if (neck_delay < MIN_DELAY_Q16) neck_delay = MIN_DELAY_Q16;
+    if (neck_delay > MAX_DELAY_Q16) neck_delay = MAX_DELAY_Q16;
+
+    // Ramp the bow velocity across the block to avoid zipper noise
+    int32_t bow = v->bow_velocity;
+    int32_t bow_step = (v->bow_target - bow) / SYNTH_BLOCK;
+
+    for (int i = 0; i < SYNTH_BLOCK; i++, write++) {
+        bow += bow_step;
+        int32_t nut_reflection = -delay_read(v->neck, write, neck_delay);
+        int32_t bridge_out = delay_read(v->bridge, write, bridge_delay);
+        v->lowpass += ((bridge_out - v->lowpass) * LOSS_COEF + ROUND_Q15) >> 15;
+        int32_t bridge_reflection = -((v->lowpass * BRIDGE_GAIN + ROUND_Q15) >> 15);
+
+        // Bow-string interaction at the bow point
+        int32_t difference = bow - (bridge_reflection + nut_reflection);
+        int32_t velocity = (difference * friction(difference) + ROUND_Q15) >> 15;
+
+        v->neck[write & DELAY_MASK] = saturate16(bridge_reflection + velocity);
+        v->bridge[write & DELAY_MASK] = saturate16(nut_reflection + velocity);
+        mix[i] += bridge_out;
+    }
+    v->bow_velocity = v->bow_target;
+}
+
+void HOT_PATH(synth_render)(synth_t *synth, int16_t *out, int frames) {
+    for (int block = 0; block < frames; block += SYNTH_BLOCK) {
+        int32_t mix[SYNTH_BLOCK] = {0};
+        int32_t vibrato = (synth->vibrato_depth * lfo_q15(synth->lfo_phase)) >> 15;
+
+        for (int v = 0; v < SYNTH_NUM_VOICES; v++) {
+            render_voice(&synth->voices[v], synth->write, synth->voices[v].pitch + vibrato, mix);
+        }
+        for (int i = 0; i < SYNTH_BLOCK; i++) {
+            out[block + i] = saturate16(mix[i]);
+        }
+
+        synth->write += SYNTH_BLOCK;
+        synth->lfo_phase += LFO_STEP;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef _SYNTH_H_
+#define _SYNTH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file synth.h
+ * \brief Fixed-point bowed-string synthesiser
+ *
+ * One digital waveguide voice per string, after the classic bowed-string
+ * model: the string is two delay lines meeting at the bow point, with an
+ * inverting nut, a lossy low-passed bridge and a friction curve coupling the
+ * bow to the string. The bow velocity follows the key pressure, the delay
+ * lengths follow the note plus bend, and the modulation controller adds a
+ * 5.5 Hz vibrato.
+ *
+ * The per-sample path is integer only (Q15 samples, Q16 delay lengths).
+ * Control changes are applied once per SYNTH_BLOCK samples, with the bow
+ * velocity ramped across the block. On the Pico the synth renders on core 1
+ * into the PWM audio buffers (synth_audio.h); host/synth_render renders the
+ * same voices into a WAV file.
+*/
+
+#define SYNTH_SAMPLE_RATE 48000
+#define SYNTH_NUM_VOICES 4
+#define SYNTH_BLOCK 32                  // Samples per control update
+#define SYNTH_DELAY_BITS 10
+#define SYNTH_DELAY_SIZE (1 << SYNTH_DELAY_BITS)
+#define SYNTH_PITCH_ONE 256             // Pitch units per semitone
+
+typedef struct synth_voice {
+    int16_t neck[SYNTH_DELAY_SIZE];     // Bow to nut and back
+    int16_t bridge[SYNTH_DELAY_SIZE];   // Bow to bridge and back
+    int32_t pitch;                      // MIDI note, SYNTH_PITCH_ONE per semitone
+    int32_t bow_target;                 // Bow velocity to reach, Q15
+    int32_t bow_velocity;               // Current bow velocity, Q15
+    int32_t lowpass;                    // Bridge loss filter state, Q15
+} synth_voice_t;
+
+typedef struct synth {
+    synth_voice_t voices[SYNTH_NUM_VOICES];
+    uint16_t write;                     // Shared delay line write position
+    uint32_t lfo_phase;                 // Vibrato phase, full turn = 2^32
+    int16_t vibrato_depth;              // Pitch units at the LFO peak
+} synth_t;
+
+/*! \brief Silence all voices and clear the strings
+ *
+ * \param synth Synthesiser
+ */
+void synth_init(synth_t *synth);
+
+/*! \brief Set what one string plays
+ *
+ * \param synth Synthesiser
+ * \param voice String number, 0 to SYNTH_NUM_VOICES - 1
+ * \param pitch MIDI note including bend, SYNTH_PITCH_ONE per semitone
+ * \param pressure Bow pressure 0-127; 0 lifts the bow and the string rings
+ * out
+ */
+void synth_set_voice(synth_t *synth, int voice, int32_t pitch, int16_t pressure);
+
+/*! \brief Set the vibrato depth from the modulation controller
+ *
+ * \param synth Synthesiser
+ * \param modulation 0-127, full scale is half a semitone either way
+ */
+void synth_set_modulation(synth_t *synth, int16_t modulation);
+
+/*! \brief Delay loop length for a pitch
+ *
+ * \param pitch MIDI note, SYNTH_PITCH_ONE per semitone
+ * \return Period in samples at SYNTH_SAMPLE_RATE, Q16
+ */
+int32_t synth_period_q16(int32_t pitch);
+
+/*! \brief Render mono audio
+ *
+ * \param synth Synthesiser
+ * \param out Buffer to receive the samples
+ * \param frames Number of samples, a multiple of SYNTH_BLOCK
+ */
+void synth_render(synth_t *synth, int16_t *out, int frames);
+
+#endif
@@ -0,0 +1,156 @@
+#include "synth_audio.h"
+#include "hot_path.h"
+
+static synth_audio_stats_t stats;
+
+#if STRADEX_SYNTH
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+// Parameters handed from core 0 to core 1 under a sequence counter: odd
+// while core 0 is writing, so core 1 can tell a torn copy and retry later
+static synth_params_t shared_params;
+static volatile uint32_t shared_sequence;
+
+static synth_t synth;
+static uint32_t buffers[2][SYNTH_AUDIO_FRAMES];    // PWM compare values
+static volatile bool buffer_free[2];
+static int dma_channels[2];
+static uint32_t pwm_wrap;
+
+void HOT_PATH(synth_audio_update)(const synth_params_t *params) {
+    shared_sequence++;
+    __dmb();
+    shared_params = *params;
+    __dmb();
+    shared_sequence++;
+}
+
+static bool HOT_PATH(read_params)(synth_params_t *params) {
+    uint32_t sequence = shared_sequence;
+    if (sequence & 1) return false;
+    __dmb();
+    *params = shared_params;
+    __dmb();
+    return shared_sequence == sequence;
+}
+
+// Runs on core 1. A finished buffer is handed back for rendering; if the
+// other one, which DMA has just chained to, was never refilled, it plays
+// again and that is an underrun.
+static void __isr HOT_PATH(dma_handler)() {
+    for (int i = 0; i < 2; i++) {
+        if (dma_channel_get_irq1_status(dma_channels[i])) {
+            dma_channel_acknowledge_irq1(dma_channels[i]);
+            dma_channel_set_read_addr(dma_channels[i], buffers[i], false);
+            if (buffer_free[i ^ 1]) {
+                stats.underruns++;
+            }
+            buffer_free[i] = true;
+        }
+    }
+    __sev();
+}
+
+static void audio_init() {
+    uint slice = pwm_gpio_to_slice_num(SYNTH_AUDIO_PIN);
+    gpio_set_function(SYNTH_AUDIO_PIN, GPIO_FUNC_PWM);
+    pwm_wrap = clock_get_hz(clk_sys) / SYNTH_SAMPLE_RATE - 1;
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_wrap(&config, pwm_wrap);
+    pwm_init(slice, &config, true);
+
+    // Start from silence: both halves of the compare register at mid level
+    for (int i = 0; i < 2; i++) {
+        for (int n = 0; n < SYNTH_AUDIO_FRAMES; n++) {
+            buffers[i][n] = (pwm_wrap / 2) * 0x10001;
+        }
+        buffer_free[i] = true;
+        dma_channels[i] = dma_claim_unused_channel(true);
+    }
+
+    // Two channels chained to each other, paced by the PWM wrap
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config c = dma_channel_get_default_config(dma_channels[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, pwm_get_dreq(slice));
+        channel_config_set_chain_to(&c, dma_channels[i ^ 1]);
+        dma_channel_configure(dma_channels[i], &c, &pwm_hw->slice[slice].cc, buffers[i],
+                              SYNTH_AUDIO_FRAMES, false);
+        dma_channel_set_irq1_enabled(dma_channels[i], true);
+    }
+    irq_set_exclusive_handler(DMA_IRQ_1, dma_handler);
+    irq_set_enabled(DMA_IRQ_1, true);
+    dma_channel_start(dma_channels[0]);
+}
+
+static void HOT_PATH(core1_main)() {
+    int16_t samples[SYNTH_AUDIO_FRAMES];
+    synth_params_t params;
+    uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+
+    // Let core 0 park this core while it writes the config store
+    // (config_flash.c); the DMA keeps repeating the last buffer meanwhile
+    flash_safe_execute_core_init();
+
+    synth_init(&synth);
+    audio_init();
+
+    int next = 0;
+    while (true) {
+        while (!buffer_free[next]) {
+            __wfe();
+        }
+
+        uint32_t start = time_us_32();
+        if (read_params(&params)) {
+            for (int v = 0; v < SYNTH_NUM_VOICES; v++) {
+                synth_set_voice(&synth, v, params.pitch[v], params.pressure[v]);
+            }
+            synth_set_modulation(&synth, params.modulation);
+        }
+        synth_render(&synth, samples, SYNTH_AUDIO_FRAMES);
+
+        // Signed samples to PWM levels, on both channels of the slice
+        for (int n = 0; n < SYNTH_AUDIO_FRAMES; n++) {
+            uint32_t level = ((uint32_t)(samples[n] + 32768) * (pwm_wrap + 1)) >> 16;
+            buffers[next][n] = level * 0x10001;
+        }
+        buffer_free[next] = false;
+        next ^= 1;
+
+        uint32_t cycles = (time_us_32() - start) * cycles_per_us;
+        if (cycles > stats.render_cycles_max) {
+            stats.render_cycles_max = cycles;
+        }
+        stats.blocks++;
+    }
+}
+
+void synth_audio_start(void) {
+    multicore_launch_core1(core1_main);
+}
+
+#else
+
+void synth_audio_start(void) {
+}
+
+void synth_audio_update(const synth_params_t *params) {
+    (void) params;
+}
+
+#endif
+
+const synth_audio_stats_t *synth_audio_get_stats(void) {
+    return &stats;
+}
@@ -0,0 +1,50 @@
+#ifndef _SYNTH_AUDIO_H_
+#define _SYNTH_AUDIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "synth.h"
+
+/** \file synth_audio.h
+ * \brief Standalone audio output: the bowed-string synth on core 1
+ *
+ * Built with STRADEX_SYNTH. Core 1 renders synth.h into one half of a
+ * double buffer while DMA plays the other half out of a PWM pin at
+ * 48 kHz (filter the pin with a simple RC low-pass). Core 0 only publishes
+ * the interpreted state with synth_audio_update(); it never waits for
+ * core 1. Without STRADEX_SYNTH these calls do nothing.
+*/
+
+#define SYNTH_AUDIO_PIN 20
+#define SYNTH_AUDIO_FRAMES 64           // Samples per DMA buffer, 1.3 ms
+
+/*! \brief What the synth should play, published by core 0 */
+typedef struct synth_params {
+    int32_t pitch[SYNTH_NUM_VOICES];    // See synth_set_voice()
+    int16_t pressure[SYNTH_NUM_VOICES];
+    int16_t modulation;
+} synth_params_t;
+
+typedef struct synth_audio_stats {
+    uint32_t blocks;                    // Buffers rendered
+    uint32_t underruns;                 // Buffers replayed because core 1 was late
+    uint32_t render_cycles_max;         // Worst buffer, in system clock cycles
+} synth_audio_stats_t;
+
+/*! \brief Launch the synth on core 1 and start the audio output
+ */
+void synth_audio_start(void);
+
+/*! \brief Publish new synth parameters
+ *
+ * Lock-free: core 1 picks up the latest complete set at its next buffer.
+ *
+ * \param params Parameters to publish
+ */
+void synth_audio_update(const synth_params_t *params);
+
+/*! \brief Rendering statistics, all zero without STRADEX_SYNTH
+ */
+const synth_audio_stats_t *synth_audio_get_stats(void);
+
+#endif
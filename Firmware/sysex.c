@@ -0,0 +1,269 @@
+#include "sysex.h"
+#include <string.h>
+
+#define PARAM(field, param_id, lo, hi) \
+    { #field, param_id, sizeof(((stradex_config_t *)0)->field) / sizeof(int16_t), \
+      offsetof(stradex_config_t, field), lo, hi }
+
+const sysex_param_t sysex_params[] = {
+    PARAM(fsr_min_value, 0x00, 0, 32767),
+    PARAM(fsr_max_value, 0x01, 0, 32767),
+    PARAM(volume_min, 0x02, 0, 127),
+    PARAM(volume_max, 0x03, 0, 127),
+    PARAM(tuning_center_value, 0x04, 0, 32767),
+    PARAM(tuning_min_value, 0x05, 0, 32767),
+    PARAM(tuning_max_value, 0x06, 1, 32767),
+    PARAM(tuning_range, 0x07, 0, 48),
+    PARAM(fret_hysteresis, 0x08, 0, 2000),
+    PARAM(softpot_deviation_max, 0x09, 1, 8000),
+    PARAM(pitchbend_max_range, 0x0A, 0, 8191),
+    PARAM(fsr_adapt_shift, 0x0B, 0, 15),
+    PARAM(play_mode, 0x0C, PLAY_MODE_FRETTED, PLAY_MODE_GLIDE),
+    PARAM(glide_bend_range, 0x0D, 1, 24),
+    PARAM(legato_mode, 0x0E, LEGATO_OFF, LEGATO_BEND),
+    PARAM(legato_velocity, 0x0F, 0, 127),
+    PARAM(vibrato_rate_cc, 0x10, 0, 119),
+    PARAM(vibrato_depth_cc, 0x11, 0, 119),
+    PARAM(vibrato_resynth, 0x12, 0, 1),
+    PARAM(bend_interp_mode, 0x13, 0, 2),
+    PARAM(bend_interp_us, 0x14, 500, 20000),
+    PARAM(softpot_touch_threshold, 0x15, 0, 32767),
+    PARAM(softpot_max_slew, 0x16, 0, 32767),
+    PARAM(pot_hysteresis, 0x17, 0, 2000),
+    PARAM(i2c_speed, 0x18, 0, 3),
+    PARAM(cc14_controllers, 0x19, 0, 15),
+    PARAM(cc14_noise_gain, 0x1A, 1, 16),
+    PARAM(idle_timeout_s, 0x1B, 0, 3600),
+    PARAM(idle_wake_margin, 0x1C, 1, 32767),
+    PARAM(serial_cc_interval_ms, 0x1D, 0, 1000),
+    PARAM(base_notes, 0x20, 0, 127),
+    PARAM(fret_positions, 0x30, 0, 32767)
+};
+
+const uint8_t sysex_num_params = sizeof(sysex_params) / sizeof(sysex_params[0]);
+
+bool sysex_parse(sysex_parser_t *parser, uint8_t byte) {
+    // Realtime messages may be interleaved anywhere
+    if (byte >= 0xF8) return false;
+
+    if (byte == SYSEX_START) {
+        parser->in_message = true;
+        parser->overflow = false;
+        parser->length = 0;
+        return false;
+    }
+    if (!parser->in_message) return false;
+
+    if (byte == SYSEX_END) {
+        parser->in_message = false;
+        return !parser->overflow
+            && parser->length >= 3
+            && parser->buffer[0] == SYSEX_MANUFACTURER
+            && parser->buffer[1] == SYSEX_DEVICE;
+    }
+    if (byte & 0x80) {
+        // Any other status byte ends the message without completing it
+        parser->in_message = false;
+        return false;
+    }
+
+    if (parser->length < SYSEX_MAX_LENGTH) {
+        parser->buffer[parser->length++] = byte;
+    } else {
+        parser->overflow = true;
+    }
+    return false;
+}
+
+bool sysex_queue_push(sysex_reply_queue_t *queue, const uint8_t *msg, uint32_t len) {
+    if ((uint32_t)(SYSEX_REPLY_QUEUE_SIZE - (uint16_t)(queue->head - queue->tail)) < len) {
+        queue->dropped++;
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        queue->buffer[queue->head++ % SYSEX_REPLY_QUEUE_SIZE] = msg[i];
+    }
+    return true;
+}
+
+uint32_t sysex_queue_peek(const sysex_reply_queue_t *queue, const uint8_t **data) {
+    uint16_t start = queue->tail % SYSEX_REPLY_QUEUE_SIZE;
+    uint16_t pending = queue->head - queue->tail;
+    uint32_t count = 0;
+
+    // Up to the end of this reply or of the buffer, whichever comes first
+    *data = &queue->buffer[start];
+    while (count < pending && start + count < SYSEX_REPLY_QUEUE_SIZE) {
+        if (queue->buffer[start + count++] == SYSEX_END) break;
+    }
+    return count;
+}
+
+void sysex_queue_consume(sysex_reply_queue_t *queue, uint32_t count) {
+    if (count == 0) return;
+    queue->tail += count;
+    queue->open = queue->buffer[(uint16_t)(queue->tail - 1) % SYSEX_REPLY_QUEUE_SIZE] != SYSEX_END;
+}
+
+void sysex_queue_clear(sysex_reply_queue_t *queue) {
+    queue->tail = queue->head;
+    queue->open = false;
+}
+
+const sysex_param_t *sysex_find_param(uint8_t id, uint8_t *index) {
+    for (int i = 0; i < sysex_num_params; i++) {
+        const sysex_param_t *param = &sysex_params[i];
+        if (id >= param->id && id < param->id + param->count) {
+            *index = id - param->id;
+            return param;
+        }
+    }
+    return NULL;
+}
+
+const sysex_param_t *sysex_find_param_by_name(const char *name) {
+    for (int i = 0; i < sysex_num_params; i++) {
+        if (strcmp(sysex_params[i].name, name) == 0) return &sysex_params[i];
+    }
+    return NULL;
+}
+
+void sysex_encode_value(int16_t value, uint8_t *out) {
+    uint16_t bits = (uint16_t)value;
+    out[0] = (bits >> 14) & 0x03;
+    out[1] = (bits >> 7) & 0x7F;
+    out[2] = bits & 0x7F;
+}
+
+int16_t sysex_decode_value(const uint8_t *in) {
+    return (int16_t)(((in[0] & 0x03) << 14) | ((in[1] & 0x7F) << 7) | (in[2] & 0x7F));
+}
+
+uint32_t sysex_build(uint8_t command, const uint8_t *payload, uint32_t payload_len,
+                     uint8_t *out) {
+    out[0] = SYSEX_START;
+    out[1] = SYSEX_MANUFACTURER;
+    out[2] = SYSEX_DEVICE;
+    out[3] = command;
+    memcpy(&out[4], payload, payload_len);
+    out[4 + payload_len] = SYSEX_END;
+    return payload_len + 5;
+}
+
+static int16_t *param_field(stradex_config_t *cfg, const sysex_param_t *param, uint8_t index) {
+    return (int16_t *)((uint8_t *)cfg + param->offset) + index;
+}
+
+static int16_t param_value(const sysex_param_t *param, uint8_t index) {
+    const int16_t *field = (const int16_t *)((const uint8_t *)config_latest() + param->offset);
+    return field[index];
+}
+
+static void reply_value(const sysex_hooks_t *hooks, uint8_t id, int16_t value) {
+    uint8_t payload[4];
+    uint8_t msg[4 + 5];
+    payload[0] = id;
+    sysex_encode_value(value, &payload[1]);
+    hooks->reply(msg, sysex_build(SYSEX_REPLY_VALUE, payload, sizeof(payload), msg));
+}
+
+static void reply_ack(const sysex_hooks_t *hooks, uint8_t command, uint8_t status) {
+    uint8_t payload[2] = {command, status};
+    uint8_t msg[2 + 5];
+    hooks->reply(msg, sysex_build(SYSEX_REPLY_ACK, payload, sizeof(payload), msg));
+}
+
+static void reply_stats(const sysex_hooks_t *hooks, uint8_t start) {
+    uint32_t counters[SYSEX_MAX_STATS];
+    uint8_t total = hooks->stats ? hooks->stats(counters, SYSEX_MAX_STATS) : 0;
+    uint8_t count = start < total ? total - start : 0;
+    if (count > SYSEX_STATS_PER_REPLY) count = SYSEX_STATS_PER_REPLY;
+
+    // Each counter as five 7-bit groups, most significant first
+    uint8_t payload[3 + SYSEX_STATS_PER_REPLY * 5];
+    uint8_t msg[sizeof(payload) + 5];
+    payload[0] = start;
+    payload[1] = count;
+    payload[2] = total;
+    for (int i = 0; i < count; i++) {
+        for (int k = 0; k < 5; k++) {
+            payload[3 + i * 5 + k] = (counters[start + i] >> (28 - 7 * k)) & 0x7F;
+        }
+    }
+    hooks->reply(msg, sysex_build(SYSEX_REPLY_STATS, payload, 3 + count * 5, msg));
+}
+
+void sysex_handle(const sysex_parser_t *parser, const sysex_hooks_t *hooks) {
+    const uint8_t *data = &parser->buffer[3];
+    uint8_t data_len = parser->length - 3;
+    uint8_t command = parser->buffer[2];
+    const sysex_param_t *param;
+    uint8_t index;
+
+    switch (command) {
+        case SYSEX_CMD_GET:
+            if (data_len < 1) {
+                reply_ack(hooks, command, SYSEX_STATUS_BAD_MESSAGE);
+            } else if (!(param = sysex_find_param(data[0], &index))) {
+                reply_ack(hooks, command, SYSEX_STATUS_UNKNOWN_PARAM);
+            } else {
+                reply_value(hooks, data[0], param_value(param, index));
+            }
+            break;
+
+        case SYSEX_CMD_SET: {
+            if (data_len < 4) {
+                reply_ack(hooks, command, SYSEX_STATUS_BAD_MESSAGE);
+                break;
+            }
+            if (!(param = sysex_find_param(data[0], &index))) {
+                reply_ack(hooks, command, SYSEX_STATUS_UNKNOWN_PARAM);
+                break;
+            }
+            int16_t value = sysex_decode_value(&data[1]);
+            if (value < param->min || value > param->max) {
+                reply_ack(hooks, command, SYSEX_STATUS_OUT_OF_RANGE);
+                break;
+            }
+            stradex_config_t *shadow = config_begin_edit();
+            int16_t *field = param_field(shadow, param, index);
+            int16_t previous = *field;
+            *field = value;
+            if (!config_check(shadow)) {
+                *field = previous;
+                reply_ack(hooks, command, SYSEX_STATUS_CONFLICT);
+                break;
+            }
+            config_publish();
+            reply_ack(hooks, command, SYSEX_STATUS_OK);
+            break;
+        }
+
+        case SYSEX_CMD_DUMP:
+            for (int i = 0; i < sysex_num_params; i++) {
+                for (int k = 0; k < sysex_params[i].count; k++) {
+                    reply_value(hooks, sysex_params[i].id + k, param_value(&sysex_params[i], k));
+                }
+            }
+            break;
+
+        case SYSEX_CMD_STATS:
+            reply_stats(hooks, data_len >= 1 ? data[0] : 0);
+            break;
+
+        case SYSEX_CMD_STORE:
+            reply_ack(hooks, command, hooks->store && hooks->store(config_latest())
+                      ? SYSEX_STATUS_OK : SYSEX_STATUS_FAILED);
+            break;
+
+        case SYSEX_CMD_DEFAULTS:
+            *config_begin_edit() = config_defaults;
+            config_publish();
+            reply_ack(hooks, command, SYSEX_STATUS_OK);
+            break;
+
+        default:
+            reply_ack(hooks, command, SYSEX_STATUS_BAD_MESSAGE);
+            break;
+    }
+}
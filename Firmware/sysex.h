@@ -0,0 +1,165 @@
+#ifndef _SYSEX_H_
+#define _SYSEX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+/** \file sysex.h
+ * \brief SysEx protocol for live parameter get/set/dump and statistics
+ *
+ * Every message is framed as
+ *
+ *     F0 7D 53 <command> <payload...> F7
+ *
+ * (7D is the non-commercial manufacturer ID, 53 is 'S'). Parameter values
+ * are signed 16-bit, sent as three 7-bit bytes, most significant first.
+ * Sets land in the shadow configuration (config_begin_edit()) and are swapped
+ * in by the main loop at the next frame boundary. Get, dump and store see a
+ * set straight away (config_latest()). A set that would leave the
+ * configuration inconsistent (config_check()) is refused, so related
+ * parameters have to be changed in an order that keeps every step valid.
+ *
+ * Replies are queued whole (sysex_reply_queue_t) and drained into the USB
+ * MIDI FIFO over as many loop passes as they need. Statistics come in pages
+ * of SYSEX_STATS_PER_REPLY counters, so each reply fits the FIFO in one go;
+ * the host asks for the next page until it has all <total> counters.
+ *
+ * Portable C, the host CLI uses the same encoder and parameter table.
+*/
+
+#define SYSEX_START 0xF0
+#define SYSEX_END 0xF7
+#define SYSEX_MANUFACTURER 0x7D
+#define SYSEX_DEVICE 0x53
+#define SYSEX_MAX_LENGTH 128
+#define SYSEX_MAX_STATS 64          // Counters the stats hook can fill in
+#define SYSEX_STATS_PER_REPLY 8     // Counters per stats reply, 64 bytes as USB MIDI packets
+#define SYSEX_REPLY_QUEUE_SIZE 1024 // Bytes of queued replies, a full dump fits; power of 2
+
+enum sysex_command {
+    // Host to device
+    SYSEX_CMD_GET = 0x01,       // <param>
+    SYSEX_CMD_SET = 0x02,       // <param> <value:3>
+    SYSEX_CMD_DUMP = 0x03,      // Every parameter as SYSEX_REPLY_VALUE
+    SYSEX_CMD_STATS = 0x04,     // [<start>] Statistics counters from start (default 0)
+    SYSEX_CMD_STORE = 0x05,     // Persist the configuration, pending sets included, to flash
+    SYSEX_CMD_DEFAULTS = 0x06,  // Revert every parameter to the defaults
+
+    // Device to host
+    SYSEX_REPLY_VALUE = 0x11,   // <param> <value:3>
+    SYSEX_REPLY_ACK = 0x12,     // <command> <status>
+    SYSEX_REPLY_STATS = 0x14    // <start> <count> <total> <counter:5>...
+};
+
+enum sysex_status {
+    SYSEX_STATUS_OK = 0x00,
+    SYSEX_STATUS_UNKNOWN_PARAM = 0x01,
+    SYSEX_STATUS_OUT_OF_RANGE = 0x02,
+    SYSEX_STATUS_BAD_MESSAGE = 0x03,
+    SYSEX_STATUS_FAILED = 0x04,
+    SYSEX_STATUS_CONFLICT = 0x05    // In range, but inconsistent with other parameters
+};
+
+typedef struct sysex_param {
+    const char *name;
+    uint8_t id;         // First parameter ID, arrays take one ID per element
+    uint8_t count;      // Number of elements
+    uint16_t offset;    // Offset of the int16_t field in stradex_config_t
+    int16_t min, max;
+} sysex_param_t;
+
+typedef struct sysex_parser {
+    uint8_t buffer[SYSEX_MAX_LENGTH];
+    uint8_t length;
+    bool in_message;
+    bool overflow;
+} sysex_parser_t;
+
+// Replies waiting for room in the USB MIDI FIFO. A reply is queued whole or
+// not at all, and can leave in pieces.
+typedef struct sysex_reply_queue {
+    uint8_t buffer[SYSEX_REPLY_QUEUE_SIZE];
+    uint16_t head;      // Free-running: bytes queued
+    uint16_t tail;      // Free-running: bytes sent
+    bool open;          // A reply is part-way out
+    uint32_t dropped;   // Replies that didn't fit
+} sysex_reply_queue_t;
+
+typedef struct sysex_hooks {
+    // Send one complete SysEx message back to the host
+    void (*reply)(const uint8_t *msg, uint32_t len);
+    // Persist a configuration, the latest edits included (config_latest());
+    // may be NULL
+    bool (*store)(const stradex_config_t *cfg);
+    // Fill in statistics counters, returns how many were written; may be NULL
+    uint8_t (*stats)(uint32_t *counters, uint8_t max_counters);
+} sysex_hooks_t;
+
+extern const sysex_param_t sysex_params[];
+extern const uint8_t sysex_num_params;
+
+/*! \brief Feed one received MIDI byte to the parser
+ *
+ * Realtime bytes are ignored, any other status byte aborts a message.
+ *
+ * \return true when a complete SysEx message for this device is buffered
+ */
+bool sysex_parse(sysex_parser_t *parser, uint8_t byte);
+
+/*! \brief Handle a complete message buffered by sysex_parse()
+ */
+void sysex_handle(const sysex_parser_t *parser, const sysex_hooks_t *hooks);
+
+/*! \brief Queue one complete reply
+ *
+ * \return false if it doesn't fit, in which case nothing is queued
+ */
+bool sysex_queue_push(sysex_reply_queue_t *queue, const uint8_t *msg, uint32_t len);
+
+/*! \brief Get the next bytes to send
+ *
+ * Never runs past the end of the reply being sent, so a caller that sends
+ * everything it gets has finished that reply.
+ *
+ * \param data Receives a pointer to the bytes
+ * \return Number of contiguous bytes, 0 if the queue is empty
+ */
+uint32_t sysex_queue_peek(const sysex_reply_queue_t *queue, const uint8_t **data);
+
+/*! \brief Release bytes that have been sent
+ *
+ * \param count At most what sysex_queue_peek() returned
+ */
+void sysex_queue_consume(sysex_reply_queue_t *queue, uint32_t count);
+
+/*! \brief Drop everything queued, e.g. when the host goes away
+ */
+void sysex_queue_clear(sysex_reply_queue_t *queue);
+
+/*! \brief Find a parameter by ID
+ *
+ * \param index Receives the element index for array parameters
+ */
+const sysex_param_t *sysex_find_param(uint8_t id, uint8_t *index);
+
+/*! \brief Find a parameter by name, e.g. "fret_positions" or "fret_hysteresis"
+ */
+const sysex_param_t *sysex_find_param_by_name(const char *name);
+
+/*! \brief Split a signed 16-bit value into three 7-bit bytes
+ */
+void sysex_encode_value(int16_t value, uint8_t *out);
+
+/*! \brief Join three 7-bit bytes back into a signed 16-bit value
+ */
+int16_t sysex_decode_value(const uint8_t *in);
+
+/*! \brief Build a complete message into out
+ *
+ * \return Message length, including F0 and F7
+ */
+uint32_t sysex_build(uint8_t command, const uint8_t *payload, uint32_t payload_len,
+                     uint8_t *out);
+
+#endif
@@ -0,0 +1,61 @@
+#include "telemetry.h"
+#include "tusb.h"
+#include "pico/stdlib.h"
+
+#if CFG_TUD_VENDOR
+
+_Static_assert(TELEMETRY_PERIOD_BYTES <= CFG_TUD_VENDOR_TX_BUFSIZE,
+               "one period's telemetry frames must fit in the vendor FIFO together");
+
+static uint32_t last_frame_us;
+static uint16_t sequence;
+static uint16_t dropped;
+
+bool telemetry_due(uint32_t now_us) {
+    if (!tud_vendor_mounted()) return false;
+    if (now_us - last_frame_us < TELEMETRY_PERIOD_US) return false;
+
+    last_frame_us = now_us;
+    return true;
+}
+
+bool telemetry_send(uint8_t type, const void *payload, uint8_t length) {
+    if (!tud_vendor_mounted()) return false;
+
+    // Never wait for the host: drop the frame if it doesn't fit in the FIFO
+    if (tud_vendor_write_available() < sizeof(telemetry_header_t) + length) {
+        dropped++;
+        return false;
+    }
+
+    telemetry_header_t header = {
+        .magic = TELEMETRY_MAGIC,
+        .type = type,
+        .length = length,
+        .timestamp_us = time_us_32(),
+        .sequence = sequence++,
+        .dropped = dropped
+    };
+    dropped = 0;
+
+    tud_vendor_write(&header, sizeof(header));
+    tud_vendor_write(payload, length);
+    tud_vendor_write_flush();
+    return true;
+}
+
+#else
+
+bool telemetry_due(uint32_t now_us) {
+    (void) now_us;
+    return false;
+}
+
+bool telemetry_send(uint8_t type, const void *payload, uint8_t length) {
+    (void) type;
+    (void) payload;
+    (void) length;
+    return false;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file telemetry.h
+ * \brief Live telemetry frames on the vendor bulk interface
+ *
+ * Only active in the composite build (STRADEX_TELEMETRY). Frames are
+ * best effort: when the vendor FIFO has no room the frame is dropped and
+ * counted, the caller is never blocked.
+ *
+ * Everything sent in one period has to fit in the vendor TX FIFO at once,
+ * 256 bytes at full speed. The sensor, profile, XIP and MIDI frames go out
+ * every period; the slow counters (idle, serial MIDI, calibration, softpot) take
+ * turns in one more slot. The boot frame has priority: while a boot phase
+ * is unreported it is sent alone, period after period, until it fits.
+ * TELEMETRY_PERIOD_BYTES is the larger of the two bursts, and telemetry.c
+ * checks it against the FIFO at compile time, so a new frame that would
+ * crowd out the others breaks the build instead.
+*/
+
+#define TELEMETRY_MAGIC 0x5331 // "S1"
+#define TELEMETRY_PERIOD_US 10000 // 100 frames per second at most
+
+enum telemetry_frame_type {
+    TELEMETRY_FRAME_SENSORS = 1,
+    TELEMETRY_FRAME_PROFILE = 2,
+    TELEMETRY_FRAME_MIDI = 3,
+    TELEMETRY_FRAME_XIP = 4,
+    TELEMETRY_FRAME_BOOT = 5,
+    TELEMETRY_FRAME_IDLE = 6,
+    TELEMETRY_FRAME_SERIAL_MIDI = 7,
+    TELEMETRY_FRAME_CALIBRATION = 8,
+    TELEMETRY_FRAME_SOFTPOT = 9
+};
+
+typedef struct __attribute__((packed)) telemetry_header {
+    uint16_t magic;
+    uint8_t type;
+    uint8_t length;         // Payload length in bytes
+    uint32_t timestamp_us;
+    uint16_t sequence;
+    uint16_t dropped;       // Frames dropped since the last one that went out
+} telemetry_header_t;
+
+// Raw ADC readings plus the values the interpreter derived from them
+typedef struct __attribute__((packed)) telemetry_sensor_frame {
+    int16_t raw[8];             // First eight sensor map entries, see main.c
+    int16_t softpot_filtered;
+    uint8_t buttons;
+    int8_t fret;
+    int16_t note;
+    int16_t pitch_bend;
+    int16_t volume;
+    int16_t modulation;
+    int16_t tuning_offset;
+} telemetry_sensor_frame_t;
+
+// Main loop profiler counters, reset every time a frame is sent
+typedef struct __attribute__((packed)) telemetry_profile_frame {
+    uint32_t loops;
+    uint32_t loop_us_total;
+    uint32_t loop_us_max;
+    uint32_t scans_completed;
+} telemetry_profile_frame_t;
+
+// XIP cache counters per main loop stage (xip_profile.h), reset every time a
+// frame is sent
+#define TELEMETRY_XIP_STAGES 5
+typedef struct __attribute__((packed)) telemetry_xip_frame {
+    uint32_t accesses[TELEMETRY_XIP_STAGES];
+    uint32_t misses[TELEMETRY_XIP_STAGES];
+    uint32_t misses_max[TELEMETRY_XIP_STAGES]; // Worst single pass through the stage
+    uint32_t pass_misses_max;                   // Worst loop pass, all stages
+} telemetry_xip_frame_t;
+
+// Running MIDI queue counters (see midi_out.h)
+typedef struct __attribute__((packed)) telemetry_midi_frame {
+    uint32_t messages;
+    uint32_t bytes;
+    uint32_t dropped_bytes;
+    uint32_t unmounted;
+} telemetry_midi_frame_t;
+
+// Boot phase timestamps (boot_log.h) in microseconds since reset, 0 for a
+// phase not reached. Sent whenever another phase has been reached.
+#define TELEMETRY_BOOT_PHASES 9
+typedef struct __attribute__((packed)) telemetry_boot_frame {
+    uint32_t boots;                             // Since power-on
+    uint32_t phase_us[TELEMETRY_BOOT_PHASES];   // This boot
+    uint32_t previous_us[TELEMETRY_BOOT_PHASES]; // The boot before, if it was reset
+} telemetry_boot_frame_t;
+
+// Idle scanning counters (idle.h)
+typedef struct __attribute__((packed)) telemetry_idle_frame {
+    uint32_t entries;
+    uint32_t wakes;
+    uint32_t false_alerts;
+    uint32_t wake_us_last;      // Wake-up edge to the first full scan after it
+    uint32_t wake_us_max;
+} telemetry_idle_frame_t;
+
+// Running serial MIDI counters (see serial_midi.h), all 0 without
+// STRADEX_SERIAL_MIDI
+typedef struct __attribute__((packed)) telemetry_serial_midi_frame {
+    uint32_t messages;
+    uint32_t bytes;
+    uint32_t status_saved;
+    uint32_t cc_held;
+    uint32_t cc_replaced;
+    uint32_t dropped_bytes;
+} telemetry_serial_midi_frame_t;
+
+// Fret map calibration progress (see main.c): status 0 never run, 1
+// capturing, 2 done, 3 aborted, 4 fit failed, 5 not stored
+typedef struct __attribute__((packed)) telemetry_calibration_frame {
+    uint8_t status;
+    uint8_t step;           // Reference frets captured so far
+    uint8_t fret;           // Reference fret to touch next, 0 when not capturing
+    uint8_t reserved;
+    uint32_t rms_error;     // Of the last successful fit, in ADC units
+} telemetry_calibration_frame_t;
+
+// Running softpot filter counters (see softpot_filter.h)
+typedef struct __attribute__((packed)) telemetry_softpot_frame {
+    uint32_t held_samples;
+    uint32_t releases;
+    uint32_t spurious_changes;  // Frets too short to have been played
+} telemetry_softpot_frame_t;
+
+// Bytes a frame takes in the vendor FIFO, header included
+#define TELEMETRY_FRAME_BYTES(frame_t) (sizeof(telemetry_header_t) + sizeof(frame_t))
+#define TELEMETRY_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+// The largest of the frames that take turns, one per period
+#define TELEMETRY_SLOW_FRAME_BYTES \
+    TELEMETRY_MAX(TELEMETRY_FRAME_BYTES(telemetry_idle_frame_t), \
+                  TELEMETRY_MAX(TELEMETRY_FRAME_BYTES(telemetry_serial_midi_frame_t), \
+                                TELEMETRY_MAX(TELEMETRY_FRAME_BYTES(telemetry_calibration_frame_t), \
+                                              TELEMETRY_FRAME_BYTES(telemetry_softpot_frame_t))))
+
+// Queued in a regular period, and in a period given to the boot frame
+#define TELEMETRY_REGULAR_PERIOD_BYTES \
+    (TELEMETRY_FRAME_BYTES(telemetry_sensor_frame_t) + TELEMETRY_FRAME_BYTES(telemetry_profile_frame_t) + \
+     TELEMETRY_FRAME_BYTES(telemetry_xip_frame_t) + TELEMETRY_FRAME_BYTES(telemetry_midi_frame_t) + \
+     TELEMETRY_SLOW_FRAME_BYTES)
+#define TELEMETRY_BOOT_PERIOD_BYTES TELEMETRY_FRAME_BYTES(telemetry_boot_frame_t)
+
+// Worst case queued in one period
+#define TELEMETRY_PERIOD_BYTES TELEMETRY_MAX(TELEMETRY_REGULAR_PERIOD_BYTES, TELEMETRY_BOOT_PERIOD_BYTES)
+
+/*! \brief Check whether the next telemetry slot has come up
+ *
+ * \param now_us Current time in microseconds
+ * \return true at most once per TELEMETRY_PERIOD_US while a host is attached
+ */
+bool telemetry_due(uint32_t now_us);
+
+/*! \brief Queue one telemetry frame without blocking
+ *
+ * \param type Frame type, one of telemetry_frame_type
+ * \param payload Frame payload
+ * \param length Payload length in bytes
+ * \return true if the frame was queued, false if it was dropped
+ */
+bool telemetry_send(uint8_t type, const void *payload, uint8_t length);
+
+#endif
@@ -76,17 +76,28 @@ extern "C" {
 #define CFG_TUD_ENDPOINT0_SIZE    64
 #endif
 
+// Composite MIDI + vendor telemetry build, set by the STRADEX_TELEMETRY
+// CMake option
+#ifndef STRADEX_TELEMETRY
+#define STRADEX_TELEMETRY       0
+#endif
+
 //------------- CLASS -------------//
 #define CFG_TUD_CDC             0
 #define CFG_TUD_MSC             0
 #define CFG_TUD_HID             0 
 #define CFG_TUD_MIDI            1 
-#define CFG_TUD_VENDOR          0
+#define CFG_TUD_VENDOR          STRADEX_TELEMETRY
 
 // MIDI FIFO size of TX and RX
 #define CFG_TUD_MIDI_RX_BUFSIZE   (TUD_OPT_HIGH_SPEED ? 512 : 64)
 #define CFG_TUD_MIDI_TX_BUFSIZE   (TUD_OPT_HIGH_SPEED ? 512 : 64)
 
+// Vendor (telemetry) FIFO size of TX and RX. Kept separate from the MIDI
+// FIFOs so a backed-up telemetry host never holds MIDI bytes.
+#define CFG_TUD_VENDOR_RX_BUFSIZE (TUD_OPT_HIGH_SPEED ? 512 : 64)
+#define CFG_TUD_VENDOR_TX_BUFSIZE (TUD_OPT_HIGH_SPEED ? 512 : 256)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,133 @@
+#include "ump.h"
+#include "hot_path.h"
+
+static uint32_t HOT_PATH(midi2_header)(uint8_t group, uint8_t status, uint8_t channel, uint8_t byte3, uint8_t byte4) {
+    return ((uint32_t)UMP_TYPE_MIDI2_VOICE << 28) | ((uint32_t)(group & 0xF) << 24) |
+           ((uint32_t)status << 20) | ((uint32_t)(channel & 0xF) << 16) |
+           ((uint32_t)(byte3 & 0x7F) << 8) | byte4;
+}
+
+static void HOT_PATH(set_midi2)(ump_t *packet, uint32_t header, uint32_t data) {
+    packet->words[0] = header;
+    packet->words[1] = data;
+    packet->num_words = 2;
+}
+
+uint32_t HOT_PATH(ump_scale_up)(uint32_t value, uint8_t from_bits, uint8_t to_bits) {
+    uint8_t scale_bits = to_bits - from_bits;
+    uint32_t shifted = value << scale_bits;
+    uint32_t center = 1u << (from_bits - 1);
+    if (value <= center || scale_bits == 0) {
+        return shifted;
+    }
+
+    // Above the centre, repeat the bits below the top bit into the gap
+    uint8_t repeat_bits = from_bits - 1;
+    uint32_t repeat = value & ((1u << repeat_bits) - 1);
+    if (scale_bits > repeat_bits) {
+        repeat <<= scale_bits - repeat_bits;
+    } else {
+        repeat >>= repeat_bits - scale_bits;
+    }
+    while (repeat != 0) {
+        shifted |= repeat;
+        repeat >>= repeat_bits;
+    }
+    return shifted;
+}
+
+void HOT_PATH(ump_note_on)(ump_t *packet, uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity,
+                           uint8_t attribute_type, uint16_t attribute) {
+    set_midi2(packet, midi2_header(group, UMP_STATUS_NOTE_ON, channel, note, attribute_type),
+              ((uint32_t)velocity << 16) | attribute);
+}
+
+void HOT_PATH(ump_note_off)(ump_t *packet, uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity) {
+    set_midi2(packet, midi2_header(group, UMP_STATUS_NOTE_OFF, channel, note, UMP_ATTRIBUTE_NONE),
+              (uint32_t)velocity << 16);
+}
+
+void HOT_PATH(ump_control_change)(ump_t *packet, uint8_t group, uint8_t channel, uint8_t controller, uint32_t value) {
+    set_midi2(packet, midi2_header(group, UMP_STATUS_CONTROL_CHANGE, channel, controller, 0), value);
+}
+
+void HOT_PATH(ump_registered_controller)(ump_t *packet, uint8_t group, uint8_t channel, uint8_t bank, uint8_t index,
+                                         uint32_t value) {
+    set_midi2(packet, midi2_header(group, UMP_STATUS_REGISTERED_CONTROLLER, channel, bank, index & 0x7F), value);
+}
+
+void HOT_PATH(ump_pitch_bend)(ump_t *packet, uint8_t group, uint8_t channel, uint32_t value) {
+    set_midi2(packet, midi2_header(group, UMP_STATUS_PITCH_BEND, channel, 0, 0), value);
+}
+
+static uint8_t HOT_PATH(midi1_length)(uint8_t status) {
+    uint8_t kind = status & 0xF0;
+    return (kind == 0xC0 || kind == 0xD0) ? 2 : 3;
+}
+
+uint8_t HOT_PATH(ump_to_midi1)(const ump_t *packet, uint8_t *out) {
+    uint32_t header = packet->words[0];
+    uint8_t type = header >> 28;
+
+    if (type == UMP_TYPE_MIDI1_VOICE) {
+        out[0] = (header >> 16) & 0xFF;
+        out[1] = (header >> 8) & 0x7F;
+        out[2] = header & 0x7F;
+        return midi1_length(out[0]);
+    }
+    if (type != UMP_TYPE_MIDI2_VOICE || packet->num_words < 2) {
+        return 0;
+    }
+
+    uint8_t status = (header >> 20) & 0xF;
+    uint8_t channel = (header >> 16) & 0xF;
+    uint8_t byte3 = (header >> 8) & 0x7F;
+    uint8_t byte4 = header & 0x7F;
+    uint32_t data = packet->words[1];
+
+    switch (status) {
+        case UMP_STATUS_NOTE_ON: {
+            uint8_t velocity = ump_scale_down(data >> 16, 16, 7);
+            out[0] = 0x90 | channel;
+            out[1] = byte3;
+            out[2] = velocity ? velocity : 1;   // Velocity 0 would mean note off
+            return 3;
+        }
+        case UMP_STATUS_NOTE_OFF:
+            out[0] = 0x80 | channel;
+            out[1] = byte3;
+            out[2] = ump_scale_down(data >> 16, 16, 7);
+            return 3;
+        case UMP_STATUS_CONTROL_CHANGE:
+            out[0] = 0xB0 | channel;
+            out[1] = byte3;
+            out[2] = ump_scale_down(data, 32, 7);
+            return 3;
+        case UMP_STATUS_REGISTERED_CONTROLLER: {
+            uint32_t value = ump_scale_down(data, 32, 14);
+            const uint8_t msgs[6][2] = {
+                {0x65, byte3},                  // RPN MSB (bank)
+                {0x64, byte4},                  // RPN LSB (index)
+                {0x06, value >> 7},             // Data entry MSB
+                {0x26, value & 0x7F},           // Data entry LSB
+                {0x65, 0x7F},                   // Null RPN
+                {0x64, 0x7F}
+            };
+            for (int i = 0; i < 6; i++) {
+                out[i * 3] = 0xB0 | channel;
+                out[i * 3 + 1] = msgs[i][0];
+                out[i * 3 + 2] = msgs[i][1];
+            }
+            return 18;
+        }
+        case UMP_STATUS_PITCH_BEND: {
+            uint32_t value = ump_scale_down(data, 32, 14);
+            out[0] = 0xE0 | channel;
+            out[1] = value & 0x7F;
+            out[2] = value >> 7;
+            return 3;
+        }
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef _UMP_H_
+#define _UMP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file ump.h
+ * \brief MIDI 2.0 Universal MIDI Packet encoder and MIDI 1.0 translation
+ *
+ * Outgoing channel voice messages are built as MIDI 2.0 UMPs (message type
+ * 4, two 32-bit words) with 16-bit velocity and 32-bit controllers and bend,
+ * so the interpreter keeps its full resolution up to the output. USB MIDI
+ * only carries MIDI 1.0 for now (see midi_out.h), so every packet is
+ * translated down to byte messages with the scaling rules of the UMP
+ * specification, and ump_bandwidth measures what native UMPs would cost.
+*/
+
+#define UMP_MAX_WORDS 4
+#define UMP_MIDI1_MAX_BYTES 18              // Longest translation: an RPN write
+
+#define UMP_TYPE_MIDI1_VOICE 0x2
+#define UMP_TYPE_MIDI2_VOICE 0x4
+
+// MIDI 2.0 channel voice status nibbles
+enum ump_status {
+    UMP_STATUS_REGISTERED_CONTROLLER = 0x2,
+    UMP_STATUS_NOTE_OFF = 0x8,
+    UMP_STATUS_NOTE_ON = 0x9,
+    UMP_STATUS_CONTROL_CHANGE = 0xB,
+    UMP_STATUS_PITCH_BEND = 0xE
+};
+
+#define UMP_ATTRIBUTE_NONE 0x00
+#define UMP_ATTRIBUTE_PITCH_7_9 0x03        // Note number 7.9 fixed point
+#define UMP_PITCH_BEND_CENTER 0x80000000u
+
+typedef struct ump {
+    uint32_t words[UMP_MAX_WORDS];
+    uint8_t num_words;
+} ump_t;
+
+/*! \brief Scale a value up to more bits, keeping min, centre and max
+ *
+ * The bit-repeat scheme of the MIDI 2.0 specification: values up to the
+ * centre are shifted, values above it fill the new low bits so that the
+ * maximum maps to the maximum.
+ *
+ * \param value Value to scale
+ * \param from_bits Width of value, 1 to 31
+ * \param to_bits Width of the result, from_bits to 32
+ */
+uint32_t ump_scale_up(uint32_t value, uint8_t from_bits, uint8_t to_bits);
+
+/*! \brief Scale a value down to fewer bits by dropping the low bits
+ */
+static inline uint32_t ump_scale_down(uint32_t value, uint8_t from_bits, uint8_t to_bits) {
+    return value >> (from_bits - to_bits);
+}
+
+/*! \brief MIDI 2.0 note on
+ *
+ * \param packet Packet to fill
+ * \param group UMP group 0-15
+ * \param channel Channel 0-15
+ * \param note Note number 0-127
+ * \param velocity 16-bit velocity; 0 is a valid, very soft note on
+ * \param attribute_type UMP_ATTRIBUTE_NONE or UMP_ATTRIBUTE_PITCH_7_9
+ * \param attribute Attribute data, e.g. the pitch for UMP_ATTRIBUTE_PITCH_7_9
+ */
+void ump_note_on(ump_t *packet, uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity,
+                 uint8_t attribute_type, uint16_t attribute);
+
+/*! \brief MIDI 2.0 note off with a 16-bit release velocity
+ */
+void ump_note_off(ump_t *packet, uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity);
+
+/*! \brief MIDI 2.0 control change with a 32-bit value
+ */
+void ump_control_change(ump_t *packet, uint8_t group, uint8_t channel, uint8_t controller, uint32_t value);
+
+/*! \brief MIDI 2.0 registered controller (RPN) with a 32-bit value
+ */
+void ump_registered_controller(ump_t *packet, uint8_t group, uint8_t channel, uint8_t bank, uint8_t index,
+                               uint32_t value);
+
+/*! \brief MIDI 2.0 channel pitch bend, centre UMP_PITCH_BEND_CENTER
+ */
+void ump_pitch_bend(ump_t *packet, uint8_t group, uint8_t channel, uint32_t value);
+
+/*! \brief Translate a UMP into MIDI 1.0 byte messages
+ *
+ * MIDI 2.0 channel voice messages are scaled down: velocity to 7 bits (a
+ * note on never drops to velocity 0), controllers to 7 bits, bend to 14
+ * bits, and a registered controller becomes an RPN select, data entry MSB
+ * and LSB, then the null RPN so later data entry messages can't change it.
+ * The note on pitch attribute is dropped. Type 2 packets are unwrapped as
+ * they are.
+ *
+ * \param packet Packet to translate
+ * \param out Receives the bytes, at least UMP_MIDI1_MAX_BYTES
+ * \return Number of bytes written, 0 if there is no MIDI 1.0 equivalent
+ */
+uint8_t ump_to_midi1(const ump_t *packet, uint8_t *out);
+
+#endif
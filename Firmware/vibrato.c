@@ -0,0 +1,106 @@
+#include "vibrato.h"
+#include "hot_path.h"
+#include "interp_map.h"
+
+// Quarter sine wave, 0 to pi/2 in 32 steps, Q15
+static const int16_t HOT_DATA(quarter_sine)[33] = {
+    0, 1608, 3212, 4808, 6393, 7962, 9512, 11039,
+    12539, 14010, 15446, 16846, 18204, 19519, 20787, 22005,
+    23170, 24279, 25329, 26319, 27245, 28105, 28898, 29621,
+    30273, 30852, 31356, 31785, 32137, 32412, 32609, 32728,
+    32767
+};
+static interp_map_lut_t sine_lut;
+
+// Sine of a 32-bit phase, Q15
+static int32_t HOT_PATH(sine_q15)(uint32_t phase) {
+    uint32_t quadrant = phase >> 30;
+    uint32_t index = (phase >> 22) & 0xFF; // 8 bits within the quadrant
+    if (quadrant & 1) index = 0x100 - index;
+
+    // 32 table steps per quadrant, 3 bits left to interpolate, scaled up
+    // to the 8 bits interp_map takes
+    if (!sine_lut.table) {
+        interp_map_lut_init(&sine_lut, quarter_sine, 33, 8);
+    }
+    int32_t value = interp_map_lerp(&sine_lut, index << 5);
+
+    return (quadrant & 2) ? -value : value;
+}
+
+void HOT_PATH(vibrato_reset)(vibrato_t *vib, int16_t value) {
+    vib->center = (int32_t)value << 8;
+    vib->swing_max = 0;
+    vib->swing_min = 0;
+    vib->above = false;
+    vib->last_cross_us = 0;
+    vib->period_us = 0;
+    vib->depth = 0;
+    vib->active = false;
+    vib->phase = 0;
+    vib->phase_us = 0;
+}
+
+void HOT_PATH(vibrato_update)(vibrato_t *vib, int16_t value, uint32_t now_us) {
+    vib->center += (((int32_t)value << 8) - vib->center) >> VIBRATO_CENTER_SHIFT;
+    int16_t deviation = value - (vib->center >> 8);
+
+    if (deviation > vib->swing_max) vib->swing_max = deviation;
+    if (deviation < vib->swing_min) vib->swing_min = deviation;
+
+    if (!vib->above && deviation > VIBRATO_CROSS_HYSTERESIS) {
+        // Positive-going crossing: one full cycle since the previous one
+        vib->above = true;
+        uint32_t period = now_us - vib->last_cross_us;
+        int16_t depth = (vib->swing_max - vib->swing_min) / 2;
+
+        if (vib->last_cross_us != 0 && period >= VIBRATO_MIN_PERIOD_US
+                && period <= VIBRATO_MAX_PERIOD_US && depth >= VIBRATO_MIN_DEPTH) {
+            if (vib->period_us == 0) {
+                vib->period_us = period;
+                vib->depth = depth;
+            } else {
+                vib->period_us += ((int32_t)period - (int32_t)vib->period_us) / 4;
+                vib->depth += (depth - vib->depth) / 4;
+            }
+            vib->active = true;
+        } else {
+            vib->active = false;
+        }
+
+        // Keep the resynthesised sine in step with the real one
+        vib->phase = 0;
+        vib->phase_us = now_us;
+
+        vib->last_cross_us = now_us;
+        vib->swing_max = deviation;
+        vib->swing_min = deviation;
+    } else if (vib->above && deviation < -VIBRATO_CROSS_HYSTERESIS) {
+        vib->above = false;
+    }
+
+    // No crossing for two periods: the vibrato has stopped
+    if (vib->active && now_us - vib->last_cross_us > 2 * vib->period_us) {
+        vib->active = false;
+    }
+}
+
+uint32_t HOT_PATH(vibrato_rate_q8)(const vibrato_t *vib) {
+    if (!vib->active || vib->period_us == 0) return 0;
+    return (1000000u << 8) / vib->period_us;
+}
+
+int16_t HOT_PATH(vibrato_center)(const vibrato_t *vib) {
+    return vib->center >> 8;
+}
+
+int16_t HOT_PATH(vibrato_resynth)(vibrato_t *vib, uint32_t now_us) {
+    if (vib->period_us != 0) {
+        // Advance the phase by the elapsed fraction of a period
+        uint32_t elapsed = now_us - vib->phase_us;
+        vib->phase += (uint32_t)(((uint64_t)elapsed << 32) / vib->period_us);
+    }
+    vib->phase_us = now_us;
+
+    return vibrato_center(vib) + ((vib->depth * sine_q15(vib->phase)) >> 15);
+}
@@ -0,0 +1,67 @@
+#ifndef _VIBRATO_H_
+#define _VIBRATO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** \file vibrato.h
+ * \brief Fixed-point vibrato detector and resynthesiser for the softpot
+ *
+ * The softpot stream is high-passed against a slow running centre. The
+ * time between positive-going zero crossings (with hysteresis) gives the
+ * vibrato rate, and the peak-to-peak swing over each cycle gives the depth.
+ * While a vibrato in the 3-10 Hz band is present, a smooth sine with the
+ * measured rate and depth can stand in for the sparse raw samples.
+ *
+ * A cycle shallower than VIBRATO_MIN_DEPTH or outside the band clears
+ * vib->active, and so do two periods without a crossing, so a held note or
+ * a slide goes back to the raw readings. The resynthesised sine restarts
+ * its phase at every crossing to stay in step with the finger.
+*/
+
+#define VIBRATO_CENTER_SHIFT 4          // Running centre time constant, samples
+#define VIBRATO_CROSS_HYSTERESIS 20     // Softpot units around the centre
+#define VIBRATO_MIN_DEPTH 30            // Softpot units, smaller swings are noise
+#define VIBRATO_MIN_PERIOD_US 100000    // 10 Hz
+#define VIBRATO_MAX_PERIOD_US 333333    // 3 Hz
+
+typedef struct vibrato {
+    int32_t center;         // Running centre, Q8
+    int16_t swing_max;      // Extremes of the current cycle
+    int16_t swing_min;
+    bool above;             // Which side of the centre the signal is on
+    uint32_t last_cross_us; // Time of the last positive-going crossing
+    uint32_t period_us;     // Smoothed vibrato period, 0 = none yet
+    int16_t depth;          // Smoothed half peak-to-peak swing
+    bool active;
+    uint32_t phase;         // Resynthesis phase, full turn = 2^32
+    uint32_t phase_us;      // Time the phase was last advanced
+} vibrato_t;
+
+/*! \brief Reset the detector, e.g. when the finger leaves the softpot
+ */
+void vibrato_reset(vibrato_t *vib, int16_t value);
+
+/*! \brief Feed one new softpot sample
+ *
+ * \param value Softpot reading
+ * \param now_us Sample time in microseconds
+ */
+void vibrato_update(vibrato_t *vib, int16_t value, uint32_t now_us);
+
+/*! \brief Vibrato rate in Hz, Q8 (0 if no vibrato)
+ */
+uint32_t vibrato_rate_q8(const vibrato_t *vib);
+
+/*! \brief Running centre of the softpot, i.e. the reading without vibrato
+ */
+int16_t vibrato_center(const vibrato_t *vib);
+
+/*! \brief Resynthesised softpot value at an arbitrary time
+ *
+ * Centre plus a sine of the measured rate and depth. Only meaningful while
+ * vib->active.
+ */
+int16_t vibrato_resynth(vibrato_t *vib, uint32_t now_us);
+
+#endif
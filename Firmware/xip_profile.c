@@ -0,0 +1,42 @@
+#include "xip_profile.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "hot_path.h"
+
+// The hardware counters saturate rather than wrap, so they are cleared at
+// every mark. Writing any value clears a counter.
+static void HOT_PATH(read_and_clear)(uint32_t *accesses, uint32_t *hits) {
+    *hits = xip_ctrl_hw->ctr_hit;
+    *accesses = xip_ctrl_hw->ctr_acc;
+    xip_ctrl_hw->ctr_hit = 0;
+    xip_ctrl_hw->ctr_acc = 0;
+}
+
+void HOT_PATH(xip_profile_begin)(xip_profile_t *profile) {
+    uint32_t accesses, hits;
+    read_and_clear(&accesses, &hits);
+    profile->pass_misses = 0;
+}
+
+void HOT_PATH(xip_profile_mark)(xip_profile_t *profile, uint8_t stage) {
+    uint32_t accesses, hits;
+    read_and_clear(&accesses, &hits);
+
+    // An access can land between the two reads, never count it as a miss
+    uint32_t misses = accesses > hits ? accesses - hits : 0;
+    profile->accesses[stage] += accesses;
+    profile->misses[stage] += misses;
+    if (misses > profile->misses_max[stage]) {
+        profile->misses_max[stage] = misses;
+    }
+    profile->pass_misses += misses;
+}
+
+void HOT_PATH(xip_profile_end)(xip_profile_t *profile) {
+    if (profile->pass_misses > profile->pass_misses_max) {
+        profile->pass_misses_max = profile->pass_misses;
+    }
+}
+
+void xip_profile_clear(xip_profile_t *profile) {
+    *profile = (xip_profile_t){0};
+}
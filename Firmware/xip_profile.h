@@ -0,0 +1,54 @@
+#ifndef _XIP_PROFILE_H_
+#define _XIP_PROFILE_H_
+
+#include <stdint.h>
+
+/** \file xip_profile.h
+ * \brief XIP cache hits and misses per main loop stage
+ *
+ * Reads the XIP cache's access and hit counters at the end of every stage
+ * of the main loop and charges the difference to that stage. A miss is a
+ * flash fetch, several hundred cycles the loop spends waiting, so misses in
+ * the stages after tud_task() are the jitter that STRADEX_SRAM_HOT_PATH is
+ * meant to remove.
+ *
+ * The counters see every XIP access, from both cores and from DMA, so with
+ * STRADEX_SYNTH core 1's flash accesses are counted too.
+*/
+
+enum xip_stage {
+    XIP_STAGE_USB = 0,          // tud_task(), SysEx, parameter swaps
+    XIP_STAGE_SCAN,             // ADS1115 reads and buttons
+    XIP_STAGE_INTERPRET,        // Softpot, vibrato, FSR, interpret_midi_state()
+    XIP_STAGE_OUTPUT,           // Note output and synth parameters
+    XIP_STAGE_TELEMETRY,
+    XIP_NUM_STAGES
+};
+
+typedef struct xip_profile {
+    uint32_t accesses[XIP_NUM_STAGES];
+    uint32_t misses[XIP_NUM_STAGES];
+    uint32_t misses_max[XIP_NUM_STAGES];    // Worst single pass through the stage
+    uint32_t pass_misses;                   // Misses so far in this loop pass
+    uint32_t pass_misses_max;               // Worst loop pass
+} xip_profile_t;
+
+/*! \brief Start a loop pass
+ */
+void xip_profile_begin(xip_profile_t *profile);
+
+/*! \brief Charge the accesses since the last mark to a stage
+ *
+ * \param stage Stage that just ended, one of xip_stage
+ */
+void xip_profile_mark(xip_profile_t *profile, uint8_t stage);
+
+/*! \brief End a loop pass
+ */
+void xip_profile_end(xip_profile_t *profile);
+
+/*! \brief Zero the totals, e.g. after they have been reported
+ */
+void xip_profile_clear(xip_profile_t *profile);
+
+#endif